@@ -0,0 +1,65 @@
+#include "arena.h"
+#include "mem.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+ARENA *CreateArena(void){
+  return (ARENA *) Calloc(1, sizeof(ARENA));
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// TAKES bytes FROM THE LAST BLOCK. RETURNS 1 WHEN A NEW BLOCK OF A->bSize 
+// BYTES HAS TO BE OPENED FOR THEM.
+
+static int ArenaTake(ARENA *A, uint64_t bytes){
+  if(A->nBlocks == 0 || A->used + bytes > A->bSize){ // OPEN A NEW BLOCK
+    A->bSize  = bytes > ARENA_BLOCK ? bytes : ARENA_BLOCK;
+    A->used   = bytes;
+    A->total += A->bSize + sizeof(uint8_t *);
+    return 1;
+    }
+  A->used += bytes;
+  return 0;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// RETURNS ZEROED AND ALIGNED MEMORY FOR nmemb ELEMENTS OF size BYTES.
+
+void *ArenaCalloc(ARENA *A, uint64_t nmemb, uint64_t size){
+  uint64_t bytes = (nmemb * size + ARENA_ALIGN - 1) & ~((uint64_t) 
+  ARENA_ALIGN - 1);
+
+  if(ArenaTake(A, bytes)){
+    A->blocks = (uint8_t **) Realloc(A->blocks, (A->nBlocks + 1) * 
+    sizeof(uint8_t *), sizeof(uint8_t *));
+    A->blocks[A->nBlocks++] = (uint8_t *) Calloc(A->bSize, sizeof(uint8_t));
+    }
+
+  return A->blocks[A->nBlocks-1] + A->used - bytes;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// COUNTS IN A->total THE BYTES THAT ArenaCalloc WOULD TAKE, WITHOUT 
+// ALLOCATING (A IS A ZEROED ARENA THAT IS ONLY USED TO PLAN).
+
+void ArenaPlan(ARENA *A, uint64_t nmemb, uint64_t size){
+  if(ArenaTake(A, (nmemb * size + ARENA_ALIGN - 1) & ~((uint64_t) 
+  ARENA_ALIGN - 1)))
+    ++A->nBlocks;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void RemoveArena(ARENA *A){
+  uint32_t n;
+  for(n = 0 ; n < A->nBlocks ; ++n)
+    Free(A->blocks[n]);
+  if(A->blocks != NULL)
+    Free(A->blocks);
+  Free(A);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -0,0 +1,31 @@
+#ifndef ARENA_H_INCLUDED
+#define ARENA_H_INCLUDED
+
+#include "defs.h"
+
+#define ARENA_BLOCK  262144   // DEFAULT BYTES OF EACH ARENA BLOCK
+#define ARENA_ALIGN  16
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// BUMP ALLOCATOR: MEMORY IS TAKEN FROM LARGE BLOCKS AND IT IS ONLY RETURNED 
+// WHEN THE WHOLE ARENA IS REMOVED. THE BLOCKS NEVER MOVE.
+
+typedef struct{
+  uint8_t  **blocks;
+  uint32_t nBlocks;
+  uint64_t used;              // Bytes used in the last block
+  uint64_t bSize;             // Bytes of the last block
+  uint64_t total;             // Bytes taken from the allocator
+  }
+ARENA;
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+ARENA      *CreateArena    (void);
+void       *ArenaCalloc    (ARENA *, uint64_t, uint64_t);
+void       ArenaPlan       (ARENA *, uint64_t, uint64_t);
+void       RemoveArena     (ARENA *);
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#endif
@@ -0,0 +1,478 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#include "mem.h"
+#include "time.h"
+#include "defs.h"
+#include "common.h"
+#include "parser.h"
+#include "strtab.h"
+#include "top.h"
+#include "filters.h"
+#include "models.h"
+#include "pmodels.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// MICROBENCHMARKS OF THE HOT KERNELS (falcon_bench). EACH KERNEL RUNS ALONE
+// OVER A SYNTHETIC SEQUENCE OF 2 n BASES: ITS INPUTS (CONTEXT INDEXES,
+// PREDICTIONS) ARE COMPUTED BEFORE THE TIMED LOOP. THE MODELS LEARN THE FIRST
+// n BASES AND SCORE THE OTHER n, SO THE SHARE OF REPEATS (-r) SETS HOW MANY
+// CONTEXTS OF THE SCAN WERE SEEN IN THE TRAINING. EACH KERNEL REPORTS THE
+// NANOSECONDS PER ITEM AND, IF perf_event_open IS ALLOWED, THE CACHE MISSES.
+// THE KERNELS ARE BUILT -O3 FOR falcon_bench (SEE CMakeLists.txt).
+
+#define BENCH_ARRAY_CTX  12         // Order of the array model
+#define BENCH_HASH_CTX   16         // Order of the hash model
+#define BENCH_EDITS      5          // Substitutions of the tolerant model
+#define BENCH_EDEN       10
+#define BENCH_RECORD     10000      // Bases of each record of the FASTA text
+#define BENCH_LINE       80
+#define BENCH_PER_TOP    100        // Bases of the sequence per top update
+#define BENCH_TOP        20
+#define BENCH_REGION     10000      // Bases of each self-similarity region
+#define BENCH_PRED       5          // A prediction: 4 freqs and their sum
+
+typedef struct{
+  double   start;
+  int      fd;                // Counter of the cache misses, -1 if none
+  FILE     *TSV;              // Also writes the results here (or NULL)
+  }
+BENCH;
+
+static uint64_t rng;
+static volatile double sink;  // Keeps the results of the kernels alive
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// XORSHIFT64*
+
+static uint64_t Rand(void){
+  rng ^= rng >> 12;
+  rng ^= rng << 25;
+  rng ^= rng >> 27;
+  return rng * 2685821657736338717ULL;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static int Chance(double pct){
+  return (Rand() >> 11) * (100.0 / 9007199254740992.0) < pct;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// n BASES (0-3) IN BLOCKS OF len: WITH PROBABILITY rep % A BLOCK COPIES AN
+// EARLIER REGION, WITH mut % OF ITS BASES SUBSTITUTED, OTHERWISE IT IS
+// UNIFORMLY RANDOM. BGUARD ZEROS BEFORE THE SEQUENCE ARE THE PAST OF ITS
+// FIRST CONTEXTS.
+
+static uint8_t *GenSequence(uint64_t n, double rep, uint64_t len, double mut){
+  uint8_t  *seq = (uint8_t *) Calloc(n + BGUARD, sizeof(uint8_t)) + BGUARD;
+  uint64_t i, k, from;
+
+  for(i = 0 ; i < n ; i += len){
+    if(i >= len && Chance(rep)){
+      from = Rand() % (i - len + 1);
+      for(k = i ; k < i + len && k < n ; ++k)
+        seq[k] = Chance(mut) ? Rand() & 3 : seq[from + k - i];
+      }
+    else
+      for(k = i ; k < i + len && k < n ; ++k)
+        seq[k] = Rand() & 3;
+    }
+  return seq;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// THE SEQUENCE AS A FASTA FILE IN MEMORY: RECORDS OF BENCH_RECORD BASES IN
+// LINES OF BENCH_LINE. RETURNS ITS SIZE IN size.
+
+static uint8_t *GenFasta(uint8_t *seq, uint64_t n, uint64_t *size){
+  uint8_t  *text = (uint8_t *) Malloc(n + 2 * (n / BENCH_LINE + n /
+  BENCH_RECORD) + 64 * (n / BENCH_RECORD + 1));
+  uint64_t i, t = 0;
+
+  for(i = 0 ; i < n ; ++i){
+    if(i % BENCH_RECORD == 0){
+      if(i != 0 && text[t-1] != '\n')
+        text[t++] = '\n';
+      t += sprintf((char *) text + t, ">record_%"PRIu64" synthetic\n", i /
+      BENCH_RECORD);
+      }
+    text[t++] = "ACGT"[seq[i]];
+    if(i % BENCH_RECORD % BENCH_LINE == BENCH_LINE - 1)
+      text[t++] = '\n';
+    }
+  text[t++] = '\n';
+  *size = t;
+  return text;
+  }
+
+//////////////////////////////////////////////////////////////////////////////
+// - - - - - - - - - - - - - - - C O U N T E R S - - - - - - - - - - - - - - -
+
+static int OpenMisses(void){
+  #ifdef __linux__
+  struct perf_event_attr pe;
+  memset(&pe, 0, sizeof(pe));
+  pe.type           = PERF_TYPE_HARDWARE;
+  pe.size           = sizeof(pe);
+  pe.config         = PERF_COUNT_HW_CACHE_MISSES;
+  pe.disabled       = 1;
+  pe.exclude_kernel = 1;
+  pe.exclude_hv     = 1;
+  return (int) syscall(__NR_perf_event_open, &pe, 0, -1, -1, 0);
+  #else
+  return -1;
+  #endif
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void Start(BENCH *B){
+  #ifdef __linux__
+  if(B->fd >= 0){
+    ioctl(B->fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(B->fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  #endif
+  B->start = WallClock();
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// REPORTS THE KERNEL TIMED SINCE Start. items OF unit WERE PROCESSED.
+
+static void Stop(BENCH *B, char *name, uint64_t items, char *unit){
+  double   ns = (WallClock() - B->start) * 1e9 / (items ? items : 1);
+  uint64_t misses = 0;
+  char     str[32] = "n/a";
+
+  #ifdef __linux__
+  if(B->fd >= 0){
+    ioctl(B->fd, PERF_EVENT_IOC_DISABLE, 0);
+    if(read(B->fd, &misses, sizeof(misses)) == sizeof(misses))
+      snprintf(str, sizeof(str), "%.4lf", (double) misses / (items ? items :
+      1));
+    }
+  #endif
+
+  fprintf(stdout, "  [+] %-26s %10"PRIu64" %-8s %10.2lf ns %10s misses\n",
+  name, items, unit, ns, str);
+  if(B->TSV != NULL)
+    fprintf(B->TSV, "%s\t%"PRIu64"\t%s\t%.3lf\t%s\n", name, items, unit, ns,
+    str);
+  }
+
+//////////////////////////////////////////////////////////////////////////////
+// - - - - - - - - - - - - - - - - K E R N E L S - - - - - - - - - - - - - - -
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// CONTEXT INDEX OF EACH BASE (FROM THE BASES BEFORE IT)
+
+static void Indexes(CModel *M, uint8_t *seq, uint64_t n, uint64_t *idx){
+  uint64_t i;
+  ResetCModelIdx(M);
+  for(i = 0 ; i < n ; ++i){
+    GetPModelIdx(seq + i - 1, M);
+    idx[i] = M->pModelIdx;
+    }
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// AS TrainModels: THE FIRST ctx BASES HAVE NO CONTEXT
+
+static void Train(CModel *M, uint8_t *seq, uint64_t n, uint64_t *idx){
+  uint64_t i;
+  for(i = M->ctx ; i < n ; ++i)
+    UpdateCModelCounter(M, seq[i], idx[i]);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void Predict(CModel *M, uint64_t n, uint64_t *idx, uint32_t *pred){
+  PModel   *PM = CreatePModel(ALPHABET_SIZE);
+  uint64_t i;
+
+  for(i = 0 ; i < n ; ++i, pred += BENCH_PRED){
+    ComputePModel(M, PM, idx[i], M->alphaDen);
+    memcpy(pred, PM->freqs, ALPHABET_SIZE * sizeof(uint32_t));
+    pred[ALPHABET_SIZE] = PM->sum;
+    }
+  RemovePModel(PM);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void SetPModel(PModel *PM, uint32_t *pred){
+  PM->freqs = pred;
+  PM->sum   = pred[ALPHABET_SIZE];
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// THE TOLERANT MODEL OVER THE PREDICTIONS OF ITS ARRAY MODEL, AS MixIndexed
+
+static void Tolerant(CModel *M, uint8_t *seq, uint64_t n, uint32_t *pred){
+  CModel   *SH = CreateShadowModel(M);
+  PModel   PM;
+  uint64_t i;
+
+  for(i = 0 ; i < n ; ++i, pred += BENCH_PRED){
+    SetPModel(&PM, pred);
+    SH->SUBS.seq->buf[SH->SUBS.seq->idx] = seq[i];
+    CorrectCModelSUBS(SH, &PM, seq[i]);
+    }
+  sink += SH->SUBS.in;
+  FreeShadow(SH);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// MIXES THE PREDICTIONS OF THE ARRAY AND HASH MODELS, AS MixIndexed
+
+static void Mix(uint8_t *seq, uint64_t n, uint32_t *predA, uint32_t *predH){
+  CMWeight    *CMW = CreateWeightModel(2);
+  FloatPModel *PT = CreateFloatPModel(ALPHABET_SIZE);
+  PModel      PM[2], *PP[2] = { &PM[0], &PM[1] };
+  uint64_t    i;
+
+  for(i = 0 ; i < n ; ++i){
+    SetPModel(&PM[0], predA + i * BENCH_PRED);
+    SetPModel(&PM[1], predH + i * BENCH_PRED);
+    memset((void *) PT->freqs, 0, ALPHABET_SIZE * sizeof(double));
+    ComputeWeightedFreqs(CMW->weight[0], PP[0], PT);
+    ComputeWeightedFreqs(CMW->weight[1], PP[1], PT);
+    CalcDecayment(CMW, PP, seq[i], DEFAULT_GAMMA);
+    RenormalizeWeights(CMW);
+    }
+  sink += CMW->weight[0] + PT->freqs[0];
+  RemoveFPModel(PT);
+  DeleteWeightModel(CMW);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void Parse(uint8_t *text, uint64_t size){
+  PARSER   *PA = CreateParser();
+  uint64_t i;
+  int64_t  sum = 0;
+
+  for(i = 0 ; i < size ; ++i)
+    sum += ParseMF(PA, text[i]);
+  sink += sum;
+  RemoveParser(PA);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// n RECORDS WITH RANDOM SCORES IN [0, 2) BITS PER BASE. THE VALUES ARE DRAWN
+// BEFORE THE TIMED LOOP.
+
+static void Tops(double *value, uint64_t n){
+  STRTAB   *names = CreateStrTab();
+  TOP      *Top = CreateTop(BENCH_TOP, names);
+  uint64_t i;
+
+  for(i = 0 ; i < n ; ++i){
+    Top->rec = i;
+    UpdateTop(value[i], (uint8_t *) "synthetic_record", Top, BENCH_RECORD);
+    }
+  sink += Top->V[0].value;
+  DeleteTop(Top);
+  DeleteStrTab(names);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// THE WINDOW MEAN OF n ENTRIES OF A PROFILE, AS FilterStream MOVES IT (slide:
+// SlideTo AND SlideMean) OR WITH THE DIRECT FilterMean THAT IT ONLY USES NEAR
+// THE THRESHOLD. THE RING OF THE FILTER IS FILLED ONCE, AS ONLY THE
+// ARITHMETIC MATTERS.
+
+static void Means(uint8_t *seq, uint64_t n, uint32_t window, int slide){
+  FILTER   *FIL = CreateFilter(window, 1, W_HAMMING, DEFAULT_THRESHOLD);
+  uint64_t i;
+  ENTP     sum = 0;
+
+  FIL->nEntries = n;
+  for(i = 0 ; i < (uint64_t) FIL->ring ; ++i)
+    FIL->entries[i] = seq[i % n] * 0.25;
+  if(slide){
+    ResyncSlide(FIL, 0);
+    sum += SlideMean(FIL, 0);
+    for(i = 1 ; i < n ; ++i){
+      SlideTo(FIL, i);
+      sum += SlideMean(FIL, i);
+      }
+    }
+  else
+    for(i = 0 ; i < n ; ++i)
+      sum += FilterMean(FIL, i);
+  sink += sum;
+  DeleteFilter(FIL);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void SelfSims(uint8_t *seq, uint64_t n){
+  SSModel  *SS = CreateSelfSim();
+  uint64_t i;
+  int      sum = 0;
+
+  for(i = 1 ; i <= n ; i += BENCH_REGION)
+    sum += SelfSimilarity(SS, seq, i, i + BENCH_REGION - 1 < n ? i +
+    BENCH_REGION - 1 : n);
+  sink += sum;
+  RemoveSelfSim(SS);
+  }
+
+//////////////////////////////////////////////////////////////////////////////
+// - - - - - - - - - - - - - - - - - - M A I N - - - - - - - - - - - - - - - -
+
+static void PrintBenchMenu(void){
+  fprintf(stderr,
+  "Usage: falcon_bench [OPTION]...                                      \n"
+  "Times the hot kernels of FALCON over a synthetic sequence.           \n"
+  "                                                                     \n"
+  "  -n <bases>   bases learned and bases scanned (default: 1000000),   \n"
+  "  -r <pct>     percentage of blocks that repeat an earlier region    \n"
+  "               (default: 30),                                        \n"
+  "  -l <bases>   length of the blocks (default: 1000),                 \n"
+  "  -m <pct>     substitutions in the repeated blocks (default: 1),    \n"
+  "  -s <seed>    seed of the generator (default: 1),                   \n"
+  "  -c <col>     collisions of the hash model (default: 1),            \n"
+  "  -w <size>    window of the filter mean (default: 100),             \n"
+  "  -o <FILE>    also writes the results as TSV to FILE,               \n"
+  "  -h           gives this help.                                      \n"
+  "                                                                     \n"
+  "Each kernel reports the nanoseconds and cache misses per item (n/a   \n"
+  "if the system does not allow perf_event_open).                       \n");
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+int32_t main(int argc, char *argv[]){
+  char     **p = *&argv, *out;
+  uint64_t n, len, i, size, nTop;
+  uint64_t *idxA, *idxH;
+  uint32_t col, window, *predA, *predH;
+  uint8_t  *seq, *text;
+  double   rep, mut, *value;
+  CModel   *A, *H;
+  BENCH    B;
+
+  if(ArgsState(DEFAULT_HELP, p, argc, "-h", "--help")){
+    PrintBenchMenu();
+    return EXIT_SUCCESS;
+    }
+
+  n      = ArgsNum64 (1000000, p, argc, "-n", BENCH_RECORD, 1ULL << 32);
+  rep    = ArgsDouble(30,      p, argc, "-r");
+  len    = ArgsNum64 (1000,    p, argc, "-l", 1, 1ULL << 32);
+  mut    = ArgsDouble(1,       p, argc, "-m");
+  rng    = ArgsNum64 (1,       p, argc, "-s", 0, UINT64_MAX) *
+           0x9E3779B97F4A7C15ULL | 1;
+  col    = ArgsNum   (1,       p, argc, "-c", 1, 253);
+  window = ArgsNum   (100,     p, argc, "-w", 1, 999999);
+  out    = ArgsString(NULL,    p, argc, "-o", "-o");
+
+  B.fd  = OpenMisses();
+  B.TSV = out == NULL ? NULL : Fopen(out, "w");
+  if(B.TSV != NULL)
+    fprintf(B.TSV, "kernel\titems\tunit\tns\tmisses\n");
+
+  fprintf(stdout, "==[ BENCHMARK ]=================\n");
+  fprintf(stdout, "Bases ............................ 2 x %"PRIu64"\n", n);
+  fprintf(stdout, "Repeats .......................... %.1lf %% of %"PRIu64
+  " bases, %.1lf %% substituted\n", rep, len, mut);
+  fprintf(stdout, "Models ........................... %u (array), %u (hash,"
+  " col %u)\n", BENCH_ARRAY_CTX, BENCH_HASH_CTX, col);
+  fprintf(stdout, "Cache misses ..................... %s\n", B.fd >= 0 ?
+  "yes" : "n/a");
+  fprintf(stdout, "\n");
+
+  seq   = GenSequence(2 * n, rep, len, mut);
+  idxA  = (uint64_t *) Malloc(2 * n * sizeof(uint64_t));
+  idxH  = (uint64_t *) Malloc(2 * n * sizeof(uint64_t));
+  predA = (uint32_t *) Malloc(n * BENCH_PRED * sizeof(uint32_t));
+  predH = (uint32_t *) Malloc(n * BENCH_PRED * sizeof(uint32_t));
+  A     = CreateCModel(BENCH_ARRAY_CTX, 1, 0, 0, col, BENCH_EDITS,
+          BENCH_EDEN);
+  H     = CreateCModel(BENCH_HASH_CTX, 1, 0, 0, col, 0, 0);
+  if(A == NULL || H == NULL){
+    fprintf(stderr, "Error: the models do not fit in memory!\n");
+    return EXIT_FAILURE;
+    }
+
+  Start(&B);
+  Indexes(A, seq, 2 * n, idxA);
+  Stop(&B, "GetPModelIdx", 2 * n, "bases");
+  Indexes(H, seq, 2 * n, idxH);
+
+  Start(&B);
+  Train(A, seq, n, idxA);
+  Stop(&B, "UpdateCModelCounter array", n, "bases");
+  Start(&B);
+  Train(H, seq, n, idxH);
+  Stop(&B, "UpdateCModelCounter hash", n, "bases");
+
+  Start(&B);
+  Predict(A, n, idxA + n, predA);
+  Stop(&B, "ComputePModel array", n, "bases");
+  Start(&B);
+  Predict(H, n, idxH + n, predH);
+  Stop(&B, "ComputePModel hash", n, "bases");
+
+  Start(&B);
+  Tolerant(A, seq + n, n, predA);
+  Stop(&B, "CorrectCModelSUBS", n, "bases");
+
+  Start(&B);
+  Mix(seq + n, n, predA, predH);
+  Stop(&B, "Mixer (2 models)", n, "bases");
+
+  text = GenFasta(seq + n, n, &size);
+  Start(&B);
+  Parse(text, size);
+  Stop(&B, "ParseMF", size, "bytes");
+  Free(text);
+
+  nTop  = 2 * n / BENCH_PER_TOP;
+  value = (double *) Malloc(nTop * sizeof(double));
+  for(i = 0 ; i < nTop ; ++i)
+    value[i] = (Rand() >> 11) * (2.0 / 9007199254740992.0);
+  Start(&B);
+  Tops(value, nTop);
+  Stop(&B, "UpdateTop", nTop, "records");
+  Free(value);
+
+  Start(&B);
+  Means(seq + n, n, window, 1);
+  Stop(&B, "SlideMean", n, "entries");
+  Start(&B);
+  Means(seq + n, n, window, 0);
+  Stop(&B, "FilterMean (fallback)", n, "entries");
+
+  Start(&B);
+  SelfSims(seq + n, n);
+  Stop(&B, "SelfSimilarity", n, "bases");
+
+  FreeCModel(A);
+  FreeCModel(H);
+  Free(predA);
+  Free(predH);
+  Free(idxA);
+  Free(idxH);
+  Free(seq - BGUARD);
+  if(B.TSV != NULL)
+    fclose(B.TSV);
+  #ifdef __linux__
+  if(B.fd >= 0)
+    close(B.fd);
+  #endif
+  return EXIT_SUCCESS;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
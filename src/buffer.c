@@ -1,6 +1,7 @@
 #include <string.h>
 #include "buffer.h"
 #include "mem.h"
+#include "arena.h"
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 // CREATE CONTEXT BUFFER
@@ -15,6 +16,19 @@ CBUF *CreateCBuffer(uint32_t s, uint32_t g){
   return B;
   }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// CREATE CONTEXT BUFFER INSIDE AN ARENA (IT IS FREED WITH THE ARENA)
+//
+CBUF *CreateCBufferIn(ARENA *A, uint32_t s, uint32_t g){
+  CBUF *B  = (CBUF *) ArenaCalloc(A, 1, sizeof(CBUF));
+  B->size  = s;
+  B->guard = g;
+  B->buf   = (uint8_t *) ArenaCalloc(A, B->size+B->guard, sizeof(uint8_t));
+  B->buf  += B->guard;
+  B->idx   = 0;
+  return B;
+  }
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 // CREATE SIMPLE BUFFER
 //
@@ -45,16 +59,11 @@ void UpdateBuffer(BUF *B){
   }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-// RESET CBUFFER
+// RESET CBUFFER: IN PLACE. AFTER A RESET, THE CONTEXTS ONLY READ THE GUARD OR
+// POSITIONS ALREADY WRITTEN, HENCE ONLY THE GUARD NEEDS TO BE CLEARED.
 // 
 void ResetCBuffer(CBUF *B){
-  Free(B->buf-B->guard);
-  B->buf  = (uint8_t *) Calloc(B->size+B->guard, sizeof(uint8_t));
-  B->buf += B->guard;
-
-//  memset((void *)B->buf, 0, (B->size + B->guard) * sizeof(uint8_t));
-//  B->buf += B->guard;
-
+  memset((void *)(B->buf-B->guard), 0, B->guard * sizeof(uint8_t));
   B->idx  = 0;
   }
 
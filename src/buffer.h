@@ -2,6 +2,7 @@
 #define BUFFER_H_INCLUDED
 
 #include "defs.h"
+#include "arena.h"
 
 #define DEF_BUF_GUARD 32
 #define DEF_BUF_SIZE  65535
@@ -26,6 +27,7 @@ BUF;
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 CBUF     *CreateCBuffer (uint32_t, uint32_t);
+CBUF     *CreateCBufferIn (ARENA *, uint32_t, uint32_t);
 BUF      *CreateBuffer  (uint32_t);
 void     UpdateCBuffer  (CBUF *);
 void     UpdateBuffer   (BUF *);
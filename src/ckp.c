@@ -0,0 +1,419 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ckp.h"
+#include "time.h"
+#include "strtab.h"
+#include "common.h"
+#include "serialization.h"
+#include "mem.h"
+
+#define CKP_HEAD       16     // Bytes of the file header
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void PutU32(FILE *F, uint32_t x){
+  uint8_t b[4] = { x, x >> 8, x >> 16, x >> 24 };
+  fwrite(b, 1, 4, F);
+  }
+
+static void PutU64(FILE *F, uint64_t x){
+  PutU32(F, (uint32_t) x);
+  PutU32(F, (uint32_t) (x >> 32));
+  }
+
+static uint32_t LoadU32(uint8_t *b){
+  return b[0] | (uint32_t) b[1] << 8 | (uint32_t) b[2] << 16 |
+  (uint32_t) b[3] << 24;
+  }
+
+static uint64_t LoadU64(uint8_t *b){
+  return LoadU32(b) | (uint64_t) LoadU32(b + 4) << 32;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void PutLabel(FILE *F, char *name, uint64_t hash){
+  uint32_t len = strlen(name);
+  fputc(CKP_LABEL, F);
+  PutU32(F, len);
+  fwrite(name, 1, len, F);
+  PutU64(F, hash);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// READS THE RECORDS OF A CHECKPOINT: THE CELLS BETWEEN FILES OF THIS RUN ARE
+// COPIED TO matrix AND MARKED IN have. fileOf GIVES THE (FIRST) FILE OF EACH
+// NAME OF Tab AND hash ITS CONTENT: A LABEL OF A FILE THAT CHANGED MATCHES NO
+// FILE, SO ITS CELLS ARE LEFT OUT. RETURNS THE OFFSET AFTER THE LAST COMPLETE
+// RECORD.
+
+static uint64_t ReadCkp(MCKP *C, STRTAB *Tab, int64_t *fileOf, uint64_t
+*hash, uint32_t nFiles, double **matrix, uint8_t *have){
+  int64_t  *labelFile = NULL, id, f;
+  uint64_t good = CKP_HEAD, idx, bits;
+  uint32_t len, ref, tar, maxLabels = 0, maxName = 0;
+  uint8_t  rec[16];
+  char     *name = NULL;
+  int      type;
+
+  while((type = fgetc(C->F)) != EOF){
+    if(type == CKP_LABEL){
+      if(fread(rec, 1, 4, C->F) != 4)
+        break;
+      if((len = LoadU32(rec)) + 1 > maxName){
+        name = (char *) Realloc(name, len + 1, len + 1 - maxName);
+        maxName = len + 1;
+        }
+      if(fread(name, 1, len, C->F) != len || fread(rec, 1, 8, C->F) != 8)
+        break;
+      name[len] = '\0';
+      if(C->nLabels == maxLabels){
+        labelFile = (int64_t *) Realloc(labelFile, (maxLabels + 1024) *
+        sizeof(int64_t), 1024 * sizeof(int64_t));
+        maxLabels += 1024;
+        }
+      f = (id = FindString(Tab, name)) < 0 ? -1 : fileOf[id];
+      if(f >= 0 && LoadU64(rec) != hash[f])
+        f = -1; // THE FILE CHANGED: A NEW LABEL
+      labelFile[C->nLabels] = f;
+      if(f >= 0 && C->label[f] == UINT32_MAX)
+        C->label[f] = C->nLabels;
+      ++C->nLabels;
+      }
+    else if(type == CKP_CELL){
+      if(fread(rec, 1, 16, C->F) != 16)
+        break;
+      ref = LoadU32(rec);
+      tar = LoadU32(rec + 4);
+      if(ref >= C->nLabels || tar >= C->nLabels)
+        break;
+      if(labelFile[ref] >= 0 && labelFile[tar] >= 0){
+        idx = (uint64_t) labelFile[ref] * nFiles + labelFile[tar];
+        if(have[idx] == 0){
+          have[idx] = 1;
+          bits = LoadU64(rec + 8);
+          memcpy(&matrix[labelFile[ref]][labelFile[tar]], &bits, 8);
+          ++C->resumed;
+          }
+        }
+      }
+    else
+      break;
+    good = Ftello(C->F);
+    }
+
+  if(labelFile != NULL)
+    Free(labelFile);
+  if(name != NULL)
+    Free(name);
+  return good;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// OPENS THE CHECKPOINT OF A MATRIX OF nFiles FILES. WITH resume THE CELLS OF
+// AN EXISTING CHECKPOINT ARE LOADED (MARKED IN have) AND THE NEW CELLS ARE
+// APPENDED, OTHERWISE IT STARTS EMPTY.
+
+MCKP *OpenMatrixCkp(char *name, char **files, uint32_t nFiles, uint64_t key,
+uint8_t resume, double **matrix, uint8_t *have){
+  MCKP     *C = (MCKP *) Calloc(1, sizeof(MCKP));
+  STRTAB   *Tab = CreateStrTab();
+  int64_t  *fileOf;
+  uint64_t good, *hash;
+  uint32_t n, id, f;
+  uint8_t  head[CKP_HEAD] = { 'F', 'M', 'C', 'K', CKP_VERSION, 0, 0, 0 };
+
+  for(n = 0 ; n < nFiles ; ++n)
+    InternString(Tab, files[n]);
+  fileOf   = (int64_t  *) Malloc(Tab->nStr * sizeof(int64_t));
+  C->label = (uint32_t *) Malloc(nFiles * sizeof(uint32_t));
+  hash     = (uint64_t *) Calloc(nFiles, sizeof(uint64_t));
+  for(n = 0 ; n < Tab->nStr ; ++n)
+    fileOf[n] = -1;
+  for(n = 0 ; n < nFiles ; ++n){
+    id = (uint32_t) FindString(Tab, files[n]);
+    if(fileOf[id] == -1){
+      fileOf[id] = n;
+      hash[n]    = FileHash(MODEL_HASH_SEED, files[n]);
+      }
+    C->label[n] = UINT32_MAX;
+    }
+
+  if(resume && (C->F = fopen(name, "r+b")) != NULL){
+    if(fread(head, 1, CKP_HEAD, C->F) != CKP_HEAD || memcmp(head, CKP_MAGIC,
+    4) != 0 || head[4] != CKP_VERSION){
+      fprintf(stderr, "  [x] Error: %s is not a matrix checkpoint!\n", name);
+      exit(1);
+      }
+    if(LoadU64(head + 8) != key){
+      fprintf(stderr, "  [x] Error: the checkpoint %s was computed with other "
+      "models or gamma!\n", name);
+      exit(1);
+      }
+    good = ReadCkp(C, Tab, fileOf, hash, nFiles, matrix, have);
+    // DROPS A TRUNCATED TAIL (THE LAST RECORD BEFORE A CRASH)
+    Fseeko(C->F, good, SEEK_SET);
+    if(ftruncate(fileno(C->F), good) != 0){
+      fprintf(stderr, "  [x] Error: cannot truncate %s!\n", name);
+      exit(1);
+      }
+    }
+  else{
+    C->F = Fopen(name, "w+b");
+    fwrite(head, 1, 8, C->F);
+    PutU64(C->F, key);
+    }
+
+  // THE LABELS OF THE FILES THAT ARE NOT IN THE CHECKPOINT
+  for(n = 0 ; n < nFiles ; ++n){
+    f = fileOf[FindString(Tab, files[n])];
+    if(C->label[f] == UINT32_MAX){
+      PutLabel(C->F, files[f], hash[f]);
+      C->label[f] = C->nLabels++;
+      }
+    C->label[n] = C->label[f];
+    }
+  fflush(C->F);
+
+  Free(fileOf);
+  Free(hash);
+  DeleteStrTab(Tab);
+  return C;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void MatrixCkpPut(MCKP *C, uint32_t ref, uint32_t tar, double value){
+  uint64_t bits;
+  memcpy(&bits, &value, 8);
+  fputc(CKP_CELL, C->F);
+  PutU32(C->F, C->label[ref]);
+  PutU32(C->F, C->label[tar]);
+  PutU64(C->F, bits);
+  fflush(C->F);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void CloseMatrixCkp(MCKP *C){
+  fclose(C->F);
+  Free(C->label);
+  Free(C);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+SCANCKP *OpenScanCkp(char *name, uint64_t key, uint32_t nThreads, double
+every){
+  SCANCKP *C = (SCANCKP *) Calloc(1, sizeof(SCANCKP));
+  C->name     = CloneString(name);
+  C->key      = key;
+  C->nThreads = nThreads;
+  C->every    = every;
+  C->last     = WallClock();
+  C->slot     = (char   **) Calloc(nThreads, sizeof(char *));
+  C->slotSize = (size_t  *) Calloc(nThreads, sizeof(size_t));
+  C->fresh    = (uint8_t *) Calloc(nThreads, sizeof(uint8_t));
+  pthread_mutex_init(&C->lock, NULL);
+  return C;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void PutStr(FILE *F, char *str){
+  uint32_t len = strlen(str);
+  PutU32(F, len);
+  fwrite(str, 1, len, F);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// READS A NAME_LEN(4) NAME FIELD IN name (MAX_NAME BYTES). 0 IF IT FAILS.
+
+static int LoadStr(FILE *F, char *name){
+  uint8_t  b[4];
+  uint32_t len;
+  if(fread(b, 1, 4, F) != 4 || (len = LoadU32(b)) >= MAX_NAME ||
+  fread(name, 1, len, F) != len)
+    return 0;
+  name[len] = '\0';
+  return 1;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void WriteScanCkp(SCANCKP *C){
+  char     *tmp = concatenate(C->name, ".tmp");
+  FILE     *F = Fopen(tmp, "wb");
+  uint32_t n;
+  uint8_t  head[8] = { 'F', 'S', 'C', 'K', SCK_VERSION, 0, 0, 0 };
+
+  fwrite(head, 1, 8, F);
+  PutU64(F, C->key);
+  PutU32(F, C->nThreads);
+  for(n = 0 ; n < C->nThreads ; ++n)
+    fwrite(C->slot[n], 1, C->slotSize[n], F);
+  if(ferror(F) || fclose(F) != 0 || rename(tmp, C->name) != 0){
+    fprintf(stderr, "  [x] Error: unable to write the checkpoint %s!\n",
+    C->name);
+    exit(1);
+    }
+  Free(tmp);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// REFRESHES THE SLOT OF THE THREAD t. THE LAST SLOT OF A ROUND WRITES THE 
+// FILE IF THE PREVIOUS ONE IS OLDER THAN every SECONDS.
+
+void ScanCkpPut(SCANCKP *C, uint32_t t, uint64_t cursor, TOP *Top, PARTIALS
+*Parts){
+  FILE     *F;
+  char     *buf = NULL;
+  size_t   size = 0;
+  uint64_t bits, n;
+  VT       *V;
+
+  if((F = open_memstream(&buf, &size)) == NULL){
+    fprintf(stderr, "  [x] Error: no memory for the checkpoint!\n");
+    exit(1);
+    }
+  PutU64(F, cursor);
+  PutU32(F, Top->id);
+  PutU32(F, Top->size);
+  for(n = 0 ; n < Top->size ; ++n){
+    V = &Top->V[n];
+    memcpy(&bits, &V->value, 8);
+    PutU64(F, bits);
+    PutU64(F, V->size);
+    PutU64(F, V->rec);
+    PutU32(F, V->dbIndex);
+    #ifdef LOCAL_SIMILARITY
+    PutU64(F, V->iPos);
+    PutU64(F, V->ePos);
+    #else
+    PutU64(F, 0);
+    PutU64(F, 0);
+    #endif
+    PutStr(F, TopName(Top, n));
+    }
+  PutU64(F, Parts->nPart);
+  for(n = 0 ; n < Parts->nPart ; ++n){
+    memcpy(&bits, &Parts->P[n].bits, 8);
+    PutU64(F, Parts->P[n].rec);
+    PutU64(F, bits);
+    PutU64(F, Parts->P[n].nBase);
+    PutU32(F, Parts->P[n].dbIndex);
+    PutU64(F, Parts->P[n].iPos);
+    PutU64(F, Parts->P[n].ePos);
+    PutStr(F, (char *) Parts->P[n].name);
+    }
+  fclose(F);
+
+  pthread_mutex_lock(&C->lock);
+  free(C->slot[t]);
+  C->slot[t]     = buf;
+  C->slotSize[t] = size;
+  if(C->fresh[t] == 0){
+    C->fresh[t] = 1;
+    ++C->nFresh;
+    }
+  if(C->nFresh == C->nThreads && WallClock() - C->last >= C->every){
+    WriteScanCkp(C);
+    memset(C->fresh, 0, C->nThreads);
+    C->nFresh = 0;
+    C->last   = WallClock();
+    }
+  pthread_mutex_unlock(&C->lock);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// RESTORES THE TOPS, PARTIALS AND CURSORS OF THE THREADS FROM THE FILE. THE 
+// TRACES OF THE TOP ENTRIES ARE LOST (-1). RETURNS 0 IF THERE IS NO FILE.
+
+int LoadScanCkp(SCANCKP *C, uint64_t *cursor, TOP **Top, PARTIALS **Parts){
+  FILE     *F;
+  char     *name;
+  uint8_t  b[44];
+  uint64_t bits, n, nPart;
+  uint32_t t;
+  double   partBits;
+  VT       *V;
+
+  if((F = fopen(C->name, "rb")) == NULL)
+    return 0;
+  if(fread(b, 1, 20, F) != 20 || memcmp(b, SCK_MAGIC, 4) != 0 || b[4] !=
+  SCK_VERSION){
+    fprintf(stderr, "  [x] Error: %s is not a scan checkpoint!\n", C->name);
+    exit(1);
+    }
+  if(LoadU64(b + 8) != C->key || LoadU32(b + 16) != C->nThreads){
+    fprintf(stderr, "  [x] Error: the checkpoint %s is of a run with other "
+    "models, files or options!\n", C->name);
+    exit(1);
+    }
+
+  name = (char *) Malloc(MAX_NAME);
+  for(t = 0 ; t < C->nThreads ; ++t){
+    if(fread(b, 1, 16, F) != 16 || LoadU32(b + 12) != Top[t]->size)
+      break;
+    cursor[t]  = LoadU64(b);
+    Top[t]->id = LoadU32(b + 8);
+    for(n = 0 ; n < Top[t]->size ; ++n){
+      if(fread(b, 1, 44, F) != 44 || !LoadStr(F, name))
+        break;
+      V = &Top[t]->V[n];
+      bits = LoadU64(b);
+      memcpy(&V->value, &bits, 8);
+      V->size    = LoadU64(b + 8);
+      V->rec     = LoadU64(b + 16);
+      V->dbIndex = LoadU32(b + 24);
+      V->name    = name[0] == '\0' ? STR_EMPTY : AddString(Top[t]->names,
+      name);
+      #ifdef LOCAL_SIMILARITY
+      V->iPos    = LoadU64(b + 28);
+      V->ePos    = LoadU64(b + 36);
+      V->trace   = -1;
+      V->tId     = 0;
+      #endif
+      }
+    if(n != Top[t]->size || fread(b, 1, 8, F) != 8)
+      break;
+    for(nPart = LoadU64(b), n = 0 ; n < nPart ; ++n){
+      if(fread(b, 1, 44, F) != 44 || !LoadStr(F, name))
+        break;
+      bits = LoadU64(b + 8);
+      memcpy(&partBits, &bits, 8);
+      AddPartial(Parts[t], LoadU64(b), partBits, LoadU64(b + 16), (uint8_t *)
+      name, LoadU64(b + 28), LoadU64(b + 36), LoadU32(b + 24));
+      }
+    if(n != nPart)
+      break;
+    }
+  if(t != C->nThreads){
+    fprintf(stderr, "  [x] Error: the checkpoint %s is corrupted!\n", C->name);
+    exit(1);
+    }
+
+  Free(name);
+  fclose(F);
+  return 1;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// WITH done THE RUN ENDED AND THE FILE IS REMOVED
+
+void CloseScanCkp(SCANCKP *C, uint8_t done){
+  uint32_t n;
+  if(done)
+    remove(C->name);
+  for(n = 0 ; n < C->nThreads ; ++n)
+    free(C->slot[n]);
+  pthread_mutex_destroy(&C->lock);
+  Free(C->slot);
+  Free(C->slotSize);
+  Free(C->fresh);
+  Free(C->name);
+  Free(C);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -0,0 +1,84 @@
+#ifndef CKP_H_INCLUDED
+#define CKP_H_INCLUDED
+
+#include <stdio.h>
+#include <pthread.h>
+#include "defs.h"
+#include "top.h"
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// CHECKPOINT OF THE INTER MATRIX (.ckp): AN APPEND-ONLY LOG WHERE EACH CELL 
+// IS WRITTEN AS SOON AS IT ENDS. ALL INTEGERS ARE LITTLE ENDIAN.
+//
+//   FILE   : "FMCK" VERSION(1) 0(3) KEY(8) RECORD...
+//   RECORD : 'L' NAME_LEN(4) NAME HASH(8)              (NEXT LABEL ID)
+//            'C' REF_LABEL(4) TAR_LABEL(4) VALUE(8, DOUBLE)
+//
+// KEY HASHES THE MODELS AND GAMMA: THE CELLS ARE ONLY VALID WITH THE SAME 
+// KEY. THE CELLS REFER TO THE FILES BY LABEL (THE FILE NAME AND THE FNV-1a
+// HASH OF ITS CONTENT), SO A RESUMED RUN WITH MORE FILES APPENDS THEIR LABELS
+// AND ONLY COMPUTES THE NEW ROWS AND COLUMNS. A FILE WHOSE CONTENT CHANGED
+// GETS A NEW LABEL, SO ITS ROW AND COLUMN ARE COMPUTED AGAIN. A TRUNCATED 
+// LAST RECORD (A CRASH) IS DROPPED ON RESUME.
+
+#define CKP_MAGIC      "FMCK"
+#define CKP_VERSION    2
+#define CKP_LABEL      'L'
+#define CKP_CELL       'C'
+
+typedef struct{
+  FILE     *F;
+  uint32_t *label;            // Checkpoint label of each file
+  uint32_t nLabels;
+  uint64_t resumed;           // Cells read from the checkpoint
+  }
+MCKP;
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// CHECKPOINT OF A meta SCAN (.ckp): THE STATE OF EACH THREAD, REPLACED AS A 
+// WHOLE (WRITTEN AS name.tmp AND RENAMED) SO A CRASH KEEPS THE PREVIOUS ONE.
+//
+//   FILE   : "FSCK" VERSION(1) 0(3) KEY(8) N_THREADS(4) THREAD...
+//   THREAD : CURSOR(8) TOP_ID(4) TOP_SIZE(4) ENTRY... N_PARTS(8) PART...
+//   ENTRY  : VALUE(8) SIZE(8) REC(8) DB(4) I_POS(8) E_POS(8) NAME_LEN(4) NAME
+//   PART   : REC(8) BITS(8) N_BASE(8) DB(4) I_POS(8) E_POS(8) NAME_LEN(4) NAME
+//
+// CURSOR IS THE KEY (TopRec) OF THE LAST RECORD THE THREAD HAD PASSED: ITS TOP
+// AND PARTIALS HOLD ALL ITS RECORDS UP TO IT. THE TOP IS KEPT AS THE HEAP IT 
+// IS. EACH THREAD REFRESHES ITS SLOT EVERY every SECONDS AND THE FILE IS 
+// WRITTEN WHEN ALL THE SLOTS ARE NEWER THAN IT. ALL THE SLOTS ARE REFRESHED AT THE END
+// OF EACH DATABASE (AFTER THE CHUNKS ARE MERGED), SO THE SLOTS OF A FILE ARE 
+// ALWAYS OF THE SAME DATABASE. KEY HASHES THE MODELS, THE FILES AND THE 
+// OPTIONS THAT CHANGE THE TOP OR WHO SCANS EACH RECORD.
+
+#define SCK_MAGIC      "FSCK"
+#define SCK_VERSION    1
+
+typedef struct{
+  char     *name;
+  uint64_t key;
+  uint32_t nThreads;
+  double   every;             // Seconds between writes
+  double   last;              // Time of the last write
+  char     **slot;            // State of each thread (as in the file)
+  size_t   *slotSize;
+  uint8_t  *fresh;            // Slots refreshed after the last write
+  uint32_t nFresh;
+  pthread_mutex_t lock;
+  }
+SCANCKP;
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+MCKP        *OpenMatrixCkp  (char *, char **, uint32_t, uint64_t, uint8_t,
+                            double **, uint8_t *);
+void        MatrixCkpPut    (MCKP *, uint32_t, uint32_t, double);
+void        CloseMatrixCkp  (MCKP *);
+SCANCKP     *OpenScanCkp    (char *, uint64_t, uint32_t, double);
+int         LoadScanCkp     (SCANCKP *, uint64_t *, TOP **, PARTIALS **);
+void        ScanCkpPut      (SCANCKP *, uint32_t, uint64_t, TOP *, PARTIALS *);
+void        CloseScanCkp    (SCANCKP *, uint8_t);
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#endif
@@ -709,26 +709,40 @@ char *ArgsString(char *d, char *a[], uint32_t n, char *s, char *s2)
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+// RETURNS -1 IF str IS NOT A MODEL ("ctx:den:ir:edits/eDen") IN RANGE, AND 0
+// WITH THE MODEL IN Mp
+
+int ParseModel(char *str, ModelPar *Mp)
+  {
+  uint32_t  ctx, den, ir, edits, eDen;
+
+  if(sscanf(str, "%u:%u:%u:%u/%u", &ctx, &den, &ir, &edits, &eDen ) != 5 ||
+  ctx > MAX_CTX || ctx < MIN_CTX || den > MAX_DEN || den < MIN_DEN || 
+  edits > 256 || eDen > 50000)
+    return -1;
+  Mp->ctx   = ctx;
+  Mp->den   = den;
+  Mp->ir    = ir;
+  Mp->edits = edits;
+  Mp->eDen  = eDen;
+  return 0;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
 ModelPar ArgsUniqModel(char *str, uint8_t type)
   {
   uint32_t  ctx, den, ir, edits, eDen;
   ModelPar  Mp;
 
-  if(sscanf(str, "%u:%u:%u:%u/%u", &ctx, &den, &ir, &edits, &eDen ) == 5){
-    if(ctx > MAX_CTX || ctx < MIN_CTX || den > MAX_DEN || den < MIN_DEN || 
-    edits > 256 || eDen > 50000){
-      fprintf(stderr, "Error: invalid model arguments range!\n");
-      ModelsExplanation();
-      fprintf(stderr, "\nPlease set the models according to the above " 
-      "description.\n");
-      exit(1);
-      }
-    Mp.ctx   = ctx;
-    Mp.den   = den;
-    Mp.ir    = ir;
-    Mp.edits = edits;
-    Mp.eDen  = eDen;
+  if(ParseModel(str, &Mp) == 0)
     return Mp;
+  if(sscanf(str, "%u:%u:%u:%u/%u", &ctx, &den, &ir, &edits, &eDen ) == 5){
+    fprintf(stderr, "Error: invalid model arguments range!\n");
+    ModelsExplanation();
+    fprintf(stderr, "\nPlease set the models according to the above " 
+    "description.\n");
+    exit(1);
     }
   else{
     fprintf(stderr, "Error: unknown scheme for model arguments!\n");
@@ -835,6 +849,10 @@ void PrintArgs(Parameters *P, Threads T, char *ref, char *tar, uint32_t top){
   fprintf(stderr, "Compression level .................. %u\n", P->level);
   fprintf(stderr, "Sub-sampling ....................... %u\n", P->sample);
   fprintf(stderr, "Number of threads .................. %u\n", P->nThreads);
+  if(P->split != 0){
+    fprintf(stderr, "Record chunk size .................. %"PRIu64"\n", P->split);
+    fprintf(stderr, "Chunk warm-up ...................... %"PRIu64"\n", P->warmup);
+    }
   fprintf(stderr, "Top size ........................... %u\n", top);
   for(n = 0 ; n < P->nModels ; ++n){
     fprintf(stderr, "Reference model %u:\n", n+1);
@@ -856,6 +874,9 @@ void PrintArgs(Parameters *P, Threads T, char *ref, char *tar, uint32_t top){
   #ifdef LOCAL_SIMILARITY
   if(P->local == 1){
     fprintf(stderr, "Output local filename .............. %s\n", P->outLoc);
+    if(P->trace != 0)
+      fprintf(stderr, "Profile trace limit ................ %"PRIu64"\n",
+      P->trace);
     }
   #endif
   if (P->loadModel) {
@@ -921,6 +942,7 @@ void PrintArgsTrain(Parameters *P, Threads T, char *ref){
 void PrintArgsFilter(EYEPARAM *PEYE){
   fprintf(stderr, "==[ CONFIGURATION ]=================\n");
   fprintf(stderr, "Verbose mode ....................... yes\n");
+  fprintf(stderr, "Number of threads .................. %u\n", PEYE->nThreads);
   fprintf(stderr, "Filter characteristics:\n");
   fprintf(stderr, "  [+] Window size .................. %"PRIi64"\n", 
   PEYE->windowSize);
@@ -947,6 +969,19 @@ void PrintArgsInter(Parameters *P, Threads T){
   "no" : "yes");
   fprintf(stderr, "Compression level .................. %u\n", P->level);
   fprintf(stderr, "Number of threads .................. %u\n", P->nThreads);
+  if(P->ram != 0)
+    fprintf(stderr, "Reference models RAM ............... %"PRIu64" MB\n",
+    P->ram);
+  else
+    fprintf(stderr, "Reference models RAM ............... one per thread\n");
+  fprintf(stderr, "Model cache directory .............. %s\n", P->cache ==
+  NULL ? "none" : P->cache);
+  fprintf(stderr, "Resume from checkpoint ............. %s\n", P->resume
+  == 0 ? "no" : "yes");
+  if(P->sketch > 0)
+    fprintf(stderr, "Sketch Jaccard cutoff .............. %g\n", P->sketch);
+  else
+    fprintf(stderr, "Sketch Jaccard cutoff .............. off\n");
   for(n = 0 ; n < P->nModels ; ++n){
     fprintf(stderr, "Reference model %d:\n", n+1);
     fprintf(stderr, "  [+] Context order ................ %u\n",
@@ -991,6 +1026,9 @@ void PrintArgsEye(EYEPARAM *PEYE){
   PEYE->proportion);
   fprintf(stderr, "  [+] Enlarge ...................... %"PRIu64"\n", 
   PEYE->enlarge);
+  if(PEYE->tile != 0)
+    fprintf(stderr, "Raster tile size ................... %"PRIu64"\n",
+    PEYE->tile);
   fprintf(stderr, "Output visual filename ............. %s\n",  PEYE->output);
   fprintf(stderr, "\n");
   }
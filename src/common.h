@@ -53,6 +53,7 @@ uint32_t    ArgsNum          (uint32_t , char *[], uint32_t, char *, uint32_t,
                               uint32_t);
 uint64_t    ArgsNum64        (uint64_t , char *[], uint32_t, char *, uint64_t,
                               uint64_t);
+int         ParseModel       (char *, ModelPar *);
 ModelPar    ArgsUniqModel    (char *, uint8_t);
 ModelPar    ArgsModel        (uint32_t , char *[], uint32_t, char *);
 double      ArgsDouble       (double, char *[], uint32_t, char *);
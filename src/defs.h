@@ -21,6 +21,7 @@
 
 //#define KMODELSUSAGE 1
 //#define DOUBLESIDE 1
+//#define HASH_STATS 1 // UNCOMMENT: COUNT THE MODEL EVENTS, PRINTED WITH -v
 
 typedef uint64_t ULL;
 typedef uint64_t U64;
@@ -63,6 +64,13 @@ typedef int8_t   I8;
 #define DEFAULT_FILTERSIZE     500
 #define DEFAULT_MINBLOCK       100
 #define DEFAULT_SAMPLE         1
+#define DEFAULT_SPLIT          0
+#define DEFAULT_WARMUP         4096
+#define MIN_SPLIT              1024
+#define DEFAULT_TRACE          0
+#define DEFAULT_CKP            600
+#define DEFAULT_RAM            0
+#define DEFAULT_SKETCH         0
 #define MIN_SAP                1
 #define MAX_SAP                99999999
 #define MAX_LEV                47
@@ -0,0 +1,358 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "falb.h"
+#include "common.h"
+#include "mem.h"
+
+#define FALB_RAW_BYTES(n)  (((n) + 1) / 2 + ((n) + 3) / 4)
+#define FALB_RLE_BYTES(n)  ((n) + (n) / 128 + 2)
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void PutU32(FILE *F, uint32_t x){
+  uint8_t b[4] = { x, x >> 8, x >> 16, x >> 24 };
+  fwrite(b, 1, 4, F);
+  }
+
+static void PutU64(FILE *F, uint64_t x){
+  PutU32(F, (uint32_t) x);
+  PutU32(F, (uint32_t) (x >> 32));
+  }
+
+static uint32_t GetU32(FILE *F){
+  uint8_t b[4];
+  if(fread(b, 1, 4, F) != 4){
+    fprintf(stderr, "  [x] Error: truncated .falb file!\n");
+    exit(1);
+    }
+  return b[0] | (uint32_t) b[1] << 8 | (uint32_t) b[2] << 16 | 
+  (uint32_t) b[3] << 24;
+  }
+
+static uint64_t GetU64(FILE *F){
+  uint64_t lo = GetU32(F);
+  return lo | (uint64_t) GetU32(F) << 32;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// PACKBITS: A HEADER h < 128 IS FOLLOWED BY h+1 LITERALS, A HEADER h > 128 IS
+// FOLLOWED BY ONE BYTE REPEATED 257-h TIMES
+
+static uint32_t EncodeRLE(uint8_t *src, uint32_t n, uint8_t *dst){
+  uint32_t i = 0, o = 0, r, lit;
+  while(i < n){
+    for(r = 1 ; i + r < n && r < 128 && src[i+r] == src[i] ; ++r)
+      ;
+    if(r >= 3){
+      dst[o++] = (uint8_t) (257 - r);
+      dst[o++] = src[i];
+      i += r;
+      continue;
+      }
+    for(lit = 1 ; i + lit < n && lit < 128 ; ++lit)
+      if(i + lit + 2 < n && src[i+lit] == src[i+lit+1] && src[i+lit] == 
+      src[i+lit+2])
+        break;
+    dst[o++] = (uint8_t) (lit - 1);
+    memcpy(dst + o, src + i, lit);
+    o += lit;
+    i += lit;
+    }
+  return o;
+  }
+
+static void DecodeRLE(uint8_t *src, uint32_t n, uint8_t *dst, uint32_t raw){
+  uint32_t i = 0, o = 0, r;
+  while(i < n){
+    uint8_t h = src[i++];
+    if(h < 128){
+      r = h + 1;
+      if(o + r > raw || i + r > n) break;
+      memcpy(dst + o, src + i, r);
+      i += r;
+      }
+    else if(h > 128){
+      r = 257 - h;
+      if(o + r > raw || i >= n) break;
+      memset(dst + o, src[i++], r);
+      }
+    else
+      continue;
+    o += r;
+    }
+  if(o != raw){
+    fprintf(stderr, "  [x] Error: corrupted .falb block!\n");
+    exit(1);
+    }
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+int IsFalb(char *fName){
+  FILE *F = Fopen(fName, "r");
+  char magic[4];
+  int  is = fread(magic, 1, 4, F) == 4 && memcmp(magic, FALB_MAGIC, 4) == 0;
+  fclose(F);
+  return is;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+FALBW *CreateFalbW(FILE *F){
+  FALBW *W = (FALBW *) Calloc(1, sizeof(FALBW));
+  W->F     = F;
+  W->block = (uint8_t *) Calloc(FALB_RAW_BYTES(FALB_BLOCK), sizeof(uint8_t));
+  W->rle   = (uint8_t *) Calloc(FALB_RLE_BYTES(FALB_RAW_BYTES(FALB_BLOCK)), 
+  sizeof(uint8_t));
+  fwrite(FALB_MAGIC, 1, 4, F);
+  PutU32(F, FALB_VERSION);
+  return W;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void FalbBegin(FALBW *W, double value, uint64_t size, char *name){
+  uint64_t bits;
+  uint32_t len = strlen(name);
+  if(W->nProfiles % 1024 == 0)
+    W->offsets = (uint64_t *) Realloc(W->offsets, (W->nProfiles + 1024) * 
+    sizeof(uint64_t), 1024 * sizeof(uint64_t));
+  W->head = W->offsets[W->nProfiles++] = Ftello(W->F);
+  memcpy(&bits, &value, sizeof(double));
+  PutU64(W->F, bits);
+  PutU64(W->F, size);
+  PutU64(W->F, 0);     // ENTRIES AND BLOCKS ARE WRITTEN BY FalbEnd
+  PutU32(W->F, 0);
+  PutU32(W->F, len);
+  fwrite(name, 1, len, W->F);
+  W->nEntries = 0;
+  W->nBlocks  = 0;
+  W->n        = 0;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void FlushBlock(FALBW *W){
+  uint32_t raw = FALB_RAW_BYTES(W->n), hVal = (W->n + 1) / 2, rle;
+  // THE BASES WERE PACKED AFTER THE MAXIMUM NUMBER OF VALUES: MOVE THEM
+  memmove(W->block + hVal, W->block + FALB_BLOCK / 2, (W->n + 3) / 4);
+  rle = EncodeRLE(W->block, raw, W->rle);
+  PutU32(W->F, W->n);
+  if(rle < raw){
+    fputc(FALB_RLE, W->F);
+    PutU32(W->F, rle);
+    fwrite(W->rle, 1, rle, W->F);
+    }
+  else{
+    fputc(FALB_RAW, W->F);
+    PutU32(W->F, raw);
+    fwrite(W->block, 1, raw, W->F);
+    }
+  memset(W->block, 0, FALB_RAW_BYTES(FALB_BLOCK));
+  ++W->nBlocks;
+  W->n = 0;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// ADDS AN ENTRY: value IS THE QUANTIZED COMPLEXITY (QuadQuantization) AND sym
+// THE BASE (0-3, OR 4 FOR UNKNOWN)
+
+void FalbPut(FALBW *W, uint8_t value, uint8_t sym){
+  if(sym > 3){
+    value = FALB_UNKNOWN;
+    sym   = 0;
+    }
+  W->block[W->n >> 1] |= value << ((W->n & 1) << 2);
+  W->block[FALB_BLOCK / 2 + (W->n >> 2)] |= sym << ((W->n & 3) << 1);
+  ++W->nEntries;
+  if(++W->n == FALB_BLOCK)
+    FlushBlock(W);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void FalbEnd(FALBW *W){
+  uint64_t end;
+  if(W->n > 0)
+    FlushBlock(W);
+  end = Ftello(W->F);
+  Fseeko(W->F, (off_t) (W->head + 16), SEEK_SET);
+  PutU64(W->F, W->nEntries);
+  PutU32(W->F, W->nBlocks);
+  Fseeko(W->F, (off_t) end, SEEK_SET);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// WRITES THE INDEX AND THE FOOTER
+
+void RemoveFalbW(FALBW *W){
+  uint64_t n, idx = Ftello(W->F);
+  PutU64(W->F, W->nProfiles);
+  for(n = 0 ; n < W->nProfiles ; ++n)
+    PutU64(W->F, W->offsets[n]);
+  PutU64(W->F, idx);
+  fwrite(FALB_MAGIC, 1, 4, W->F);
+  if(W->offsets != NULL)
+    Free(W->offsets);
+  Free(W->block);
+  Free(W->rle);
+  Free(W);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// RETURNS THE OFFSETS OF THE PROFILES (nProfiles IS SET)
+
+uint64_t *FalbIndex(FILE *F, uint64_t *nProfiles){
+  uint64_t n, *offsets;
+  char     magic[4];
+
+  Fseeko(F, -12, SEEK_END);
+  n = GetU64(F);
+  if(fread(magic, 1, 4, F) != 4 || memcmp(magic, FALB_MAGIC, 4) != 0){
+    fprintf(stderr, "  [x] Error: .falb file without index!\n");
+    exit(1);
+    }
+  Fseeko(F, (off_t) n, SEEK_SET);
+  *nProfiles = GetU64(F);
+  offsets = (uint64_t *) Calloc(*nProfiles + 1, sizeof(uint64_t));
+  for(n = 0 ; n < *nProfiles ; ++n)
+    offsets[n] = GetU64(F);
+  return offsets;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void FalbProfile(FILE *F, uint64_t offset, FALBPROF *PF){
+  uint64_t bits;
+  uint32_t len;
+  Fseeko(F, (off_t) offset, SEEK_SET);
+  bits         = GetU64(F);
+  memcpy(&PF->value, &bits, sizeof(double));
+  PF->size     = GetU64(F);
+  PF->nEntries = GetU64(F);
+  GetU32(F);
+  if((len = GetU32(F)) >= MAX_NAME){
+    fprintf(stderr, "  [x] Error: .falb profile name too long!\n");
+    exit(1);
+    }
+  if(fread(PF->name, 1, len, F) != len){
+    fprintf(stderr, "  [x] Error: truncated .falb file!\n");
+    exit(1);
+    }
+  PF->name[len] = '\0';
+  PF->data = offset + 32 + len;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// THE HEADERS OF THE PROFILES, AS THE '#' LINES OF A .fal FILE (NO ENTRIES)
+
+FILE *FalbHeaders(char *fName){
+  FILE     *IN = Fopen(fName, "r"), *OUT = tmpfile();
+  FALBPROF PF;
+  uint64_t n, nOffsets, *offsets = FalbIndex(IN, &nOffsets);
+
+  if(OUT == NULL){
+    fprintf(stderr, "  [x] Error: unable to create a temporary file!\n");
+    exit(1);
+    }
+  for(n = 0 ; n < nOffsets ; ++n){
+    FalbProfile(IN, offsets[n], &PF);
+    fprintf(OUT, "#\t%.5lf\t%"PRIu64"\t%s\n", PF.value, PF.size, PF.name);
+    }
+  Free(offsets);
+  fclose(IN);
+  rewind(OUT);
+  return OUT;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+FALBSTREAM *CreateFalbStream(FILE *F){
+  FALBSTREAM *S = (FALBSTREAM *) Calloc(1, sizeof(FALBSTREAM));
+  S->F      = F;
+  S->stored = (uint8_t *) Calloc(FALB_RLE_BYTES(FALB_RAW_BYTES(FALB_BLOCK)), 
+  sizeof(uint8_t));
+  S->raw    = (uint8_t *) Calloc(FALB_RAW_BYTES(FALB_BLOCK), sizeof(uint8_t));
+  S->sym    = (uint8_t *) Calloc(FALB_BLOCK, sizeof(uint8_t));
+  S->value  = (uint8_t *) Calloc(FALB_BLOCK, sizeof(uint8_t));
+  return S;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// POSITIONS THE STREAM AT THE FIRST BLOCK (data) OF A PROFILE OF nEntries
+
+void FalbSeek(FALBSTREAM *S, uint64_t data, uint64_t nEntries){
+  Fseeko(S->F, (off_t) data, SEEK_SET);
+  S->left = nEntries;
+  S->n    = 0;
+  S->idx  = 0;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// READS AND UNPACKS THE NEXT BLOCK: S->value GETS THE NIBBLES AND S->sym THE
+// BASES (4 FOR UNKNOWN)
+
+static void ReadBlock(FALBSTREAM *S){
+  uint32_t n, i, raw, stored;
+  int      codec;
+  uint8_t  *val, *bas;
+
+  n      = GetU32(S->F);
+  codec  = fgetc(S->F);
+  stored = GetU32(S->F);
+  raw    = FALB_RAW_BYTES(n);
+  if(n == 0 || n > FALB_BLOCK || n > S->left || stored > 
+  FALB_RLE_BYTES(raw) || fread(S->stored, 1, stored, S->F) != stored){
+    fprintf(stderr, "  [x] Error: corrupted .falb block!\n");
+    exit(1);
+    }
+  if(codec == FALB_RLE){
+    DecodeRLE(S->stored, stored, S->raw, raw);
+    val = S->raw;
+    }
+  else if(codec == FALB_RAW && stored == raw)
+    val = S->stored;
+  else{
+    fprintf(stderr, "  [x] Error: unknown .falb block codec!\n");
+    exit(1);
+    }
+
+  bas = val + (n + 1) / 2;
+  for(i = 0 ; i < n ; ++i){
+    S->value[i] = (val[i >> 1] >> ((i & 1) << 2)) & 0x0f;
+    S->sym[i]   = S->value[i] == FALB_UNKNOWN ? 4 : (bas[i >> 2] >> ((i & 3) 
+    << 1)) & 3;
+    }
+  S->n   = n;
+  S->idx = 0;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// NEXT ENTRY OF THE PROFILE: ITS BASE AND ITS QUANTIZED VALUE (AS UnPackByte)
+
+void FalbNext(FALBSTREAM *S, uint8_t *sym, uint8_t *value){
+  if(S->idx == S->n){
+    if(S->left == 0){
+      fprintf(stderr, "  [x] Error: filtering symbols larger than size!");
+      exit(1);
+      }
+    ReadBlock(S);
+    }
+  *sym   = S->sym[S->idx];
+  *value = S->value[S->idx] == FALB_UNKNOWN ? 8 : S->value[S->idx];
+  ++S->idx;
+  --S->left;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void RemoveFalbStream(FALBSTREAM *S){
+  Free(S->stored);
+  Free(S->raw);
+  Free(S->sym);
+  Free(S->value);
+  Free(S);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -0,0 +1,80 @@
+#ifndef FALB_H_INCLUDED
+#define FALB_H_INCLUDED
+
+#include <stdio.h>
+#include "defs.h"
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// BINARY LOCAL COMPLEXITY PROFILES (.falb). ALL INTEGERS ARE LITTLE ENDIAN.
+//
+//   FILE    : "FALB" VERSION(1) 0(3) PROFILE... INDEX FOOTER
+//   PROFILE : VALUE(8, DOUBLE) SIZE(8) N_ENTRIES(8) N_BLOCKS(4) NAME_LEN(4)
+//             NAME BLOCK...
+//   BLOCK   : N_ENTRIES(4) CODEC(1) STORED_BYTES(4) PAYLOAD
+//   INDEX   : N_PROFILES(8) PROFILE_OFFSET(8)...
+//   FOOTER  : INDEX_OFFSET(8) "FALB"
+//
+// THE RAW PAYLOAD HAS THE QUANTIZED VALUES (4 BITS EACH, FALB_UNKNOWN FOR 
+// BASES OUTSIDE ACGT) FOLLOWED BY THE BASES (2 BITS EACH). WITH FALB_RLE THE 
+// RAW PAYLOAD IS RUN-LENGTH ENCODED (PACKBITS), ONLY WHEN IT IS SMALLER.
+
+#define FALB_MAGIC     "FALB"
+#define FALB_VERSION   1
+#define FALB_BLOCK     65536  // Entries per block
+#define FALB_UNKNOWN   15     // Value nibble of an unknown base (N)
+#define FALB_RAW       0
+#define FALB_RLE       1
+
+typedef struct{
+  FILE     *F;
+  uint64_t *offsets;          // Of each profile header
+  uint64_t nProfiles;
+  uint64_t head;              // Header of the profile being written
+  uint64_t nEntries;          // Of the profile being written
+  uint32_t nBlocks;
+  uint32_t n;                 // Entries in the current block
+  uint8_t  *block;            // Raw payload of the current block
+  uint8_t  *rle;
+  }
+FALBW;
+
+typedef struct{
+  double   value;
+  uint64_t size;
+  uint64_t nEntries;
+  uint64_t data;              // Offset of its first block
+  char     name[MAX_NAME];
+  }
+FALBPROF;
+
+typedef struct{
+  FILE     *F;
+  uint64_t left;              // Entries of the profile not yet decoded
+  uint32_t n;                 // Entries of the decoded block
+  uint32_t idx;
+  uint8_t  *stored;
+  uint8_t  *raw;
+  uint8_t  *sym;              // Decoded block
+  uint8_t  *value;
+  }
+FALBSTREAM;
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+int         IsFalb          (char *);
+FALBW       *CreateFalbW    (FILE *);
+void        FalbBegin       (FALBW *, double, uint64_t, char *);
+void        FalbPut         (FALBW *, uint8_t, uint8_t);
+void        FalbEnd         (FALBW *);
+void        RemoveFalbW     (FALBW *);
+uint64_t    *FalbIndex      (FILE *, uint64_t *);
+void        FalbProfile     (FILE *, uint64_t, FALBPROF *);
+FILE        *FalbHeaders    (char *);
+FALBSTREAM  *CreateFalbStream (FILE *);
+void        FalbSeek        (FALBSTREAM *, uint64_t, uint64_t);
+void        FalbNext        (FALBSTREAM *, uint8_t *, uint8_t *);
+void        RemoveFalbStream (FALBSTREAM *);
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#endif
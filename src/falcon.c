@@ -13,6 +13,8 @@
 #include <unistd.h>
 #include <sys/uio.h>
 #include <sys/mman.h>
+#include <sys/socket.h>
+#include <signal.h>
 
 #include "mem.h"
 #include "time.h"
@@ -35,6 +37,17 @@
 #include "labels.h"
 #include "paint.h"
 #include "stream.h"
+#include "scratch.h"
+#include "order.h"
+#include "falb.h"
+#include "ckp.h"
+#include "ftop.h"
+#include "sketch.h"
+#include "raster.h"
+#include "serve.h"
+#include "libfalcon.h"
+#include "plan.h"
+#include "strtab.h"
 
 //////////////////////////////////////////////////////////////////////////////
 // - - - - - - - M O D E L S   A N D   P A R A M E T E R S - - - - - - - - - -
@@ -46,14 +59,48 @@ EYEPARAM   *PEYE;
 
 
 //////////////////////////////////////////////////////////////////////////////
-// - - - - - - - - - - - - - - R E S E T   M O D E L S - - - - - - - - - - - -
+// - - - - - - - - - - - - - - M E T A   S C A N - - - - - - - - - - - - - - -
+//
+// ALL THE STATE OF A meta SCAN THAT IS SHARED BY ITS THREADS: THE CONTEXT OF
+// THE LIBRARY (MODELS AND GAMMA), THE DATABASE THAT IS BEING SCANNED AND THE
+// OPTIONS OF THE SPLIT. IT IS FILLED ONCE FROM THE ARGUMENTS (InitMetaScan),
+// SO THE SCAN DOES NOT READ P, AND EACH THREAD GETS IT WITH ITS Threads.
+
+typedef struct{
+  FALCON   *F;                // Models and gamma (it owns the models)
+  char     *db;               // Database that is being scanned
+  uint32_t dbIdx;             // And its index in the top
+  uint32_t nThreads;
+  uint64_t split;             // Bases of a chunk (-k, 0: off)
+  uint64_t warmup;            // Bases run before a chunk (-w)
+  uint32_t shard;             // Shard of the database (--shard)
+  uint32_t nShards;
+  uint8_t  local;             // Profiles of the top (-Z)
+  uint64_t trace;             // Longest traced record (-r)
+  uint32_t ckp;               // Seconds between checkpoints (0: off)
+  SCANCKP  *CK;               // Checkpoint (NULL: off)
+  STATS    *ST;               // Phase statistics (NULL: off)
+  }
+METASCAN;
 
-void ResetModelsAndParam(CBUF *Buf, CModel **Shadow, CMWeight *CMW){
-  uint32_t n;
-  ResetCBuffer(Buf);
-  for(n = 0 ; n < P->nModels ; ++n)
-    ResetShadowModel(Shadow[n]);
-  ResetWeightModel(CMW);
+typedef struct{
+  METASCAN *MS;
+  Threads  *T;
+  }
+SCANJOB;
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void InitMetaScan(METASCAN *MS){
+  memset(MS, 0, sizeof(METASCAN));
+  MS->nThreads = P->nThreads;
+  MS->split    = P->split;
+  MS->warmup   = P->warmup;
+  MS->shard    = P->shard;
+  MS->nShards  = P->nShards;
+  MS->local    = P->local;
+  MS->trace    = P->trace;
+  MS->ckp      = P->ckp;
   }
 
 
@@ -73,121 +120,183 @@ void ResetKModelsAndParam(CBUF *Buf, KMODEL **Shadow, CMWeight *CMW){
 // - - - - - - - - - - L O C A L   C O M P L E X I T Y - - - - - - - - - - - -
 
 #ifdef LOCAL_SIMILARITY
-void LocalComplexity(Threads T, TOP *Top, uint64_t topSize, FILE *OUT){
-  FILE        *Reader = Fopen(P->base, "r");
-  double      bits = 0, instant = 0;
-  uint64_t    nBase = 0, entry;
-  uint32_t    n, totModels, cModel;
-  PARSER      *PA = CreateParser();
-  CBUF        *symBuf = CreateCBuffer(BUFFER_SIZE, BGUARD);
-  uint8_t     *readBuf = (uint8_t *) Calloc(BUFFER_SIZE, sizeof(uint8_t));
-  uint8_t     *pos;
-  PModel      **pModel, *MX;
-  CModel      **Shadow; // SHADOWS FOR SUPPORTING MODELS WITH THREADING
-  FloatPModel *PT;
-  CMWeight    *CMW;
-  int         sym;
+// THE TOP ENTRIES ARE PROFILED BY -n THREADS, EACH WITH ITS OWN MODELS STATE
+// AND DATABASE HANDLE. A PROFILE IS KEPT IN MEMORY AS ONE BYTE PER ENTRY, 
+// (NIBBLE << 3 | SYM), AND WRITTEN IN RANK ORDER BY THE ORDERED STAGE.
 
-  totModels = P->nModels; // EXTRA MODELS DERIVED FROM EDITS
-  for(n = 0 ; n < P->nModels ; ++n) 
-    if(T.model[n].edits != 0)
-      totModels += 1;
+typedef struct{
+  FALCON   *F;
+  Threads  *T;
+  TOP      *Top;
+  ORDER    *O;
+  FILE     *OUT;
+  FALBW    *FW;
+  }
+LOCALJOBS;
 
-  Shadow      = (CModel **) Calloc(P->nModels, sizeof(CModel *));
-  for(n = 0 ; n < P->nModels ; ++n)
-    Shadow[n] = CreateShadowModel(Models[n]); 
-  pModel      = (PModel **) Calloc(totModels, sizeof(PModel *));
-  for(n = 0 ; n < totModels ; ++n)
-    pModel[n] = CreatePModel(ALPHABET_SIZE);
-  MX          = CreatePModel(ALPHABET_SIZE);
-  PT          = CreateFloatPModel(ALPHABET_SIZE);
-  CMW         = CreateWeightModel(totModels);
+typedef struct{
+  uint8_t  *buf;
+  uint64_t size;
+  uint64_t max;
+  }
+PROFBUF;
 
-  for(entry = 0 ; entry < topSize ; ++entry){
-    if(Top->V[entry].size > 1){ 
-      fprintf(stderr, "      [+] Running profile: %-5"PRIu64" ... ", entry + 1);
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-      // PRINT HEADER COMPLEXITY VALUE
-      fprintf(OUT, "#\t%.5lf\t%"PRIu64"\t%s\n", (1.0-Top->V[entry].value)*100.0, 
-      Top->V[entry].size, Top->V[entry].name);
+static void ProfPut(PROFBUF *PB, uint8_t nibble, uint8_t sym){
+  if(PB->size == PB->max){
+    PB->max = PB->max == 0 ? 65536 : PB->max * 2;
+    PB->buf = (uint8_t *) Realloc(PB->buf, PB->max, PB->max / 2);
+    }
+  PB->buf[PB->size++] = nibble << 3 | sym;
+  }
 
-      // MOVE POINTER FORWARD
-      Fseeko(Reader, (off_t) Top->V[entry].iPos-1, SEEK_SET); 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// THE PROFILE WAS KEPT BY THE SCAN (-r): COPY IT FROM THE SPILL. THE SPILLS 
+// ARE SHARED BY THE THREADS, SO THEY ARE READ WITH pread.
+
+static void ProfileFromTrace(PROFBUF *PB, FILE *Spill, int64_t offset){
+  uint64_t size;
+  if(pread(fileno(Spill), &size, sizeof(uint64_t), (off_t) offset) != 
+  (ssize_t) sizeof(uint64_t)){
+    fprintf(stderr, "  [x] Error: failed to read the profile trace!\n");
+    exit(1);
+    }
+  if(size > PB->max){
+    PB->buf = (uint8_t *) Realloc(PB->buf, size, size - PB->max);
+    PB->max = size;
+    }
+  if(pread(fileno(Spill), PB->buf, size, (off_t) offset + sizeof(uint64_t))
+  != (ssize_t) size){
+    fprintf(stderr, "  [x] Error: truncated profile trace!\n");
+    exit(1);
+    }
+  PB->size = size;
+  }
 
-      while((sym = fgetc(Reader)) != EOF){
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-        if(sym == '>'){ // FOUND HEADER & SKIP 
-          while((sym = fgetc(Reader)) != '\n' && sym != EOF)
-            ; // DO NOTHING
+static void ProfileRecord(PROFBUF *PB, FALCON *F, SCRATCH *S, FILE *Reader,
+VT *V){
+  uint64_t nBase = 0;
+  int      sym;
 
-          if(sym == EOF) 
-            break;     // END OF FILE: QUIT
-          }
+  Fseeko(Reader, (off_t) V->iPos-1, SEEK_SET); // MOVE POINTER FORWARD
+  ResetScratch(S); // RESET MODELS & PROPERTIES
+  while((sym = fgetc(Reader)) != EOF){
 
-        if(nBase >= Top->V[entry].size) // IT PROCESSED ALL READ BASES: QUIT!
-          break;
+    if(sym == '>'){ // FOUND HEADER & SKIP 
+      while((sym = fgetc(Reader)) != '\n' && sym != EOF)
+        ; // DO NOTHING
 
-        if(sym == '\n') continue;  // SKIP '\n' IN FASTA
+      if(sym == EOF) 
+        break;     // END OF FILE: QUIT
+      }
 
-        if((sym = DNASymToNum(sym)) == 4){
-          fprintf(OUT, "%c", PackByte(2.0, sym)); // PRINT COMPLEXITY & SYM IN1
-          continue; // IT IGNORES EXTRA SYMBOLS
-          }
+    if(nBase >= V->size) // IT PROCESSED ALL READ BASES: QUIT!
+      break;
 
-        symBuf->buf[symBuf->idx] = sym;
-        memset((void *)PT->freqs, 0, ALPHABET_SIZE * sizeof(double));
-        n = 0;
-        pos = &symBuf->buf[symBuf->idx-1];
-        for(cModel = 0 ; cModel < P->nModels ; ++cModel){
-          CModel *CM = Shadow[cModel];
-          GetPModelIdx(pos, CM);
-          ComputePModel(Models[cModel], pModel[n], CM->pModelIdx, CM->alphaDen);
-          ComputeWeightedFreqs(CMW->weight[n], pModel[n], PT);
-          if(CM->edits != 0){
-            ++n;
-            CM->SUBS.seq->buf[CM->SUBS.seq->idx] = sym;
-            CM->SUBS.idx = GetPModelIdxCorr(CM->SUBS.seq->buf+CM->SUBS.seq->idx
-            -1, CM, CM->SUBS.idx);
-            ComputePModel(Models[cModel], pModel[n], CM->SUBS.idx, CM->SUBS.eDen);
-            ComputeWeightedFreqs(CMW->weight[n], pModel[n], PT);
-            }
-          ++n;
-          }
+    if(sym == '\n') continue;  // SKIP '\n' IN FASTA
 
-        ComputeMXProbs(PT, MX);
-        instant = PModelSymbolLog(MX, sym);
-        bits += instant;
-        fprintf(OUT, "%c", PackByte(instant, sym)); // PRINT COMPLEX & SYM IN1
-        ++nBase;
-        CalcDecayment(CMW, pModel, sym, P->gamma);
-        RenormalizeWeights(CMW);
-        CorrectXModels(Shadow, pModel, sym, P->nModels);
-        UpdateCBuffer(symBuf);
-        }
+    if((sym = DNASymToNum(sym)) == 4){
+      ProfPut(PB, QuadQuantization(2.0), sym); // COMPLEXITY & SYM
+      continue; // IT IGNORES EXTRA SYMBOLS
+      }
+
+    ProfPut(PB, QuadQuantization(MixSymbol(S, F->M, sym, F->gamma)), sym);
+    ++nBase;
+    }
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void WriteProfile(LOCALJOBS *LJ, uint64_t entry, PROFBUF *PB){
+  VT       *V = &LJ->Top->V[entry];
+  uint64_t n;
+
+  // PRINT HEADER COMPLEXITY VALUE (THE BINARY FORMAT KEEPS THE SAME ROUNDING, 
+  // SO BOTH FORMATS ARE FILTERED IN THE SAME WAY)
+  if(LJ->FW != NULL){
+    char value[64];
+    sprintf(value, "%.5lf", (1.0-V->value)*100.0);
+    FalbBegin(LJ->FW, strtod(value, NULL), V->size, TopName(LJ->Top, entry));
+    for(n = 0 ; n < PB->size ; ++n)
+      FalbPut(LJ->FW, PB->buf[n] >> 3, PB->buf[n] & 7);
+    FalbEnd(LJ->FW);
+    }
+  else{
+    fprintf(LJ->OUT, "#\t%.5lf\t%"PRIu64"\t%s\n", (1.0-V->value)*100.0, 
+    V->size, TopName(LJ->Top, entry));
+    for(n = 0 ; n < PB->size ; ++n)
+      putc(PackByte((PB->buf[n] >> 3) * 0.25, PB->buf[n] & 7), LJ->OUT);
+    putc('\n', LJ->OUT);
+    }
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-      if(entry < topSize - 1){ // RESET MODELS & PROPERTIES
-        ResetModelsAndParam(symBuf, Shadow, CMW);
-        nBase = bits = 0;
+void *LocalThread(void *Lj){
+  LOCALJOBS *LJ = (LOCALJOBS *) Lj;
+  SCRATCH   *S = CreateScratch(LJ->F->M, LJ->F->nModels);
+  FILE      *Reader = NULL;
+  PROFBUF   PB = { NULL, 0, 0 };
+  uint32_t  dbIdx = 0;
+  int64_t   job;
+  VT        *V;
+
+  while((job = OrderClaim(LJ->O)) != -1){
+    V = &LJ->Top->V[job];
+    PB.size = 0;
+    if(V->size > 1){
+      if(V->trace >= 0)
+        ProfileFromTrace(&PB, LJ->T[V->tId].spill, V->trace);
+      else{
+        // THE ENTRIES MAY COME FROM DIFFERENT DATABASES
+        if(Reader == NULL || V->dbIndex != dbIdx){
+          if(Reader != NULL)
+            fclose(Reader);
+          dbIdx  = V->dbIndex;
+          Reader = Fopen(P->dbFiles[dbIdx], "r");
+          }
+        ProfileRecord(&PB, LJ->F, S, Reader, V);
         }
+      }
 
-      fprintf(OUT, "\n");
-      fprintf(stderr, "Done!\n");
+    OrderBegin(LJ->O, job);
+    if(V->size > 1){
+      WriteProfile(LJ, job, &PB);
+      fprintf(stderr, "      [+] Running profile: %-5"PRIu64" ... Done!\n",
+      job + 1);
       }
-    } 
+    OrderEnd(LJ->O);
+    }
 
-  DeleteWeightModel(CMW);
-  for(n = 0 ; n < totModels ; ++n)
-    RemovePModel(pModel[n]);
-  Free(pModel);
-  RemovePModel(MX);
-  RemoveFPModel(PT);
-  for(n = 0 ; n < P->nModels ; ++n)
-    FreeShadow(Shadow[n]);
-  Free(Shadow);
-  Free(readBuf);
-  RemoveCBuffer(symBuf);
-  RemoveParser(PA);
-  fclose(Reader);
+  if(PB.buf != NULL)
+    Free(PB.buf);
+  RemoveScratch(S);
+  if(Reader != NULL)
+    fclose(Reader);
+  return NULL;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void LocalComplexity(FALCON *F, Threads *T, TOP *Top, uint64_t topSize, 
+FILE *OUT, FALBW *FW){
+  LOCALJOBS LJ = { F, T, Top, NULL, OUT, FW };
+  pthread_t t[P->nThreads];
+  uint32_t  n;
+
+  for(n = 0 ; n < P->nThreads ; ++n)
+    if(T[n].spill != NULL)
+      fflush(T[n].spill); // THE TRACES ARE READ WITH pread
+
+  LJ.O = CreateOrder(topSize);
+  for(n = 0 ; n < P->nThreads ; ++n)
+    pthread_create(&(t[n]), NULL, LocalThread, (void *) &LJ);
+  for(n = 0 ; n < P->nThreads ; ++n)
+    pthread_join(t[n], NULL);
+  RemoveOrder(LJ.O);
   }
 #endif
 
@@ -532,261 +641,391 @@ void CompressTargetWKM(Threads T){
   }
   
 
+//////////////////////////////////////////////////////////////////////////////
+// - - - - - - - - - - - - - - - S H A R D S - - - - - - - - - - - - - - - - -
+//
+// WITH --shard i/N, THE RECORD r OF THE DATABASE d IS SCANNED BY THE SHARD 
+// (r + d) % N, SO THE RECORDS ARE DEALT ROUND ROBIN OVER THE SHARDS WITHOUT A
+// PASS TO COUNT THEM AND THE SHARDS GET NEARLY THE SAME NUMBER OF RECORDS. 
+// INSIDE A SHARD, ITS RECORDS ARE DEALT OVER THE THREADS IN THE SAME WAY. 
+// WITHOUT SHARDS IT IS THE USUAL r % nThreads OWNER.
+
+static int InShard(METASCAN *MS, uint64_t rec){
+  return MS->nShards < 2 || (rec + MS->dbIdx) % MS->nShards == MS->shard;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// POSITION OF THE RECORD AMONG THE RECORDS OF ITS SHARD
+
+static uint64_t ShardRec(METASCAN *MS, uint64_t rec){
+  return MS->nShards < 2 ? rec : (rec + MS->dbIdx) / MS->nShards;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static int RecOwner(METASCAN *MS, uint64_t rec, uint32_t id){
+  return InShard(MS, rec) && ShardRec(MS, rec) % MS->nThreads == id;
+  }
+
+
+//////////////////////////////////////////////////////////////////////////////
+// - - - - - - - - - - - - - - - C H U N K S - - - - - - - - - - - - - - - - -
+//
+// WITH -k, THE BASES OF A RECORD ARE CUT IN CHUNKS OF MS->split BASES AND
+// THE CHUNK c OF THE RECORD r IS SCORED BY THE THREAD (r + c) % nThreads. 
+// RECORDS SHORTER THAN A CHUNK KEEP THE USUAL r % nThreads OWNER. BEFORE 
+// SCORING A CHUNK, THE THREAD RUNS THE MS->warmup PREVIOUS BASES THROUGH THE
+// MODELS (WITH NO BITS COUNTED) SO THAT THE SHADOW CONTEXTS, THE SUBS STATE 
+// AND THE MIXER WEIGHTS ARE CLOSE TO THE ONES OF A SEQUENTIAL RUN. THE BITS 
+// OF THE CHUNKS ARE SUMMED AFTER THE THREADS JOIN.
+//
+// THE REFERENCE COUNTS ARE STATIC WHILE SCORING, HENCE THE CONTEXTS ARE EXACT 
+// AS SOON AS THE WARM-UP IS LONGER THAN THE DEEPEST CONTEXT. WHAT REMAINS 
+// APPROXIMATE IS THE STATE THAT DEPENDS ON THE WHOLE PAST: THE MIXER WEIGHTS 
+// (FORGETTING FACTOR GAMMA, SO THE DIFFERENCE DECAYS AS GAMMA^WARMUP) AND THE 
+// SUBS HISTORY OF THE TOLERANT MODELS (IT RESTARTS FROM THE WARM-UP WINDOW).
+// IN PRACTICE THE SIMILARITY CHANGES ON THE THIRD OR FOURTH DECIMAL PLACE.
+
+#define CHUNK_SKIP   0
+#define CHUNK_WARM   1
+#define CHUNK_SCORE  2
+
+static int ChunkMode(METASCAN *MS, uint64_t rec, uint64_t pos, uint32_t id){
+  uint64_t chunk = pos / MS->split;
+  if(!InShard(MS, rec))
+    return CHUNK_SKIP;
+  rec = ShardRec(MS, rec);
+  if((rec + chunk) % MS->nThreads == id)
+    return CHUNK_SCORE;
+  if((chunk + 1) * MS->split - pos <= MS->warmup && 
+  (rec + chunk + 1) % MS->nThreads == id)
+    return CHUNK_WARM;
+  return CHUNK_SKIP;
+  }
+
+
 //////////////////////////////////////////////////////////////////////////////
 // - - - - - - - - - - - - - - C O M P R E S S I O N - - - - - - - - - - - - - 
 
-void CompressTarget(Threads T, char *dbFile){
-  FILE        *Reader = CFopen(dbFile, "r");
-  double      bits = 0;
-  uint64_t    nBase = 0, r = 0, nSymbol, initNSymbol;
-  uint32_t    n, k, idxPos, totModels, cModel;
-  PARSER      *PA = CreateParser();
-  CBUF        *symBuf = CreateCBuffer(BUFFER_SIZE, BGUARD);
-  uint8_t     *readBuf = (uint8_t *) Calloc(BUFFER_SIZE, sizeof(uint8_t));
-  uint8_t     sym, *pos, conName[MAX_NAME];
-  PModel      **pModel, *MX;
-  CModel      **Shadow; // SHADOWS FOR SUPPORTING MODELS WITH THREADING
-  FloatPModel *PT;
-  CMWeight    *CMW;
-  int         action;
+#ifdef LOCAL_SIMILARITY
+// WITH -r THE SCAN KEEPS THE PROFILE OF THE RECORD THAT IS BEING SCORED. WHEN
+// THE RECORD ENTERS THE TOP, ITS PROFILE IS SPILLED TO THE FILE OF THE THREAD,
+// SO -Z CAN WRITE IT WITHOUT COMPRESSING THE RECORD AGAIN. THE ENTRIES ARE THE
+// SAME AS IN LocalComplexity: ANY OTHER SEQUENCE SYMBOL IS AN N (2.0 BITS) AND
+// THE SYMBOLS AFTER THE LAST BASE ARE LEFT OUT. A RECORD LONGER THAN THE LIMIT
+// (OR SPLIT IN CHUNKS) IS NOT TRACED AND IT IS COMPRESSED AGAIN BY -Z. THE 
+// PROFILES OF EVICTED RECORDS ARE DROPPED BY CompactSpill.
+
+#define SPILL_MIN_COMPACT (1 << 20) // Smaller spills are never compacted
+
+static void TraceSym(METASCAN *MS, Threads *T, uint8_t sym, double instant){
+  if(T->trace == NULL || T->trace->idx < 0)
+    return;
+  if((uint64_t) T->trace->idx == MS->trace){
+    T->trace->idx = -1; // TOO LONG: NOT TRACED
+    return;
+    }
+  UpdateStream(T->trace, sym, instant);
+  }
 
-  totModels = P->nModels; // EXTRA MODELS DERIVED FROM EDITS
-  for(n = 0 ; n < P->nModels ; ++n) 
-    if(T.model[n].edits != 0)
-      totModels += 1;
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  Shadow      = (CModel **) Calloc(P->nModels, sizeof(CModel *));
-  for(n = 0 ; n < P->nModels ; ++n)
-    Shadow[n] = CreateShadowModel(Models[n]); 
-  pModel      = (PModel **) Calloc(totModels, sizeof(PModel *));
-  for(n = 0 ; n < totModels ; ++n)
-    pModel[n] = CreatePModel(ALPHABET_SIZE);
-  MX          = CreatePModel(ALPHABET_SIZE);
-  PT          = CreateFloatPModel(ALPHABET_SIZE);
-  CMW         = CreateWeightModel(totModels);
+static void SpillError(void){
+  fprintf(stderr, "  [x] Error: unable to write the trace spill!\n");
+  exit(1);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static int TraceCmp(const void *a, const void *b){
+  int64_t x = (*(VT **) a)->trace, y = (*(VT **) b)->trace;
+  return (x > y) - (x < y);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// MOVES size BYTES OF THE SPILL FROM from TO to (to <= from)
+
+static void SpillMove(int fd, uint8_t *buf, uint64_t from, uint64_t to,
+uint64_t size){
+  uint64_t k, c;
+  for(k = 0 ; k < size ; k += c){
+    c = size - k < BUFFER_SIZE ? size - k : BUFFER_SIZE;
+    if(pread(fd, buf, c, (off_t) (from + k)) != (ssize_t) c){
+      fprintf(stderr, "  [x] Error: truncated profile trace!\n");
+      exit(1);
+      }
+    if(pwrite(fd, buf, c, (off_t) (to + k)) != (ssize_t) c)
+      SpillError();
+    }
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// THE SPILL ONLY GROWS. EACH TIME IT DOUBLES, THE BYTES OF THE PROFILES STILL
+// IN THE TOP OF THE THREAD (THE ONLY ONES THAT ARE READ) ARE COUNTED AND, IF
+// THE DEAD BYTES EXCEED THEM, THE LIVE PROFILES ARE MOVED TO THE START OF THE
+// SPILL (IN THE ORDER OF THEIR OFFSETS, SO NONE IS OVERWRITTEN BEFORE IT IS
+// MOVED) AND THE REST IS CUT. SO THE SPILL STAYS WITHIN A FEW TIMES topSize x
+// -r BYTES, WHATEVER THE ORDER OF THE SCORES. THE FILE IS THE SAME, AS THE
+// THREADS ARRAY AND THE SCAN KEEP ITS POINTER.
+
+static void CompactSpill(Threads *T){
+  int      fd = fileno(T->spill);
+  uint64_t end, live = 0, size, to = 0, n, k = 0;
+  uint8_t  *buf;
+  off_t    at;
+  VT       **V;
+
+  if(fflush(T->spill) != 0 || (at = ftello(T->spill)) < 0)
+    SpillError();
+  if((end = at) < SPILL_MIN_COMPACT || end < 2 * T->spillMark)
+    return;
+
+  V = (VT **) Malloc(T->top->size * sizeof(VT *));
+  for(n = 0 ; n < T->top->size ; ++n)
+    if(T->top->V[n].trace >= 0){
+      V[k] = &T->top->V[n];
+      if(pread(fd, &size, sizeof(uint64_t), (off_t) V[k]->trace) != 
+      (ssize_t) sizeof(uint64_t)){
+        fprintf(stderr, "  [x] Error: failed to read the profile trace!\n");
+        exit(1);
+        }
+      live += sizeof(uint64_t) + size;
+      ++k;
+      }
+  if(end - live <= live){
+    T->spillMark = end;
+    Free(V);
+    return;
+    }
+
+  qsort(V, k, sizeof(VT *), TraceCmp);
+  buf = (uint8_t *) Malloc(BUFFER_SIZE);
+  for(n = 0 ; n < k ; ++n){
+    if(pread(fd, &size, sizeof(uint64_t), (off_t) V[n]->trace) != (ssize_t)
+    sizeof(uint64_t)){
+      fprintf(stderr, "  [x] Error: failed to read the profile trace!\n");
+      exit(1);
+      }
+    SpillMove(fd, buf, V[n]->trace, to, sizeof(uint64_t) + size);
+    V[n]->trace = (int64_t) to;
+    to += sizeof(uint64_t) + size;
+    }
+  if(ftruncate(fd, (off_t) to) != 0 || fseeko(T->spill, (off_t) to, 
+  SEEK_SET) != 0)
+    SpillError();
+  T->spillMark = to;
+  Free(buf);
+  Free(V);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void UpdateTopTraced(METASCAN *MS, Threads *T, double bits, uint8_t 
+*nm, uint64_t nBase, uint64_t iPos, uint64_t ePos){
+  STREAM   *S = T->trace;
+  uint64_t n, size;
+  off_t    at;
+
+  if(S == NULL || S->idx < 0){
+    UpdateTopWPWithDb(bits, nm, T->top, nBase, iPos, ePos, MS->dbIdx);
+    return;
+    }
+
+  for(size = S->idx ; size > 0 && S->bases[size-1] == 4 ; --size)
+    ; // THE SYMBOLS AFTER THE LAST BASE ARE NOT IN THE PROFILE
+
+  if((at = ftello(T->spill)) < 0)
+    SpillError();
+  if(UpdateTopWPTrace(bits, nm, T->top, nBase, iPos, ePos, MS->dbIdx, 
+  (int64_t) at, T->id) == 1){
+    if(fwrite(&size, sizeof(uint64_t), 1, T->spill) != 1)
+      SpillError();
+    for(n = 0 ; n < size ; ++n)
+      if(putc(QuadQuantization(S->bits[n]) << 3 | S->bases[n], T->spill) ==
+      EOF)
+        SpillError();
+    CompactSpill(T);
+    }
+  }
+#endif
+
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// THE RECORD SPLIT AND THE SCORES OF THE LIBRARY SCAN (FalconParse AND THE
+// MODELS AND GAMMA OF THE CONTEXT MS->F), WITH THE SHARDS, CHUNKS,
+// CHECKPOINTS AND PROFILES OF meta. RETURNS THE NUMBER OF MIXED SYMBOLS.
+
+uint64_t CompressTarget(METASCAN *MS, Threads T){
+  FALCON      *F = MS->F;
+  FILE        *Reader = CFopen(MS->db, "r");
+  double      bits = 0, instant;
+  uint64_t    nBase = 0, nSymbol, initNSymbol, pos = 0, mixed = 0;
+  uint32_t    k, idxPos, r = 0;
+  PARSER      *PA = CreateParser();
+  SCRATCH     *S = CreateScratch(F->M, F->nModels); // PER-RECORD STATE
+  uint8_t     *readBuf = (uint8_t *) Calloc(BUFFER_SIZE, sizeof(uint8_t));
+  uint8_t     sym, conName[MAX_NAME], cold = 0, done;
+  int         action, mode;
+  double      ckpAt = WallClock() + MS->ckp;
 
+  done = TopRec(MS->dbIdx, 0) <= T.resume;
   initNSymbol = nSymbol = 0;
+  conName[0] = '\0';
   while((k = fread(readBuf, 1, BUFFER_SIZE, Reader)))
     for(idxPos = 0 ; idxPos < k ; ++idxPos){
       ++nSymbol;
-      if((action = ParseMF(PA, (sym = readBuf[idxPos]))) < 0){
+      if((action = FalconParse(PA, (sym = readBuf[idxPos]), conName, &r))
+      < 0){
         switch(action){
           case -1: // IT IS THE BEGGINING OF THE HEADER
-            if((PA->nRead-1) % P->nThreads == T.id && PA->nRead>1 && nBase>1){
+            if(MS->split != 0 && pos > MS->split){ // RECORD SPLIT IN CHUNKS
+              if(PA->nRead > 1 && nBase > 0)
+                AddPartial(T.parts, PA->nRead-1, bits, nBase, conName,
+                initNSymbol, nSymbol, MS->dbIdx);
+              }
+            else if(PA->nRead > 1 && nBase > 1 && RecOwner(MS, PA->nRead-1,
+            T.id)){
+              T.top->rec = TopRec(MS->dbIdx, PA->nRead-1);
               #ifdef LOCAL_SIMILARITY
-              if(P->local == 1){
-                UpdateTopWPWithDb(BPBB(bits, nBase), conName, T.top, nBase,
-                initNSymbol, nSymbol, P->currentDBIdx);
+              if(MS->local == 1){
+                UpdateTopTraced(MS, &T, BPBB(bits, nBase), conName, nBase,
+                initNSymbol, nSymbol);
                 }
               else
-                UpdateTopWithDB(BPBB(bits, nBase), conName, T.top, nBase, P->currentDBIdx);
+                UpdateTopWithDB(BPBB(bits, nBase), conName, T.top, nBase, MS->dbIdx);
               #else
               UpdateTop(BPBB(bits, nBase), conName, T.top, nBase);
               #endif
               }
+            if(MS->CK != NULL && TopRec(MS->dbIdx, PA->nRead-1) > 
+            T.resume && WallClock() >= ckpAt){
+              ScanCkpPut(MS->CK, T.id, TopRec(MS->dbIdx, PA->nRead-1),
+              T.top, T.parts);
+              ckpAt = WallClock() + MS->ckp;
+              }
+            done = TopRec(MS->dbIdx, PA->nRead) <= T.resume;
             #ifdef LOCAL_SIMILARITY
             initNSymbol = nSymbol; 
             #endif  
-            ResetModelsAndParam(symBuf, Shadow, CMW); // RESET MODELS
-            r = nBase = bits = 0;
+            ResetScratch(S); // RESET MODELS
+            #ifdef LOCAL_SIMILARITY
+            if(T.trace != NULL)
+              ResetStream(T.trace);
+            #endif
+            nBase = bits = 0;
+            pos = cold = 0;
+          break;
+          case -99: // IF IS A SIMPLE FORMAT BREAK OR AN EXTRA SYMBOL
+            #ifdef LOCAL_SIMILARITY
+            if(sym != '\n' && !done && RecOwner(MS, PA->nRead, T.id) && 
+            (MS->split == 0 || pos < MS->split))
+              TraceSym(MS, &T, 4, 2.0);
+            #endif
           break;
-          case -2: conName[r] = '\0'; break; // IT IS THE '\n' HEADER END
-          case -3: // IF IS A SYMBOL OF THE HEADER
-            if(r >= MAX_NAME-1)
-              conName[r] = '\0';
-            else{
-              if(sym == ' ' || sym < 32 || sym > 126){ // PROTECT INTERVAL
-                if(r == 0) continue;
-                else       sym = '_'; // PROTECT OUT SYM WITH UNDERL
-                }
-              conName[r++] = sym;
-              }
-          break; 
-          case -99: break; // IF IS A SIMPLE FORMAT BREAK
-          default: exit(1);
           }
         continue; // GO TO NEXT SYMBOL
         }
 
-      if(PA->nRead % P->nThreads == T.id){
-
-        if((sym = DNASymToNum(sym)) == 4){
+      if(MS->split == 0){
+        if(done || !RecOwner(MS, PA->nRead, T.id))
+          continue;
+        if((sym = DNASymToNum(sym)) == 4)
+          continue; // IT IGNORES EXTRA SYMBOLS
+        mode = CHUNK_SCORE;
+        }
+      else{
+        if(done || (sym = DNASymToNum(sym)) == 4)
           continue; // IT IGNORES EXTRA SYMBOLS
+        if((mode = ChunkMode(MS, PA->nRead, pos++, T.id)) == CHUNK_SKIP){
+          cold = 1;
+          continue;
           }
-
-        symBuf->buf[symBuf->idx] = sym;
-        memset((void *)PT->freqs, 0, ALPHABET_SIZE * sizeof(double));
-        n = 0;
-        pos = &symBuf->buf[symBuf->idx-1];
-        for(cModel = 0 ; cModel < P->nModels ; ++cModel){
-          CModel *CM = Shadow[cModel];
-          GetPModelIdx(pos, CM);
-          ComputePModel(Models[cModel], pModel[n], CM->pModelIdx, CM->alphaDen);
-          ComputeWeightedFreqs(CMW->weight[n], pModel[n], PT);
-          if(CM->edits != 0){
-            ++n;
-            CM->SUBS.seq->buf[CM->SUBS.seq->idx] = sym;
-            CM->SUBS.idx = GetPModelIdxCorr(CM->SUBS.seq->buf+CM->SUBS.seq->idx
-            -1, CM, CM->SUBS.idx);
-            ComputePModel(Models[cModel], pModel[n], CM->SUBS.idx, CM->SUBS.eDen);
-            ComputeWeightedFreqs(CMW->weight[n], pModel[n], PT);
-            }
-          ++n;
+        if(cold == 1){ // A NEW CHUNK STARTS FROM CLEAN MODELS
+          ResetScratch(S);
+          cold = 0;
           }
+        }
 
-        ComputeMXProbs(PT, MX);
-        bits += PModelSymbolLog(MX, sym);
+      instant = MixSymbol(S, F->M, sym, F->gamma);
+      ++mixed;
+      if(mode == CHUNK_SCORE){
+        bits += instant;
         ++nBase;
-        CalcDecayment(CMW, pModel, sym, P->gamma);
-        RenormalizeWeights(CMW);
-        CorrectXModels(Shadow, pModel, sym, P->nModels);
-        UpdateCBuffer(symBuf);
+        #ifdef LOCAL_SIMILARITY
+        TraceSym(MS, &T, sym, instant);
+        #endif
         }
       }
         
-  if(PA->nRead % P->nThreads == T.id){
+  if(MS->split != 0 && pos > MS->split){ // RECORD SPLIT IN CHUNKS
+    if(nBase > 0)
+      AddPartial(T.parts, PA->nRead, bits, nBase, conName, initNSymbol,
+      nSymbol, MS->dbIdx);
+    }
+  else if(!done && RecOwner(MS, PA->nRead, T.id)){
+    T.top->rec = TopRec(MS->dbIdx, PA->nRead);
     #ifdef LOCAL_SIMILARITY
-    if(P->local == 1)
-      UpdateTopWPWithDb(BPBB(bits, nBase), conName, T.top, nBase,
-      initNSymbol, nSymbol, P->currentDBIdx);
+    if(MS->local == 1)
+      UpdateTopTraced(MS, &T, BPBB(bits, nBase), conName, nBase, initNSymbol,
+      nSymbol);
     else
-      UpdateTopWithDB(BPBB(bits, nBase), conName, T.top, nBase, P->currentDBIdx);
+      UpdateTopWithDB(BPBB(bits, nBase), conName, T.top, nBase, MS->dbIdx);
     #else
     UpdateTop(BPBB(bits, nBase), conName, T.top, nBase);
     #endif
     }
 
-  DeleteWeightModel(CMW);
-  for(n = 0 ; n < totModels ; ++n)
-    RemovePModel(pModel[n]);
-  Free(pModel);
-  RemovePModel(MX);
-  RemoveFPModel(PT);
-  for(n = 0 ; n < P->nModels ; ++n)
-    FreeShadow(Shadow[n]);
-  Free(Shadow);
+  #ifdef HASH_STATS
+  for(k = 0 ; k < S->totModels ; ++k){
+    T.lookups[k] += S->lookups[k];
+    T.found[k]   += S->found[k];
+    }
+  #endif
+  RemoveScratch(S);
   Free(readBuf);
-  RemoveCBuffer(symBuf);
   RemoveParser(PA);
   fclose(Reader);
+  return mixed;
   }
 
-void CompressTargetInter(Threads T){
-  FILE        *Reader  = Fopen(P->files[T.id], "r");
-  double      *cModelWeight, cModelTotalWeight = 0, bits = 0, instance = 0;
+double CompressTargetInter(CModel **M, uint32_t tar){
+  FILE        *Reader  = Fopen(P->files[tar], "r");
+  double      bits = 0;
   uint64_t    nBase = 0;
-  uint32_t    n, k, idxPos, totModels, cModel;
+  uint32_t    k, idxPos;
   PARSER      *PA = CreateParser();
-  CBUF        *symBuf = CreateCBuffer(BUFFER_SIZE, BGUARD);
+  SCRATCH     *S = CreateScratch(M, P->nModels);
   uint8_t     *readBuf = (uint8_t *) Calloc(BUFFER_SIZE, sizeof(uint8_t));
-  uint8_t     sym, *pos;
-  PModel      **pModel, *MX;
-  CModel      **Shadow;
-  FloatPModel *PT;
+  uint8_t     sym;
 
-  totModels = P->nModels; // EXTRA MODELS DERIVED FROM EDITS
-  for(n = 0 ; n < P->nModels ; ++n)
-    if(T.model[n].edits != 0)
-      totModels += 1;
-
-  Shadow = (CModel **) Calloc(P->nModels, sizeof(CModel *));
-  for(n = 0 ; n < P->nModels ; ++n)
-    Shadow[n] = CreateShadowModel(Models[n]);
-  pModel        = (PModel  **) Calloc(totModels, sizeof(PModel *));
-  for(n = 0 ; n < totModels ; ++n)
-    pModel[n]   = CreatePModel(ALPHABET_SIZE);
-  MX            = CreatePModel(ALPHABET_SIZE);
-  PT            = CreateFloatPModel(ALPHABET_SIZE);
-  cModelWeight  = (double   *) Calloc(totModels, sizeof(double));
-
-  for(n = 0 ; n < totModels ; ++n)
-    cModelWeight[n] = 1.0 / totModels;
-
-  FileType(PA, Reader);
+  FileType(PA, Reader);
 
   nBase = 0;
   while((k = fread(readBuf, 1, BUFFER_SIZE, Reader)))
     for(idxPos = 0 ; idxPos < k ; ++idxPos){
       if(ParseSym(PA, (sym = readBuf[idxPos])) == -1) continue;
-      symBuf->buf[symBuf->idx] = sym = DNASymToNum(sym);
-
-      memset((void *)PT->freqs, 0, ALPHABET_SIZE * sizeof(double));
-
-      n = 0;
-      pos = &symBuf->buf[symBuf->idx-1];
-      for(cModel = 0 ; cModel < P->nModels ; ++cModel){
-        GetPModelIdx(pos, Shadow[cModel]);
-        ComputePModel(Models[cModel], pModel[n], Shadow[cModel]->pModelIdx,
-        Shadow[cModel]->alphaDen);
-        ComputeWeightedFreqs(cModelWeight[n], pModel[n], PT);
-        if(Shadow[cModel]->edits != 0){
-          ++n;
-          Shadow[cModel]->SUBS.seq->buf[Shadow[cModel]->SUBS.seq->idx] = sym;
-          Shadow[cModel]->SUBS.idx = GetPModelIdxCorr(Shadow[cModel]->SUBS.
-          seq->buf+Shadow[cModel]->SUBS.seq->idx-1, Shadow[cModel], Shadow
-          [cModel]->SUBS.idx);
-          ComputePModel(Models[cModel], pModel[n], Shadow[cModel]->SUBS.idx,
-          Shadow[cModel]->SUBS.eDen);
-          ComputeWeightedFreqs(cModelWeight[n], pModel[n], PT);
-          }
-        ++n;
-        }
-
-      MX->sum  = (MX->freqs[0] = 1 + (unsigned) (PT->freqs[0] * MX_PMODEL));
-      MX->sum += (MX->freqs[1] = 1 + (unsigned) (PT->freqs[1] * MX_PMODEL));
-      MX->sum += (MX->freqs[2] = 1 + (unsigned) (PT->freqs[2] * MX_PMODEL));
-      MX->sum += (MX->freqs[3] = 1 + (unsigned) (PT->freqs[3] * MX_PMODEL));
-      bits += (instance = PModelSymbolLog(MX, sym));
+      bits += MixSymbol(S, M, DNASymToNum(sym), P->gamma);
       nBase++;
-
-      cModelTotalWeight = 0;
-      for(n = 0 ; n < totModels ; ++n){
-        cModelWeight[n] = Power(cModelWeight[n], P->gamma) * (double)
-        pModel[n]->freqs[sym] / pModel[n]->sum;
-        cModelTotalWeight += cModelWeight[n];
-        }
-
-      for(n = 0 ; n < totModels ; ++n)
-        cModelWeight[n] /= cModelTotalWeight; // RENORMALIZE THE WEIGHTS
-
-      n = 0;
-      for(cModel = 0 ; cModel < P->nModels ; ++cModel){
-        if(Shadow[cModel]->edits != 0){
-          CorrectCModelSUBS(Shadow[cModel], pModel[++n], sym);
-          }
-        ++n;
-        }
-
-      UpdateCBuffer(symBuf);
       }
 
-  Free(cModelWeight);
-  for(n = 0 ; n < totModels ; ++n)
-    RemovePModel(pModel[n]);
-  Free(pModel);
-  RemovePModel(MX);
-  RemoveFPModel(PT);
-  for(n = 0 ; n < P->nModels ; ++n)
-    FreeShadow(Shadow[n]);
-  Free(Shadow);
+  RemoveScratch(S);
   Free(readBuf);
-  RemoveCBuffer(symBuf);
   RemoveParser(PA);
   fclose(Reader);
 
-  P->matrix[P->ref][T.id] = nBase == 0 ? 101 : bits / 2 / nBase; // 101 -> nan
+  return nBase == 0 ? 101 : bits / 2 / nBase; // 101 -> nan
   }
 
 
 //////////////////////////////////////////////////////////////////////////////
 // - - - - - - - - - - - - F   T H R E A D I N G - - - - - - - - - - - - - - -
 
-void *CompressThread(void *Thr){
-  Threads *T = (Threads *) Thr;
+void *CompressThread(void *Sj){
+  METASCAN *MS = ((SCANJOB *) Sj)->MS;
+  Threads  *T = ((SCANJOB *) Sj)->T;
+  double   start = WallClock();
+  uint64_t bases = 0;
 
-  // Use the current database
-  char *currentDb = P->dbFiles[P->currentDBIdx];
-  
   //  if(P->nModels == 1 && T->model[0].edits == 0){
   //    if(P->sample > 1){
   //      SamplingCompressTarget(T[0]);
@@ -796,73 +1035,36 @@ void *CompressThread(void *Thr){
   //      }
   //    }
 
+  if(T->resume >= TopRec(MS->dbIdx + 1, 0) - 1)
+    return NULL; // THE WHOLE DATABASE IS IN THE CHECKPOINT
+
   #ifdef KMODELSUSAGE
   CompressTargetWKM(T[0]);
   #else
-  CompressTarget(T[0], currentDb);
+  bases = CompressTarget(MS, T[0]);
   #endif
+  ThreadPhase(MS->ST, T->id, WallClock() - start, bases); // BUSY TIME
 
   pthread_exit(NULL);
   }
 
-void *CompressThreadInter(void *Thr){
-  Threads *T = (Threads *) Thr;
-  CompressTargetInter(T[0]);
-  pthread_exit(NULL);
-}
-
 
 //////////////////////////////////////////////////////////////////////////////
 // - - - - - - - - - - - - - - - - R E F E R E N C E - - - - - - - - - - - - -
 
-void LoadReference(char *refName){
-  FILE     *Reader = CFopen(refName, "r");
-  uint32_t n;
-  uint64_t idx = 0;
-  uint64_t k, idxPos;
-  PARSER   *PA = CreateParser();
-  CBUF     *symBuf  = CreateCBuffer(BUFFER_SIZE, BGUARD);
-  uint8_t  *readBuf = Calloc(BUFFER_SIZE, sizeof(uint8_t));
-  uint8_t  sym, irSym = 0;
-  FileType(PA, Reader);
-  rewind(Reader);
-
-  while((k = fread(readBuf, 1, BUFFER_SIZE, Reader)))
-    for(idxPos = 0 ; idxPos < k ; ++idxPos){
-
-      if(ParseSym(PA, (sym = readBuf[idxPos])) == -1){ 
-        idx = 0; 
-	continue; 
-        }
-
-      symBuf->buf[symBuf->idx] = sym = DNASymToNum(sym);
+uint64_t LoadReferenceModels(CModel **M, char *refName){
+  return TrainModels(M, P->nModels, refName);
+  }
 
-      for(n = 0 ; n < P->nModels ; ++n){
-        CModel *CM = Models[n];
-        GetPModelIdx(symBuf->buf+symBuf->idx-1, CM);
-        if(CM->ir == 1) // INVERTED REPEATS
-          irSym = GetPModelIdxIR(symBuf->buf+symBuf->idx, CM);
-        if(idx >= CM->ctx){
-          UpdateCModelCounter(CM, sym, CM->pModelIdx);
-          if(CM->ir == 1) // INVERTED REPEATS
-            UpdateCModelCounter(CM, irSym, CM->pModelIdxIR);
-          }
-        }
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-      ++idx;
-      UpdateCBuffer(symBuf);
-      }
- 
-  for(n = 0 ; n < P->nModels ; ++n)
-    ResetCModelIdx(Models[n]);
-  RemoveCBuffer(symBuf);
-  Free(readBuf);
-  RemoveParser(PA);
-  fclose(Reader);
+uint64_t LoadReference(char *refName){
+  return LoadReferenceModels(Models, refName);
   }
 
-void LoadReferenceInter(Threads T){
-  FILE     *Reader = Fopen(P->files[T.id], "r");
+
+void LoadReferenceInter(CModel **M, uint32_t ref){
+  FILE     *Reader = Fopen(P->files[ref], "r");
   uint32_t n;
   uint64_t idx = 0;
   uint64_t k, idxPos;
@@ -877,7 +1079,7 @@ void LoadReferenceInter(Threads T){
       if(ParseSym(PA, (sym = readBuf[idxPos])) == -1){ idx = 0; continue; }
       symBuf->buf[symBuf->idx] = sym = DNASymToNum(sym);
       for(n = 0 ; n < P->nModels ; ++n){
-        CModel *CM = Models[n];
+        CModel *CM = M[n];
         GetPModelIdx(symBuf->buf+symBuf->idx-1, CM);
         if(++idx > CM->ctx){
           UpdateCModelCounter(CM, sym, CM->pModelIdx);
@@ -891,7 +1093,7 @@ void LoadReferenceInter(Threads T){
     }
 
   for(n = 0 ; n < P->nModels ; ++n)
-    ResetCModelIdx(Models[n]);
+    ResetCModelIdx(M[n]);
   RemoveCBuffer(symBuf);
   Free(readBuf);
   RemoveParser(PA);
@@ -941,23 +1143,191 @@ void LoadReferenceWKM(char *refName){
   }
 
 
+#ifdef HASH_STATS
+//////////////////////////////////////////////////////////////////////////////
+// - - - - - - - - - - - - - H A S H   S T A T S - - - - - - - - - - - - - - -
+//
+// ONLY COMPILED WITH HASH_STATS (SEE defs.h). THE TRAINING EVENTS ARE KEPT 
+// IN THE MODELS AND THE LOOKUPS OF THE SCAN IN EACH THREAD.
+
+static void PrintLookup(char *item, uint64_t lookups, uint64_t found){
+  int pad = 29 - (int) strlen(item);
+  fprintf(stderr, "  [+] %s %.*s %"PRIu64" (%.2lf%% missed)\n", item, pad < 3 ?
+  3 : pad, "................................", lookups, lookups == 0 ? 0 :
+  100.0 * (lookups - found) / lookups);
+  }
+
+static void PrintLookups(Threads *T, uint32_t n, char *what){
+  uint64_t lookups = 0, found = 0;
+  uint32_t t;
+  char     item[64];
+
+  for(t = 0 ; t < P->nThreads ; ++t){
+    sprintf(item, "%s, thread %u", what, t + 1);
+    PrintLookup(item, T[t].lookups[n], T[t].found[n]);
+    lookups += T[t].lookups[n];
+    found   += T[t].found[n];
+    }
+  sprintf(item, "%s, all threads", what);
+  PrintLookup(item, lookups, found);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void PrintHashReport(FALCON *F, Threads *T){
+  uint32_t m, n;
+
+  fprintf(stderr, "==[ HASH TABLES ]===================\n");
+  for(n = 0, m = 0 ; m < F->nModels ; ++m, ++n){
+    PrintHashStats(stderr, F->M[m], m + 1);
+    PrintLookups(T, n, "Lookups");
+    if(F->M[m]->edits != 0)
+      PrintLookups(T, ++n, "Tolerant lookups");
+    }
+  fprintf(stderr, "\n");
+  }
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////
+// - - - - - - - - - - - - - M E M O R Y   P L A N - - - - - - - - - - - - - -
+//
+// WITH --max-mem THE MODELS ARE LOWERED (SEE FitMemory) BEFORE ANY OF THEM
+// IS CREATED, SO A LEVEL THAT DOES NOT FIT FAILS OR SHRINKS HERE AND NOT IN 
+// THE MIDDLE OF CreateCModel.
+
+static void FitModels(Threads *T, uint32_t topSize){
+  uint32_t n, k;
+  int      fit;
+
+  if(P->maxMem == 0)
+    return;
+
+  fit = FitMemory(T[0].model, P->nModels, &P->col, P->nThreads, topSize,
+  P->maxMem << 20);
+  if(fit < 0){
+    fprintf(stderr, "  [x] Error: the models need at least %.1lf MB, more "
+    "than --max-mem %"PRIu64"!\n", (double) PlanMemory(T[0].model, 
+    P->nModels, P->col, P->nThreads, topSize).total / 1048576.0, P->maxMem);
+    exit(1);
+    }
+  if(fit == 0)
+    return;
+
+  for(k = 1 ; k < P->nThreads ; ++k)
+    for(n = 0 ; n < P->nModels ; ++n)
+      T[k].model[n].ctx = T[0].model[n].ctx;
+  fprintf(stderr, "Warning: lowered the models to fit in %"PRIu64" MB "
+  "(collisions: %u, orders:", P->maxMem, P->col);
+  for(n = 0 ; n < P->nModels ; ++n)
+    fprintf(stderr, " %u", T[0].model[n].ctx);
+  fprintf(stderr, ").\n");
+  }
+
+
+//////////////////////////////////////////////////////////////////////////////
+// - - - - - - - - - - - S C A N   C H E C K P O I N T - - - - - - - - - - - -
+//
+// THE STATE OF THE THREADS IS SAVED IN output.ckp (SEE ckp.h). WITH --resume
+// EACH THREAD GETS ITS TOP, ITS PARTIALS AND ITS CURSOR BACK AND IT DOES NOT 
+// SCORE THE RECORDS UP TO THE CURSOR. THE DATABASE FILE OF THE CURSOR IS 
+// STILL PARSED FROM ITS START (IT MAY BE COMPRESSED), BUT THE WHOLE FILES 
+// BEFORE IT ARE NOT OPENED. THE RUN MUST USE THE SAME MODELS, FILES, TOP, 
+// THREADS, SHARD AND -k/-w AS THE ONE THAT WROTE THE CHECKPOINT.
+
+static uint64_t ScanCkpKey(Threads *T, uint32_t topSize){
+  uint64_t h, opt[9];
+  uint32_t n;
+
+  h = ModelParamsHash(MODEL_HASH_SEED ^ (uint64_t) (P->gamma * 65536), 
+  T[0].model, P->nModels, P->col);
+  opt[0] = topSize;
+  opt[1] = P->nThreads;
+  opt[2] = P->split;
+  opt[3] = P->warmup;
+  opt[4] = P->shard;
+  opt[5] = P->nShards;
+  opt[6] = P->local;
+  opt[7] = P->nFiles;
+  opt[8] = P->nDatabases;
+  h = Fnv64(h, opt, sizeof(opt));
+  for(n = 0 ; n < P->nFiles ; ++n)
+    h = Fnv64(h, P->files[n], strlen(P->files[n]) + 1);
+  for(n = 0 ; n < P->nDatabases ; ++n)
+    h = Fnv64(h, P->dbFiles[n], strlen(P->dbFiles[n]) + 1);
+  return h;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void StartScanCkp(METASCAN *MS, Threads *T, uint32_t topSize){
+  uint64_t cursor[P->nThreads];
+  TOP      *Tops[P->nThreads];
+  PARTIALS *Parts[P->nThreads];
+  char     *name;
+  uint32_t n;
+
+  if(P->ckp == 0 && !P->resume)
+    return;
+  name = concatenate(P->output, ".ckp");
+  MS->CK = OpenScanCkp(name, ScanCkpKey(T, topSize), P->nThreads, P->ckp);
+  Free(name);
+
+  if(P->resume){
+    for(n = 0 ; n < P->nThreads ; ++n){
+      cursor[n] = 0;
+      Tops[n]   = T[n].top;
+      Parts[n]  = T[n].parts;
+      }
+    if(LoadScanCkp(MS->CK, cursor, Tops, Parts)){
+      for(n = 0 ; n < P->nThreads ; ++n)
+        T[n].resume = cursor[n];
+      fprintf(stderr, "  [+] Resuming from %s.\n", MS->CK->name);
+      }
+    }
+
+  if(P->ckp == 0){ // ONLY READ
+    CloseScanCkp(MS->CK, 0);
+    MS->CK = NULL;
+    }
+  }
+
+
 //////////////////////////////////////////////////////////////////////////////
 // - - - - - - - - - - - C O M P R E S S O R   M A I N - - - - - - - - - - - -
 
-void CompressAction(Threads *T, char *refName, char *baseName){
-  pthread_t t[P->nThreads];
+// THE MODELS OF THE PARAMETERS (THE LIBRARY RETURNS NULL IF THEY DO NOT FIT)
+
+static CModel **NewModels(ModelPar *MP){
+  CModel **M = CreateModels(MP, P->nModels, P->col);
+  if(M == NULL){
+    fprintf(stderr, "  [x] Error: the models do not fit in memory!\n");
+    exit(1);
+    }
+  return M;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void CompressAction(METASCAN *MS, Threads *T, char *refName, char *baseName){
+  pthread_t t[P->nThreads+1];
+  SCANJOB  J[P->nThreads];
+  STATS    *ST = MS->ST;
   uint32_t n, dbIdx;
+  uint64_t mem, trained = 0;
   char     filteredFile[MAX_NAME]; // Enough space for filename
   int      useMagnetFilter = 0;
 
   if(P->loadModel) {
     // Load models from file instead of building them
     fprintf(stderr, "  [+] Loading models from file %s ... ", P->modelFile);
+    StartPhase(ST, "load", P->modelFile);
     int result = LoadModels(P->modelFile, &Models, &P->nModels, &P->col);
     if(result != 0) {
       fprintf(stderr, "Error loading models (code: %d)\n", result);
       exit(1);
     }
+    StopPhase(ST, 0);
     fprintf(stderr, "Done!\n");
   } else {
     // Build models from reference files as usual
@@ -971,14 +1341,17 @@ void CompressAction(Threads *T, char *refName, char *baseName){
     LoadReferenceWKM(refName);
     fprintf(stderr, "Done!\n");
 #else
-    Models = (CModel **) Malloc(P->nModels * sizeof(CModel *));
-    for(n = 0 ; n < P->nModels ; ++n)
-      Models[n] = CreateCModel(T[0].model[n].ctx, T[0].model[n].den,
-      T[0].model[n].ir, REFERENCE, P->col, T[0].model[n].edits,
-      T[0].model[n].eDen);
+    StartPhase(ST, "load", NULL);
+    mem    = TotalMemory();
+    Models = NewModels(T[0].model);
+    StopPhase(ST, 0);
+    if(P->verbose)
+      fprintf(stderr, "  [+] Models allocated ............. %.1lf MB\n",
+      (double) (TotalMemory() - mem) / 1048576.0);
     fprintf(stderr, "  [+] Loading %u metagenomic file(s):\n", P->nFiles);
 
     for(n = 0 ; n < P->nFiles ; ++n){
+      StartPhase(ST, "training", P->files[n]);
       if(P->useMagnet) {
         useMagnetFilter = 1;
 
@@ -1006,21 +1379,22 @@ void CompressAction(Threads *T, char *refName, char *baseName){
           fprintf(stderr, "      [+] Using original reference file %s instead.\n", P->files[n]);
           fprintf(stderr, "      [+] Loading original reference %s ... ", P->files[n]);
           // Load the original reference file
-          LoadReference(P->files[n]);
+          trained = LoadReference(P->files[n]);
           fprintf(stderr, "Done!\n");
         }
         else {
           fprintf(stderr, "      [+] Loading filtered reference %s ... ", filteredFile);
           // Load the filtered reference file
-          LoadReference(filteredFile);
+          trained = LoadReference(filteredFile);
           fprintf(stderr, "Done!\n");
         }
 
       } else {
         fprintf(stderr, "      [+] Loading %u ... ", n+1);
-        LoadReference(P->files[n]);
+        trained = LoadReference(P->files[n]);
         fprintf(stderr, "Done! \n");
       }
+      StopPhase(ST, trained);
     }
     fprintf(stderr, "  [+] Done! Learning phase complete!\n");
   }
@@ -1028,13 +1402,18 @@ void CompressAction(Threads *T, char *refName, char *baseName){
   // Save models if requested
   if(P->saveModel) {
     fprintf(stderr, "  [+] Saving models to file %s ... ", P->modelFile);
+    StartPhase(ST, "save", P->modelFile);
     int result = SaveModels(P->modelFile, Models, P->nModels, P->col);
     if(result != 0) {
       fprintf(stderr, "Error saving models (code: %d)\n", result);
       exit(1);
     }
+    StopPhase(ST, 0);
     fprintf(stderr, "Done!\n");
   }
+
+  // THE SCAN USES THE MODELS THROUGH THE CONTEXT (AS THE LIBRARY DOES)
+  MS->F = FalconBind(Models, P->nModels, P->col, P->gamma, P->nThreads, 0);
 #endif
 
   fprintf(stderr, "  [+] Compressing database ......... %u file(s):\n", P->nDatabases);
@@ -1043,12 +1422,42 @@ void CompressAction(Threads *T, char *refName, char *baseName){
     fprintf(stderr, "      [+] Loading %u ... ", dbIdx+1);
 
     // Set current database for threads
-    P->currentDBIdx = dbIdx;
+    MS->dbIdx = dbIdx;
+    MS->db    = P->dbFiles[dbIdx];
+
+    for(n = 0 ; n < P->nThreads && T[n].resume >= TopRec(dbIdx + 1, 0) - 1 ;
+    ++n)
+      ; // THE CHUNKS OF THIS DATABASE WERE MERGED BEFORE THE CHECKPOINT
+    if(n == P->nThreads){
+      fprintf(stderr, "Done (checkpoint)!\n");
+      continue;
+      }
 
-    for(n = 0 ; n < P->nThreads ; ++n)
-      pthread_create(&(t[n+1]), NULL, CompressThread, (void *) &(T[n]));
+    StartPhase(ST, "scan", P->dbFiles[dbIdx]);
+    ThreadedPhase(ST);
+    for(n = 0 ; n < P->nThreads ; ++n){
+      J[n].MS = MS;
+      J[n].T  = &T[n];
+      pthread_create(&(t[n+1]), NULL, CompressThread, (void *) &J[n]);
+      }
     for(n = 0 ; n < P->nThreads ; ++n) // DO NOT JOIN FORS!
       pthread_join(t[n+1], NULL);
+
+    if(P->split != 0){ // GATHER THE CHUNKS OF THE SPLIT RECORDS
+      PARTIALS *Parts[P->nThreads];
+      for(n = 0 ; n < P->nThreads ; ++n)
+        Parts[n] = T[n].parts;
+      #ifdef LOCAL_SIMILARITY
+      MergePartials(Parts, P->nThreads, T[0].top, P->local);
+      #else
+      MergePartials(Parts, P->nThreads, T[0].top, 0);
+      #endif
+      }
+    if(MS->CK != NULL) // THE SLOTS OF THE NEXT DATABASE START HERE
+      for(n = 0 ; n < P->nThreads ; ++n)
+        ScanCkpPut(MS->CK, n, T[n].resume > TopRec(dbIdx + 1, 0) - 1 ? 
+        T[n].resume : TopRec(dbIdx + 1, 0) - 1, T[n].top, T[n].parts);
+    StopPhase(ST, 0);
     fprintf(stderr, "Done!\n");
 
   }
@@ -1061,8 +1470,9 @@ void CompressAction(Threads *T, char *refName, char *baseName){
   }
 }
 
-void CompressActionTraining(Threads *T, char *refName){
+void CompressActionTraining(Threads *T, char *refName, STATS *ST){
   uint32_t n;
+  uint64_t trained = 0;
   char     filteredFile[MAX_NAME]; // Enough space for filename
   int      useMagnetFilter = 0;
 
@@ -1076,14 +1486,11 @@ void CompressActionTraining(Threads *T, char *refName){
     LoadReferenceWKM(refName);
     fprintf(stderr, "Done!\n");
 #else
-    Models = (CModel **) Malloc(P->nModels * sizeof(CModel *));
-    for(n = 0 ; n < P->nModels ; ++n)
-      Models[n] = CreateCModel(T[0].model[n].ctx, T[0].model[n].den,
-      T[0].model[n].ir, REFERENCE, P->col, T[0].model[n].edits,
-      T[0].model[n].eDen);
+    Models = NewModels(T[0].model);
     fprintf(stderr, "  [+] Loading %u metagenomic file(s):\n", P->nFiles);
 
     for(n = 0 ; n < P->nFiles ; ++n){
+      StartPhase(ST, "training", P->files[n]);
       if(P->useMagnet) {
         useMagnetFilter = 1;
 
@@ -1111,31 +1518,34 @@ void CompressActionTraining(Threads *T, char *refName){
           fprintf(stderr, "      [+] Using original reference file %s instead.\n", P->files[n]);
           fprintf(stderr, "      [+] Loading original reference %s ... ", P->files[n]);
           // Load the original reference file
-          LoadReference(P->files[n]);
+          trained = LoadReference(P->files[n]);
           fprintf(stderr, "Done!\n");
         }
         else {
           fprintf(stderr, "      [+] Loading filtered reference %s ... ", filteredFile);
           // Load the filtered reference file
-          LoadReference(filteredFile);
+          trained = LoadReference(filteredFile);
           fprintf(stderr, "Done!\n");
         }
 
       } else {
         fprintf(stderr, "      [+] Loading %u ... ", n+1);
-        LoadReference(P->files[n]);
+        trained = LoadReference(P->files[n]);
         fprintf(stderr, "Done! \n");
       }
+      StopPhase(ST, trained);
     }
     fprintf(stderr, "  [+] Done! Learning phase complete!\n");
 
     // Save models
     fprintf(stderr, "  [+] Saving models to file %s ... ", P->modelFile);
+    StartPhase(ST, "save", P->modelFile);
     int result = SaveModels(P->modelFile, Models, P->nModels, P->col);
     if(result != 0) {
       fprintf(stderr, "Error saving models (code: %d)\n", result);
       exit(1);
     }
+    StopPhase(ST, 0);
     fprintf(stderr, "Done!\n");
 
 #endif
@@ -1148,43 +1558,300 @@ void CompressActionTraining(Threads *T, char *refName){
   }
 }
 
-void CompressActionInter(Threads *T, uint32_t ref){
-  uint32_t n, k;
-  pthread_t t[P->nThreads];
-  P->ref = ref;
 
-  Models = (CModel **) Malloc(P->nModels * sizeof(CModel *));
+//////////////////////////////////////////////////////////////////////////////
+// - - - - - - - - - - - I N T E R   T A S K   G R A P H - - - - - - - - - - -
+// EACH (REFERENCE, TARGET) PAIR IS A JOB. A REFERENCE IS LOADED IN A FREE 
+// SLOT (ONE, OR AS MANY AS FIT IN THE -ram BUDGET) AND ITS TARGETS ARE 
+// CLAIMED BY ANY IDLE THREAD, OLDEST REFERENCE FIRST. THE SLOT IS FREED WHEN 
+// ITS LAST TARGET ENDS. AN IDLE THREAD LOADS THE NEXT REFERENCE IF A SLOT IS 
+// FREE, SO THE LOADS OVERLAP THE TARGETS OF THE OTHER SLOTS.
+
+typedef struct{
+  CModel   **M;
+  uint32_t ref;
+  uint32_t next;        // Next target to claim
+  uint32_t done;        // Targets compressed
+  uint8_t  busy;        // The slot holds (or is loading) a reference
+  uint8_t  ready;       // The reference is loaded
+  }
+ISLOT;
+
+typedef struct{
+  Threads         *T;
+  ISLOT           *S;
+  uint32_t        nSlots;
+  uint32_t        nextRef;
+  uint32_t        refsDone;
+  uint8_t         *have;        // Cells already computed (checkpoint)
+  MCKP            *CK;
+  pthread_mutex_t lock;
+  pthread_cond_t  change;
+  }
+INTERJOBS;
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// BYTES OF THE MODELS OF ONE REFERENCE
+
+static uint64_t InterRefBytes(Threads *T){
+  uint64_t bytes = 0;
+  uint32_t n;
   for(n = 0 ; n < P->nModels ; ++n)
-    Models[n] = CreateCModel(T[ref].model[n].ctx, T[ref].model[n].den,
-    T[ref].model[n].ir, REFERENCE, P->col, T[ref].model[n].edits,
-    T[ref].model[n].eDen);
+    bytes += CModelTotalBytes(T[0].model[n].ctx, P->col, 
+    T[0].model[n].edits);
+  return bytes;
+  }
 
-  fprintf(stderr, "  [+] Loading reference %u ... ", ref+1);
-  LoadReferenceInter(T[ref]);
-  fprintf(stderr, "Done!\n");
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  fprintf(stderr, "      [+] Compressing %u targets ... ", P->nFiles);
-  ref = 0;
-  do{
-    for(n = 0 ; n < P->nThreads ; ++n)
-      pthread_create(&(t[n+1]), NULL, CompressThreadInter, (void *) &(T[ref+n]));
-    for(n = 0 ; n < P->nThreads ; ++n) // DO NOT JOIN FORS!
-      pthread_join(t[n+1], NULL);
+// WITH -cache THE MODELS OF A FILE ARE TRAINED ONCE: THEY ARE READ FROM THE
+// CACHE WHEN THE FILE CONTENT AND THE MODEL PARAMETERS WERE SEEN BEFORE, OR 
+// TRAINED AND SAVED (TEMPORARY NAME + rename, SO A KEY IS NEVER PARTIAL).
+
+static void LoadInterSlot(INTERJOBS *IJ, ISLOT *X){
+  ModelPar *MP = IJ->T[X->ref].model;
+  char     *name = NULL, *tmp;
+  uint32_t nModels, col;
+
+  if(P->cache != NULL){
+    name = ModelCacheName(P->cache, P->files[X->ref], MP, P->nModels, P->col);
+    if(access(name, R_OK) == 0){
+      if(LoadModels(name, &X->M, &nModels, &col) == 0){
+        if(ModelsMatch(X->M, nModels, col, MP, P->nModels, P->col)){
+          Free(name);
+          return;
+          }
+        FreeLoadedModels(X->M, nModels);
+        }
+      fprintf(stderr, "Warning: rebuilding the cached models %s\n", name);
+      }
+    }
+
+  X->M = NewModels(MP);
+  LoadReferenceInter(X->M, X->ref);
+
+  if(name != NULL){
+    tmp = (char *) Malloc(strlen(name) + 32);
+    sprintf(tmp, "%s.%d.%u.tmp", name, (int) getpid(), X->ref);
+    if(SaveModels(tmp, X->M, P->nModels, P->col) != 0 || rename(tmp, name)
+    != 0){
+      fprintf(stderr, "Warning: cannot write the cached models %s\n", name);
+      remove(tmp);
+      }
+    Free(tmp);
+    Free(name);
+    }
   }
-  while((ref += P->nThreads) < P->nFiles && ref + P->nThreads <= P->nFiles);
 
-  if(ref < P->nFiles){ // EXTRA - OUT OF THE MAIN LOOP
-    for(n = ref, k = 0 ; n < P->nFiles ; ++n)
-      pthread_create(&(t[++k]), NULL, CompressThreadInter, (void *) &(T[n]));
-    for(n = ref, k = 0 ; n < P->nFiles ; ++n) // DO NOT JOIN FORS!
-      pthread_join(t[++k], NULL);
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// MOVES next OVER THE CELLS THAT ARE ALREADY IN THE CHECKPOINT
+
+static void SkipInterDone(INTERJOBS *IJ, ISLOT *X){
+  uint8_t *row = IJ->have + (uint64_t) X->ref * P->nFiles;
+  while(X->next < P->nFiles && row[X->next]){
+    ++X->next;
+    ++X->done;
+    }
   }
-  fprintf(stderr, "Done!\n");
 
-  for(n = 0 ; n < P->nModels ; ++n)
-    FreeCModel(Models[n]);
-  Free(Models);
-}
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void *InterThread(void *Ij){
+  INTERJOBS *IJ = (INTERJOBS *) Ij;
+  ISLOT     *X;
+  uint32_t  n, tar;
+
+  pthread_mutex_lock(&IJ->lock);
+  while(IJ->refsDone < P->nFiles){
+    while(IJ->nextRef < P->nFiles && memchr(IJ->have + (uint64_t) IJ->nextRef
+    * P->nFiles, 0, P->nFiles) == NULL){ // ROW RESUMED FROM THE CHECKPOINT
+      ++IJ->nextRef;
+      ++IJ->refsDone;
+      pthread_cond_broadcast(&IJ->change);
+      }
+    if(IJ->refsDone == P->nFiles)
+      break;
+
+    X = NULL;
+    if(IJ->nextRef < P->nFiles)
+      for(n = 0 ; n < IJ->nSlots ; ++n)
+        if(IJ->S[n].busy == 0){
+          X = &IJ->S[n];
+          break;
+          }
+
+    if(X != NULL){ // LOAD THE NEXT REFERENCE
+      X->busy  = 1;
+      X->ready = 0;
+      X->ref   = IJ->nextRef++;
+      X->next  = 0;
+      X->done  = 0;
+      SkipInterDone(IJ, X);
+      pthread_mutex_unlock(&IJ->lock);
+      LoadInterSlot(IJ, X);
+      pthread_mutex_lock(&IJ->lock);
+      X->ready = 1;
+      pthread_cond_broadcast(&IJ->change);
+      continue;
+      }
+
+    for(n = 0 ; n < IJ->nSlots ; ++n)
+      if(IJ->S[n].ready && IJ->S[n].next < P->nFiles && (X == NULL || 
+      IJ->S[n].ref < X->ref))
+        X = &IJ->S[n];
+
+    if(X == NULL){ // EVERYTHING IS LOADING OR RUNNING
+      pthread_cond_wait(&IJ->change, &IJ->lock);
+      continue;
+      }
+
+    tar = X->next++;
+    SkipInterDone(IJ, X);
+    pthread_mutex_unlock(&IJ->lock);
+    P->matrix[X->ref][tar] = CompressTargetInter(X->M, tar);
+    pthread_mutex_lock(&IJ->lock);
+    IJ->have[(uint64_t) X->ref * P->nFiles + tar] = 1;
+    MatrixCkpPut(IJ->CK, X->ref, tar, P->matrix[X->ref][tar]);
+
+    if(++X->done == P->nFiles){ // LAST TARGET: FREE THE SLOT
+      X->ready = 0;
+      pthread_mutex_unlock(&IJ->lock);
+      for(n = 0 ; n < P->nModels ; ++n)
+        FreeCModel(X->M[n]);
+      Free(X->M);
+      pthread_mutex_lock(&IJ->lock);
+      X->busy = 0;
+      fprintf(stderr, "  [+] Reference %-5u done (%u of %u)\n", X->ref + 1, 
+      ++IJ->refsDone, P->nFiles);
+      pthread_cond_broadcast(&IJ->change);
+      }
+    }
+  pthread_mutex_unlock(&IJ->lock);
+  return NULL;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void CompressActionInter(Threads *T, uint8_t *have, MCKP *CK){
+  INTERJOBS IJ;
+  pthread_t t[P->nThreads];
+  uint64_t  bytes = InterRefBytes(T);
+  uint32_t  n;
+
+  IJ.T        = T;
+  IJ.have     = have;
+  IJ.CK       = CK;
+  IJ.nextRef  = 0;
+  IJ.refsDone = 0;
+  IJ.nSlots   = 1;      // EACH EXTRA SLOT COSTS bytes: ONLY WITH -ram
+  if(P->ram != 0)
+    IJ.nSlots = ((P->ram << 20) / bytes) < P->nThreads ? 
+    (P->ram << 20) / bytes : P->nThreads;
+  if(IJ.nSlots > P->nFiles) IJ.nSlots = P->nFiles;
+  if(IJ.nSlots == 0){
+    fprintf(stderr, "Warning: -ram is lower than one reference (%"PRIu64
+    " MB), using one.\n", (bytes >> 20) + 1);
+    IJ.nSlots = 1;
+    }
+  IJ.S = (ISLOT *) Calloc(IJ.nSlots, sizeof(ISLOT));
+  pthread_mutex_init(&IJ.lock, NULL);
+  pthread_cond_init(&IJ.change, NULL);
+
+  fprintf(stderr, "  [+] Comparing %u x %u files with %u reference models in "
+  "memory (%"PRIu64" MB each) ...\n", P->nFiles, P->nFiles, IJ.nSlots, 
+  (bytes >> 20) + 1);
+  for(n = 0 ; n < P->nThreads ; ++n)
+    pthread_create(&(t[n]), NULL, InterThread, (void *) &IJ);
+  for(n = 0 ; n < P->nThreads ; ++n)
+    pthread_join(t[n], NULL);
+
+  pthread_mutex_destroy(&IJ.lock);
+  pthread_cond_destroy(&IJ.change);
+  Free(IJ.S);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// SKETCH PRE-SCREENING (-j): THE PAIRS WHOSE SKETCH JACCARD ESTIMATE IS BELOW
+// THE CUTOFF ARE NOT COMPRESSED. THEY GET SKETCH_FAR_NDR AND ARE MARKED IN 
+// have, SO THE TASK GRAPH SKIPS THEM, BUT THEY ARE NOT CHECKPOINTED. THE 
+// SKETCHES (ONE JOB PER FILE) AND THE ROWS (ONE JOB PER FILE) ARE CLAIMED BY 
+// THE -n THREADS.
+
+typedef struct{
+  ORDER     *O;
+  SKETCH    **S;
+  SKETCHIDX *I;               // NULL while the sketches are built
+  uint8_t   *have;
+  uint32_t  *skipped;         // Cells estimated in each row
+  }
+SKETCHJOBS;
+
+static void *SketchThread(void *Sj){
+  SKETCHJOBS *SJ = (SKETCHJOBS *) Sj;
+  uint32_t   *shared = NULL, n;
+  uint64_t   min = SketchMinHashes(P->sketch);
+  double     *J = NULL;
+  uint8_t    *row;
+  int64_t    job;
+
+  if(SJ->I != NULL){
+    shared = (uint32_t *) Malloc(P->nFiles * sizeof(uint32_t));
+    J      = (double   *) Malloc(P->nFiles * sizeof(double));
+    }
+
+  while((job = OrderClaim(SJ->O)) != -1){
+    if(SJ->I == NULL){
+      SJ->S[job] = CreateSketch(P->files[job]);
+      continue;
+      }
+    SketchRow(SJ->I, job, shared, J);
+    row = SJ->have + (uint64_t) job * P->nFiles;
+    for(n = 0 ; n < P->nFiles ; ++n)
+      if(row[n] == 0 && J[n] < P->sketch && SJ->S[job]->n >= min &&
+      SJ->S[n]->n >= min){
+        row[n] = 1;
+        P->matrix[job][n] = SKETCH_FAR_NDR;
+        ++SJ->skipped[job];
+        }
+    }
+
+  if(shared != NULL){
+    Free(shared);
+    Free(J);
+    }
+  return NULL;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+uint64_t SketchScreen(uint8_t *have){
+  SKETCHJOBS SJ = { NULL, NULL, NULL, have, NULL };
+  pthread_t  t[P->nThreads];
+  uint64_t   skipped = 0;
+  uint32_t   n, phase;
+
+  SJ.S       = (SKETCH  **) Calloc(P->nFiles, sizeof(SKETCH *));
+  SJ.skipped = (uint32_t *) Calloc(P->nFiles, sizeof(uint32_t));
+  for(phase = 0 ; phase < 2 ; ++phase){
+    if(phase == 1)
+      SJ.I = CreateSketchIdx(SJ.S, P->nFiles);
+    SJ.O = CreateOrder(P->nFiles);
+    for(n = 0 ; n < P->nThreads ; ++n)
+      pthread_create(&(t[n]), NULL, SketchThread, (void *) &SJ);
+    for(n = 0 ; n < P->nThreads ; ++n)
+      pthread_join(t[n], NULL);
+    RemoveOrder(SJ.O);
+    }
+
+  for(n = 0 ; n < P->nFiles ; ++n){
+    skipped += SJ.skipped[n];
+    RemoveSketch(SJ.S[n]);
+    }
+  RemoveSketchIdx(SJ.I);
+  Free(SJ.skipped);
+  Free(SJ.S);
+  return skipped;
+  }
 
 //////////////////////////////////////////////////////////////////////////////
 // - - - - - - - - - - - - - - R E A D   L A B E L S - - - - - - - - - - - - -
@@ -1249,9 +1916,47 @@ void ReadMatrix(char *fn){
 //////////////////////////////////////////////////////////////////////////////
 // - - - - - - - - - - - - - - - - - P A I N T - - - - - - - - - - - - - - - -
 
+// THE PIXEL HEATMAP HAS THE SAME LAYOUT AS THE SVG, WITHOUT THE TEXT. ONLY
+// THE CELLS IN THE VIEW ARE COLOURED, SO EACH TILE COSTS ITS OWN CELLS.
+
+typedef struct{
+  Painter  *Paint;
+  COLORS   *CLR;
+  }
+MPAINT;
+
+static void MatrixRaster(RASTER *R, void *Mp){
+  MPAINT   *MP = (MPAINT *) Mp;
+  Painter  *Pa = MP->Paint;
+  double   step = Pa->width + Pa->space, lo, hi;
+  uint32_t ref, tar, iTar, eTar, size = step * P->nFiles - Pa->space;
+
+  for(ref = 0 ; ref < size ; ++ref)
+    RasterRect(R, Pa->width, 1, DEFAULT_CX - (Pa->width*2), Pa->cy + ref,
+    HeatMapRgb(((double) ref / size), MP->CLR));
+
+  // COLUMNS OF CELLS THAT MAY TOUCH THE VIEW
+  lo   = (R->x0 - DEFAULT_CX) / step - 1;
+  hi   = (R->x0 + R->width - DEFAULT_CX) / step + 2;
+  iTar = lo > 0 ? lo : 0;
+  eTar = hi < 0 ? 0 : (hi > P->nFiles ? P->nFiles : hi);
+
+  for(ref = 0 ; ref < P->nFiles ; ++ref){
+    if(Pa->cy + ref * step > R->y0 + R->height || Pa->cy + ref * step + 
+    Pa->width < R->y0)
+      continue;
+    for(tar = iTar ; tar < eTar ; ++tar)
+      RasterRect(R, Pa->width, Pa->width, DEFAULT_CX + tar * step, Pa->cy + 
+      ref * step, HeatMapRgb(BoundDouble(0.0, P->matrix[ref][tar], 1.0),
+      MP->CLR));
+    }
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
 void PaintMatrix(double start, double rotations, double hue, double gamma,
-double width, double space){
-  FILE *Plot = Fopen(P->image, "w");
+double width, double space, uint64_t tile){
+  FILE *Plot;
   Painter *Paint;
   COLORS  *CLR = (COLORS *) Calloc(1, sizeof(COLORS));
   uint32_t ref, tar;
@@ -1263,6 +1968,18 @@ double width, double space){
 
   Paint = CreateBasicPainter(DEFAULT_CX*2+((width+space)*P->nFiles)+5, width, space);
 
+  if(RasterType((char *) P->image) != RASTER_NONE){
+    MPAINT MP = { Paint, CLR };
+    PaintRaster((char *) P->image, (2 * DEFAULT_CX) + (((Paint->width + 
+    Paint->space) * P->nFiles) - Paint->space), Paint->size + EXTRA, tile,
+    MatrixRaster, &MP);
+    RemovePainter(Paint);
+    Free(CLR);
+    return;
+    }
+
+  Plot = Fopen((char *) P->image, "w");
+
   PrintHead(Plot, (2 * DEFAULT_CX) + (((Paint->width + Paint->space) *
   P->nFiles) - Paint->space), Paint->size + EXTRA);
 
@@ -1307,42 +2024,401 @@ double width, double space){
 
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-int32_t P_Falcon(char **argv, int argc){
-  char     **p = *&argv, **xargv, *xpl = NULL;
-  int32_t  xargc = 0;
-  uint32_t n, k, col, ref, topSize;
-  double   gamma;
+//////////////////////////////////////////////////////////////////////////////
+// - - - - - - - - - - - - - - - - - B A T C H - - - - - - - - - - - - - - - -
+// BATCH MODE (-B): A MANIFEST LISTS K SAMPLES, ONE PER LINE, AS "SAMPLE 
+// [OUTPUT]" ('#' STARTS A COMMENT). A SAMPLE IS A ":" LIST OF READ FILES, 
+// TRAINED WITH THE MODELS OF THE COMMAND LINE, OR A .fcm FILE SAVED WITH THE
+// SAME MODELS. THE SAMPLES ARE TRAINED BY THE -n THREADS. THEN THE DATABASE 
+// IS READ AND PARSED ONCE: EACH RECORD IS SCORED AGAINST THE K MIXTURES, 
+// SHARING THE CONTEXT INDEXES (MixSymbolBatch), AND EACH SAMPLE KEEPS ITS 
+// OWN TOP AND OUTPUT FILE.
+
+typedef struct{
+  uint32_t K;
+  char     **sample;          // Read files (":" list) or a .fcm file
+  char     **output;          // Top file of each sample
+  CModel   ***M;              // Models of each sample
+  TOP      ***top;            // top[k][thread]
+  ORDER    *O;                // Training jobs
   Threads  *T;
-
-  P = (Parameters *) Malloc(1 * sizeof(Parameters));
-  if((P->help = ArgsState(DEFAULT_HELP, p, argc, "-h", "--help")) == 1 || argc < 2){
-    PrintMenuFalcon();
-    Free(P);
-    return EXIT_SUCCESS;
+  STATS    *ST;               // Phase statistics
   }
+BATCH;
 
-  if(ArgsState(DEF_VERSION, p, argc, "-V", "--version")){
-    PrintVersion();
-    Free(P);
-    return EXIT_SUCCESS;
+typedef struct{
+  BATCH    *B;
+  uint32_t id;
+  char     *dbFile;
+  uint32_t dbIdx;
   }
+BATCHJOB;
 
-  if(ArgsState(0, p, argc, "-s", "--show")){
-    PrintLevels();
-    Free(P);
-    return EXIT_SUCCESS;
-  }
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  P->verbose  = ArgsState  (DEFAULT_VERBOSE, p, argc, "-v", "--verbose");
-  P->force    = ArgsState  (DEFAULT_FORCE,   p, argc, "-F", "--force");
-  #ifdef LOCAL_SIMILARITY
-  P->local    = ArgsState  (DEFAULT_LOCAL,   p, argc, "-Z", "--local");
-  #endif
+static void LoadManifest(BATCH *B, char *fName){
+  FILE     *IN = Fopen(fName, "r");
+  char     *line = NULL, *sample, *output, *end;
+  size_t   lineSize = 0;
+  uint32_t max = 0;
+
+  while(getline(&line, &lineSize, IN) != -1){
+    if((sample = strtok(line, " \t\r\n")) == NULL || sample[0] == '#')
+      continue;
+    if(B->K == max){
+      B->sample = (char **) Realloc(B->sample, (max + 64) * sizeof(char *),
+      64 * sizeof(char *));
+      B->output = (char **) Realloc(B->output, (max + 64) * sizeof(char *),
+      64 * sizeof(char *));
+      max += 64;
+      }
+    B->sample[B->K] = CloneString(sample);
+    if((output = strtok(NULL, " \t\r\n")) != NULL && output[0] != '#')
+      B->output[B->K] = CloneString(output);
+    else{ // DEFAULT: <FIRST FILE OF THE SAMPLE>.top.csv
+      if((end = strchr(sample, ':')) != NULL)
+        *end = '\0';
+      B->output[B->K] = concatenate(sample, ".top.csv");
+      }
+    ++B->K;
+    }
+
+  free(line);
+  fclose(IN);
+  if(B->K == 0){
+    fprintf(stderr, "  [x] Error: the manifest %s has no samples!\n", fName);
+    exit(1);
+    }
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void *BatchTrainThread(void *Bj){
+  BATCH    *B = ((BATCHJOB *) Bj)->B;
+  ModelPar *MP = B->T[0].model;
+  char     *list, *file, *save;
+  uint32_t nModels, col;
+  uint64_t bases = 0;
+  double   start = WallClock();
+  int64_t  k;
+
+  while((k = OrderClaim(B->O)) != -1){
+    if(ends_with(B->sample[k], ".fcm")){
+      if(LoadModels(B->sample[k], &B->M[k], &nModels, &col) != 0)
+        exit(1);
+      if(!ModelsMatch(B->M[k], nModels, col, MP, P->nModels, P->col)){
+        fprintf(stderr, "  [x] Error: the models of %s differ from the ones "
+        "of the command line!\n", B->sample[k]);
+        exit(1);
+        }
+      }
+    else{
+      B->M[k] = NewModels(MP);
+      list = CloneString(B->sample[k]);
+      for(file = strtok_r(list, ":", &save) ; file != NULL ; file = 
+      strtok_r(NULL, ":", &save))
+        bases += LoadReferenceModels(B->M[k], file);
+      Free(list);
+      }
+    fprintf(stderr, "      [+] Sample %-5"PRIi64" ready: %s\n", k + 1, 
+    B->sample[k]);
+    }
+  ThreadPhase(B->ST, ((BATCHJOB *) Bj)->id, WallClock() - start, bases);
+  return NULL;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void BatchTop(BATCH *B, uint32_t id, double *bits, uint8_t *name,
+uint64_t nBase, uint32_t dbIdx, uint64_t rec){
+  uint32_t k;
+  for(k = 0 ; k < B->K ; ++k){
+    B->top[k][id]->rec = TopRec(dbIdx, rec);
+    #ifdef LOCAL_SIMILARITY
+    UpdateTopWithDB(BPBB(bits[k], nBase), name, B->top[k][id], nBase, dbIdx);
+    #else
+    UpdateTop(BPBB(bits[k], nBase), name, B->top[k][id], nBase);
+    #endif
+    }
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// THE RECORD SPLIT OF FalconParse, AS CompressTarget (WITHOUT CHUNKS OR
+// PROFILES)
+
+static void *BatchScanThread(void *Bj){
+  BATCHJOB *J = (BATCHJOB *) Bj;
+  BATCH    *B = J->B;
+  FILE     *Reader = CFopen(J->dbFile, "r");
+  PARSER   *PA = CreateParser();
+  SCRATCH  **S = (SCRATCH **) Malloc(B->K * sizeof(SCRATCH *));
+  double   *bits = (double *) Calloc(B->K, sizeof(double));
+  double   *instant = (double *) Calloc(B->K, sizeof(double));
+  uint8_t  *readBuf = (uint8_t *) Calloc(BUFFER_SIZE, sizeof(uint8_t));
+  uint8_t  sym, conName[MAX_NAME];
+  uint64_t nBase = 0, mixed = 0;
+  uint32_t k, n, idxPos, r = 0;
+  double   start = WallClock();
+  int      action;
+
+  for(k = 0 ; k < B->K ; ++k)
+    S[k] = CreateScratch(B->M[k], P->nModels);
+
+  conName[0] = '\0';
+  while((n = fread(readBuf, 1, BUFFER_SIZE, Reader)))
+    for(idxPos = 0 ; idxPos < n ; ++idxPos){
+      if((action = FalconParse(PA, readBuf[idxPos], conName, &r)) < 0){
+        if(action == -1){ // A NEW RECORD: THE LAST ONE IS DONE
+          if((PA->nRead-1) % P->nThreads == J->id && PA->nRead>1 && nBase>1)
+            BatchTop(B, J->id, bits, conName, nBase, J->dbIdx, PA->nRead-1);
+          for(k = 0 ; k < B->K ; ++k){
+            ResetScratch(S[k]);
+            bits[k] = 0;
+            }
+          nBase = 0;
+          }
+        continue; // GO TO NEXT SYMBOL
+        }
+
+      if(PA->nRead % P->nThreads != J->id)
+        continue;
+      if((sym = DNASymToNum(action)) == 4)
+        continue; // IT IGNORES EXTRA SYMBOLS
+      MixSymbolBatch(S, B->M, B->K, sym, P->gamma, instant);
+      for(k = 0 ; k < B->K ; ++k)
+        bits[k] += instant[k];
+      ++nBase;
+      ++mixed;
+      }
+
+  if(PA->nRead % P->nThreads == J->id)
+    BatchTop(B, J->id, bits, conName, nBase, J->dbIdx, PA->nRead);
+
+  for(k = 0 ; k < B->K ; ++k)
+    RemoveScratch(S[k]);
+  Free(S);
+  Free(bits);
+  Free(instant);
+  Free(readBuf);
+  RemoveParser(PA);
+  fclose(Reader);
+  ThreadPhase(B->ST, J->id, WallClock() - start, mixed); // BUSY TIME
+  return NULL;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+int32_t FalconBatch(char **argv, int argc, char **xargv, int32_t xargc,
+uint32_t topSize){
+  BATCH    B;
+  BATCHJOB J[P->nThreads];
+  pthread_t t[P->nThreads];
+  STRTAB   *Names = CreateStrTab();
+  uint32_t n, k, x, dbIdx;
+  FILE     *OUTPUT;
+  TOP      *Top;
+
+  #ifdef LOCAL_SIMILARITY
+  if(P->local == 1){
+    fprintf(stderr, "  [x] Error: -Z is not available in batch mode!\n");
+    return EXIT_FAILURE;
+    }
+  #endif
+  if(P->split != 0 || P->sample > 1 || P->useMagnet || P->saveModel || 
+  P->loadModel || P->trainModel){
+    fprintf(stderr, "  [x] Error: -k, -p, -mg, -S, -L and -T are not available"
+    " in batch mode!\n");
+    return EXIT_FAILURE;
+    }
+  if(P->nModels == 0){
+    fprintf(stderr, "Error: at least you need to use a context model!\n");
+    return EXIT_FAILURE;
+    }
+
+  memset(&B, 0, sizeof(BATCH));
+  LoadManifest(&B, P->batch);
+  for(k = 0 ; k < B.K ; ++k)
+    if(!P->force)
+      FAccessWPerm(B.output[k]);
+
+  // READ MODEL PARAMETERS FROM XARGS & ARGS
+  B.T = (Threads *) Calloc(1, sizeof(Threads));
+  B.T[0].model = (ModelPar *) Calloc(P->nModels, sizeof(ModelPar));
+  x = 0;
+  for(n = 1 ; n < (uint32_t) argc ; ++n)
+    if(strcmp(argv[n], "-m") == 0)
+      B.T[0].model[x++] = ArgsUniqModel(argv[n+1], 0);
+  for(n = 1 ; n < (uint32_t) xargc ; ++n)
+    if(strcmp(xargv[n], "-m") == 0)
+      B.T[0].model[x++] = ArgsUniqModel(xargv[n+1], 0);
+
+  B.M   = (CModel ***) Calloc(B.K, sizeof(CModel **));
+  B.top = (TOP    ***) Calloc(B.K, sizeof(TOP **));
+  for(k = 0 ; k < B.K ; ++k){
+    B.top[k] = (TOP **) Calloc(P->nThreads, sizeof(TOP *));
+    for(n = 0 ; n < P->nThreads ; ++n)
+      B.top[k][n] = CreateTop(topSize, Names);
+    }
+
+  P->nDatabases = ReadDBFNames(P, argv[argc-1], 0);
+  fprintf(stderr, "\n==[ PROCESSING ]====================\n");
+  TIME *Time = CreateClock(clock());
+  B.ST = CreateStats(P->nThreads);
+
+  fprintf(stderr, "  [+] Training %u samples:\n", B.K);
+  StartPhase(B.ST, "training", P->batch);
+  ThreadedPhase(B.ST);
+  B.O = CreateOrder(B.K);
+  for(n = 0 ; n < P->nThreads ; ++n){
+    J[n].B  = &B;
+    J[n].id = n;
+    pthread_create(&(t[n]), NULL, BatchTrainThread, (void *) &J[n]);
+    }
+  for(n = 0 ; n < P->nThreads ; ++n)
+    pthread_join(t[n], NULL);
+  RemoveOrder(B.O);
+  StopPhase(B.ST, 0);
+
+  fprintf(stderr, "  [+] Compressing database ......... %u file(s):\n", 
+  P->nDatabases);
+  for(dbIdx = 0 ; dbIdx < P->nDatabases ; ++dbIdx){
+    fprintf(stderr, "      [+] Loading %u ... ", dbIdx+1);
+    StartPhase(B.ST, "scan", P->dbFiles[dbIdx]);
+    ThreadedPhase(B.ST);
+    for(n = 0 ; n < P->nThreads ; ++n){
+      J[n].dbFile = P->dbFiles[dbIdx];
+      J[n].dbIdx  = dbIdx;
+      pthread_create(&(t[n]), NULL, BatchScanThread, (void *) &J[n]);
+      }
+    for(n = 0 ; n < P->nThreads ; ++n)
+      pthread_join(t[n], NULL);
+    StopPhase(B.ST, 0);
+    fprintf(stderr, "Done!\n");
+    }
+
+  fprintf(stderr, "  [+] Printing %u top files ........ ", B.K);
+  StartPhase(B.ST, "output", NULL);
+  for(k = 0 ; k < B.K ; ++k){
+    Top = CreateTop(topSize * P->nThreads, Names);
+    for(x = 0, n = 0 ; n < P->nThreads ; ++n){
+      uint32_t e;
+      for(e = 0 ; e < B.top[k][n]->size-1 ; ++e)
+        Top->V[x++] = B.top[k][n]->V[e]; // THE NAMES ARE SHARED BY ID
+      }
+    qsort(Top->V, x, sizeof(VT), SortByValue);
+    OUTPUT = Fopen(B.output[k], "w");
+    #ifdef LOCAL_SIMILARITY
+    PrintTop(OUTPUT, Top, topSize, P->dbFiles);
+    #else
+    PrintTop(OUTPUT, Top, topSize);
+    #endif
+    fclose(OUTPUT);
+    DeleteTop(Top);
+    }
+  StopPhase(B.ST, 0);
+  fprintf(stderr, "Done!\n");
+
+  StopTimeNDRM(Time, clock());
+  fprintf(stderr, "\n");
+  fprintf(stderr, "==[ STATISTICS ]====================\n");
+  StopCalcAll(Time, clock());
+  PrintStats(stderr, B.ST, P->verbose);
+  if(P->statsJson != NULL && WriteStatsJson(P->statsJson, B.ST) != 0)
+    fprintf(stderr, "Warning: unable to write %s\n", P->statsJson);
+  RemoveStats(B.ST);
+  fprintf(stderr, "\n");
+  RemoveClock(Time);
+
+  for(k = 0 ; k < B.K ; ++k){
+    for(n = 0 ; n < P->nModels ; ++n)
+      FreeCModel(B.M[k][n]);
+    Free(B.M[k]);
+    for(n = 0 ; n < P->nThreads ; ++n)
+      DeleteTop(B.top[k][n]);
+    Free(B.top[k]);
+    Free(B.sample[k]);
+    Free(B.output[k]);
+    }
+  Free(B.M);
+  Free(B.top);
+  Free(B.sample);
+  Free(B.output);
+  Free(B.T[0].model);
+  Free(B.T);
+  DeleteStrTab(Names);
+  return EXIT_SUCCESS;
+  }
+
+int32_t P_Falcon(char **argv, int argc){
+  char     **p = *&argv, **xargv = NULL, *xpl = NULL;
+  int32_t  xargc = 0;
+  uint32_t n, k, col, ref, topSize;
+  double   gamma;
+  Threads  *T;
+  STRTAB   *Names = NULL;
+  STATS    *ST = NULL;
+  METASCAN MS;
+  char     *shard, shardOut[32], c;
+
+  P = (Parameters *) Malloc(1 * sizeof(Parameters));
+  if((P->help = ArgsState(DEFAULT_HELP, p, argc, "-h", "--help")) == 1 || argc < 2){
+    PrintMenuFalcon();
+    Free(P);
+    return EXIT_SUCCESS;
+  }
+
+  if(ArgsState(DEF_VERSION, p, argc, "-V", "--version")){
+    PrintVersion();
+    Free(P);
+    return EXIT_SUCCESS;
+  }
+
+  if(ArgsState(0, p, argc, "-s", "--show")){
+    PrintLevels();
+    Free(P);
+    return EXIT_SUCCESS;
+  }
+
+  P->verbose  = ArgsState  (DEFAULT_VERBOSE, p, argc, "-v", "--verbose");
+  P->force    = ArgsState  (DEFAULT_FORCE,   p, argc, "-F", "--force");
+  #ifdef LOCAL_SIMILARITY
+  P->local    = ArgsState  (DEFAULT_LOCAL,   p, argc, "-Z", "--local");
+  #endif
   P->sample   = ArgsNum    (DEFAULT_SAMPLE,  p, argc, "-p", MIN_SAP, MAX_SAP);
   P->level    = ArgsNum    (0,               p, argc, "-l", MIN_LEV, MAX_LEV);
   topSize     = ArgsNum    (DEF_TOP,         p, argc, "-t", MIN_TOP, MAX_TOP);
   P->nThreads = ArgsNum    (DEFAULT_THREADS, p, argc, "-n", MIN_THREADS,
   MAX_THREADS);
+  P->split    = ArgsNum64  (DEFAULT_SPLIT,   p, argc, "-k", 0, UINT64_MAX);
+  P->warmup   = ArgsNum64  (DEFAULT_WARMUP,  p, argc, "-w", 0, UINT64_MAX);
+  P->resume   = ArgsState  (0,               p, argc, "-R", "--resume");
+  P->ckp      = ArgsNum    (DEFAULT_CKP,     p, argc, "--ckp", 0, UINT32_MAX);
+  P->maxMem   = ArgsNum64  (0,               p, argc, "--max-mem", 0, 
+  UINT64_MAX >> 20);
+  P->statsJson = ArgsString(NULL,            p, argc, "--stats-json",
+  "--stats-json");
+  #ifdef LOCAL_SIMILARITY
+  P->trace    = ArgsNum64  (DEFAULT_TRACE,   p, argc, "-r", 0, UINT64_MAX);
+  #endif
+  if(P->split != 0 && P->split < MIN_SPLIT){
+    fprintf(stderr, "Error: the chunk size (-k) must be at least %u.\n",
+    MIN_SPLIT);
+    Free(P);
+    return EXIT_FAILURE;
+    }
+  if(P->warmup > P->split)
+    P->warmup = P->split;
+  shard       = ArgsString (NULL,            p, argc, "--shard", "--shard");
+  P->shard    = 0;
+  P->nShards  = 1;
+  if(shard != NULL && (sscanf(shard, "%u/%u%c", &P->shard, &P->nShards, &c)
+  != 2 || P->shard < 1 || P->shard > P->nShards)){
+    fprintf(stderr, "Error: the shard must be i/N, with 1 <= i <= N.\n");
+    Free(P);
+    return EXIT_FAILURE;
+    }
+  if(shard != NULL)
+    P->shard -= 1;
   
   // Magnet Integration Flags
   P->useMagnet       = ArgsState  (0, p, argc, "-mg", "--magnet");
@@ -1358,6 +2434,7 @@ int32_t P_Falcon(char **argv, int argc){
   P->loadModel  = ArgsState  (0, p, argc, "-L", "--load-model");
   P->modelInfo  = ArgsState  (0, p, argc, "-I", "--model-info");
   P->trainModel = ArgsState  (0, p, argc, "-T", "--train-model");
+  P->batch      = ArgsString (NULL, p, argc, "-B", "--batch");
   P->modelFile  = ArgsFileGen(p, argc, "-M", "falcon_model", ".fcm"); // FCM = Falcon Compression Model
 
   if(P->loadModel){
@@ -1429,6 +2506,26 @@ int32_t P_Falcon(char **argv, int argc){
     }
   #endif
 
+  if(P->nShards > 1){ // THE SHARD WRITES A PARTIAL TOP FOR FALCON2 merge
+    #ifdef LOCAL_SIMILARITY
+    if(P->local == 1){
+      fprintf(stderr, "  [x] Error: -Z is not available with --shard!\n");
+      return EXIT_FAILURE;
+      }
+    #endif
+    if(P->batch != NULL || P->trainModel){
+      fprintf(stderr, "  [x] Error: -B and -T are not available with "
+      "--shard!\n");
+      return EXIT_FAILURE;
+      }
+    Free(P->output);
+    sprintf(shardOut, "top.%u", P->shard + 1);
+    P->output = ArgsFileGen(p, argc, "-x", shardOut, ".ftop");
+    }
+
+  if(P->batch != NULL)
+    return FalconBatch(argv, argc, xargv, xargc, topSize);
+
   FILE *OUTLOC = NULL;
   FILE *OUTPUT = NULL;
 
@@ -1459,12 +2556,18 @@ int32_t P_Falcon(char **argv, int argc){
 
     P->nFiles     = ReadFNames (P, argv[argc-1], 0);
     fprintf(stderr, "\n");
-    if(P->verbose) PrintArgsTrain(P, T[0], argv[argc-1]);
+    FitModels(T, 0);
+    if(P->verbose){
+      PrintArgsTrain(P, T[0], argv[argc-1]);
+      PrintPlan(stderr, T[0].model, P->nModels, P->col, P->nThreads, 0, 
+      P->maxMem << 20);
+      }
 
     fprintf(stderr, "==[ PROCESSING ]====================\n");
     Time = CreateClock(clock());
+    ST   = CreateStats(1);
 
-    CompressActionTraining(T, argv[argc-1]);
+    CompressActionTraining(T, argv[argc-1], ST);
 
     fprintf(stderr, "  [+] Freeing compression models ... ");
     for(n = 0 ; n < P->nModels ; ++n)
@@ -1485,6 +2588,10 @@ int32_t P_Falcon(char **argv, int argc){
 
     fprintf(stderr, "==[ STATISTICS ]====================\n");
     StopCalcAll(Time, clock());
+    PrintStats(stderr, ST, P->verbose);
+    if(P->statsJson != NULL && WriteStatsJson(P->statsJson, ST) != 0)
+      fprintf(stderr, "Warning: unable to write %s\n", P->statsJson);
+    RemoveStats(ST);
     fprintf(stderr, "\n");
 
     if (xargv) {
@@ -1518,9 +2625,10 @@ int32_t P_Falcon(char **argv, int argc){
 
     return EXIT_SUCCESS;
   } else {
-    if(!P->force)
+    if(!P->force && !P->resume) // A RESUMED RUN WRITES ITS OWN OUTPUT
       FAccessWPerm(P->output);
-    OUTPUT = Fopen(P->output, "w");
+    if(P->nShards < 2)
+      OUTPUT = Fopen(P->output, "w");
 
 #ifdef LOCAL_SIMILARITY
     if(P->local == 1){
@@ -1536,11 +2644,27 @@ int32_t P_Falcon(char **argv, int argc){
     }
 
     // READ MODEL PARAMETERS FROM XARGS & ARGS
+    Names = CreateStrTab(); // HEADERS OF THE TOP ENTRIES OF ALL THE THREADS
     T = (Threads *) Calloc(P->nThreads, sizeof(Threads));
     for(ref = 0 ; ref < P->nThreads ; ++ref){
       T[ref].model = (ModelPar *) Calloc(P->nModels, sizeof(ModelPar));
       T[ref].id    = ref;
-      T[ref].top   = CreateTop(topSize);
+      T[ref].top   = CreateTop(topSize, Names);
+      T[ref].parts = CreatePartials();
+      #ifdef HASH_STATS // AT MOST ONE TOLERANT MODEL PER MODEL
+      T[ref].lookups = (uint64_t *) Calloc(2 * P->nModels, sizeof(uint64_t));
+      T[ref].found   = (uint64_t *) Calloc(2 * P->nModels, sizeof(uint64_t));
+      #endif
+      #ifdef LOCAL_SIMILARITY
+      if(P->local == 1 && P->trace != 0){
+        T[ref].trace = CreateStream(P->trace < DEF_STREAM_SIZE ? P->trace :
+        DEF_STREAM_SIZE);
+        if((T[ref].spill = tmpfile()) == NULL){
+          fprintf(stderr, "  [x] Error: unable to create the trace spill!\n");
+          exit(1);
+          }
+        }
+      #endif
       k = 0;
       for(n = 1 ; n < argc ; ++n)
         if(strcmp(argv[n], "-m") == 0)
@@ -1555,70 +2679,92 @@ int32_t P_Falcon(char **argv, int argc){
     P->nDatabases = ReadDBFNames (P, argv[argc-1], 0);
     P->nFiles     = ReadFNames (P, argv[argc-2], 0);
     fprintf(stderr, "\n");
-    if(P->verbose) PrintArgs(P, T[0], argv[argc-2], argv[argc-1], topSize);
+    if(!P->loadModel) // A LOADED MODEL KEEPS ITS OWN PARAMETERS
+      FitModels(T, topSize);
+    if(P->verbose){
+      PrintArgs(P, T[0], argv[argc-2], argv[argc-1], topSize);
+      if(!P->loadModel)
+        PrintPlan(stderr, T[0].model, P->nModels, P->col, P->nThreads, 
+        topSize, P->maxMem << 20);
+      }
 
+    InitMetaScan(&MS);
+    StartScanCkp(&MS, T, topSize);
     fprintf(stderr, "==[ PROCESSING ]====================\n");
-    Time = CreateClock(clock());
-    CompressAction(T, argv[argc-2], P->base);
+    Time  = CreateClock(clock());
+    ST    = CreateStats(P->nThreads);
+    MS.ST = ST;
+    CompressAction(&MS, T, argv[argc-2], P->base);
   }
 
+  StartPhase(ST, "merge", NULL);
   k = 0;
-  P->top = CreateTop(topSize * P->nThreads);
-  for(ref = 0 ; ref < P->nThreads ; ++ref){
-    for(n = 0 ; n < T[ref].top->size-1 ; ++n){
-      P->top->V[k].value = T[ref].top->V[n].value;
-      P->top->V[k].size  = T[ref].top->V[n].size;
-      P->top->V[k].dbIndex = T[ref].top->V[n].dbIndex;
-      #ifdef LOCAL_SIMILARITY
-      if(P->local == 1){
-        P->top->V[k].iPos = T[ref].top->V[n].iPos;
-        P->top->V[k].ePos = T[ref].top->V[n].ePos;
-        }
-      #endif
-      CopyStringPart(P->top->V[k].name, T[ref].top->V[n].name);
-      ++k;
-      }
-    }
+  P->top = CreateTop(topSize * P->nThreads, Names);
+  for(ref = 0 ; ref < P->nThreads ; ++ref)
+    for(n = 0 ; n < T[ref].top->size-1 ; ++n)
+      P->top->V[k++] = T[ref].top->V[n]; // THE NAMES ARE SHARED BY ID
 
   fprintf(stderr, "  [+] Sorting top .................. ");
   qsort(P->top->V, k, sizeof(VT), SortByValue);
   fprintf(stderr, "Done!\n");
+  StopPhase(ST, 0);
 
   fprintf(stderr, "  [+] Printing to output file ...... ");
-  #ifdef LOCAL_SIMILARITY
-  if(P->local == 1)
-    PrintTopWP(OUTPUT, P->top, topSize, P->dbFiles);
-  else
-    PrintTop(OUTPUT, P->top, topSize, P->dbFiles);
-  #else
-  PrintTop(OUTPUT, P->top, topSize);
-  #endif
-  fclose(OUTPUT);
+  StartPhase(ST, "output", P->output);
+  if(P->nShards > 1)
+    WriteFtop(P->output, P->top, topSize, ModelParamsHash(MODEL_HASH_SEED ^
+    (uint64_t) (P->gamma * 65536), T[0].model, P->nModels, P->col), topSize,
+    P->shard, P->nShards, P->dbFiles, P->nDatabases);
+  else{
+    #ifdef LOCAL_SIMILARITY
+    if(P->local == 1)
+      PrintTopWP(OUTPUT, P->top, topSize, P->dbFiles);
+    else
+      PrintTop(OUTPUT, P->top, topSize, P->dbFiles);
+    #else
+    PrintTop(OUTPUT, P->top, topSize);
+    #endif
+    fclose(OUTPUT);
+    }
+  StopPhase(ST, 0);
   fprintf(stderr, "Done!\n");
 
   #ifdef LOCAL_SIMILARITY
   if(P->local == 1){
     fprintf(stderr, "  [+] Running local similarity:\n");
+    StartPhase(ST, "local", P->outLoc);
     #ifdef KMODELSUSAGE
     LocalComplexityWKM(T[0], P->top, topSize, OUTLOC);
     #else
-    LocalComplexity(T[0], P->top, topSize, OUTLOC);
+    FALBW *FW = ends_with(P->outLoc, ".falb") ? CreateFalbW(OUTLOC) : NULL;
+    LocalComplexity(MS.F, T, P->top, topSize, OUTLOC, FW);
+    if(FW != NULL)
+      RemoveFalbW(FW);
     #endif
     fclose(OUTLOC);
+    StopPhase(ST, 0);
+    }
+  #endif
+
+  if(MS.CK != NULL){ // THE RUN IS OVER
+    CloseScanCkp(MS.CK, 1);
+    MS.CK = NULL;
     }
+
+  #if defined(HASH_STATS) && !defined(KMODELSUSAGE)
+  if(P->verbose)
+    PrintHashReport(MS.F, T);
   #endif
 
   fprintf(stderr, "  [+] Freeing compression models ... ");
+  #ifdef KMODELSUSAGE
   for(n = 0 ; n < P->nModels ; ++n)
-    #ifdef KMODELSUSAGE
     FreeKModel(KModels[n]);
-    #else
-    FreeCModel(Models[n]);
-    #endif
-  #ifdef KMODELSUSAGE
   Free(KModels);
   #else
-  Free(Models);
+  FalconRemove(MS.F); // AND ITS Models
+  MS.F   = NULL;
+  Models = NULL;
   #endif
   fprintf(stderr, "Done!\n");
 
@@ -1643,6 +2789,10 @@ int32_t P_Falcon(char **argv, int argc){
 
   fprintf(stderr, "==[ STATISTICS ]====================\n");
   StopCalcAll(Time, clock());
+  PrintStats(stderr, ST, P->verbose);
+  if(P->statsJson != NULL && WriteStatsJson(P->statsJson, ST) != 0)
+    fprintf(stderr, "Warning: unable to write %s\n", P->statsJson);
+  RemoveStats(ST);
   fprintf(stderr, "\n");
 
   if (xargv) {
@@ -1676,17 +2826,166 @@ int32_t P_Falcon(char **argv, int argc){
   DeleteTop(P->top);
   for(ref = 0 ; ref < P->nThreads ; ++ref){
     DeleteTop(T[ref].top);
+    DeletePartials(T[ref].parts);
+    #ifdef LOCAL_SIMILARITY
+    if(T[ref].trace != NULL){
+      RemoveStream(T[ref].trace);
+      fclose(T[ref].spill);
+      }
+    #endif
+    #ifdef HASH_STATS
+    Free(T[ref].lookups);
+    Free(T[ref].found);
+    #endif
     Free(T[ref].model);
     }
   Free(T);
+  DeleteStrTab(Names);
   Free(P);
 
   return EXIT_SUCCESS;
   }
 
+//////////////////////////////////////////////////////////////////////////////
+// - - - - - - - - - - F I L T E R   T H R E A D I N G - - - - - - - - - - - -
+
+typedef struct{
+  off_t    offset;   // Position of the first entry in the profiles file
+  uint64_t nEntries; // Entries stored (only for .falb)
+  uint64_t size;
+  double   value;
+  uint32_t name;     // Id in the names table
+  }
+PROFILE;
+
+typedef struct{
+  PROFILE  *V;
+  uint64_t nProfiles;
+  uint8_t  falb;     // Binary profiles
+  char     *fName;
+  STRTAB   *names;
+  ORDER    *O;
+  FILE     *OUT;
+  }
+PROFILES;
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static int InBounds(double value, uint64_t size){
+  return !(size > (uint64_t) PEYE->upperSize || size < (uint64_t) 
+  PEYE->lowerSize || value > PEYE->upperSimi || value < PEYE->lowerSimi);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void AddProfile(PROFILES *PR, off_t offset, uint64_t nEntries, double
+value, uint64_t size, char *name){
+  if(PR->nProfiles % 1024 == 0)
+    PR->V = (PROFILE *) Realloc(PR->V, (PR->nProfiles + 1024) * 
+    sizeof(PROFILE), 1024 * sizeof(PROFILE));
+  PR->V[PR->nProfiles].offset   = offset;
+  PR->V[PR->nProfiles].nEntries = nEntries;
+  PR->V[PR->nProfiles].size     = size;
+  PR->V[PR->nProfiles].value    = value;
+  PR->V[PR->nProfiles].name     = AddString(PR->names, name);
+  ++PR->nProfiles;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// INDEXES THE PROFILES WITHIN THE SIMILARITY AND SIZE BOUNDS, SKIPPING THEIR
+// ENTRIES WITH A SEEK (OR READING THE INDEX OF A .falb FILE)
+
+PROFILES *IndexProfiles(char *fName){
+  PROFILES *PR = (PROFILES *) Calloc(1, sizeof(PROFILES));
+  FILE     *IN = Fopen(fName, "r");
+  char     name[MAX_NAME];
+  double   value;
+  uint64_t size;
+  int      sym;
+
+  PR->fName = fName;
+  PR->names = CreateStrTab();
+  if((PR->falb = IsFalb(fName)) == 1){
+    FALBPROF PF;
+    uint64_t n, nOffsets, *offsets = FalbIndex(IN, &nOffsets);
+    for(n = 0 ; n < nOffsets ; ++n){
+      FalbProfile(IN, offsets[n], &PF);
+      if(InBounds(PF.value, PF.size))
+        AddProfile(PR, (off_t) PF.data, PF.nEntries, PF.value, PF.size,
+        PF.name);
+      }
+    Free(offsets);
+    fclose(IN);
+    return PR;
+    }
+
+  while((sym = fgetc(IN)) != EOF){
+    if(sym == '#'){
+      if(fscanf(IN, "\t%lf\t%"PRIu64"\t%s\n", &value, &size, name) != 3){
+        fprintf(stderr, "  [x] Error: unknown type of file!\n");
+        exit(1);
+        }
+
+      if(!InBounds(value, size))
+        continue;
+
+      AddProfile(PR, ftello(IN), 0, value, size, name);
+      Fseeko(IN, (off_t) size, SEEK_CUR);
+      }
+    }
+  fclose(IN);
+  return PR;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// EACH THREAD FILTERS WHOLE PROFILES, READING THEM FROM ITS OWN STREAM AND 
+// WRITING THE SEGMENTS TO MEMORY. THE ORDERED STAGE KEEPS THE INPUT ORDER.
+
+void *FilterThread(void *Pr){
+  PROFILES *PR  = (PROFILES *) Pr;
+  FILE     *IN  = Fopen(PR->fName, "r"), *MEM;
+  FILTER   *FIL = CreateFilter(PEYE->windowSize, PEYE->sampling, 
+  PEYE->windowType, PEYE->threshold);
+  FALBSTREAM *FB = PR->falb ? CreateFalbStream(IN) : NULL;
+  PROFILE  *PF;
+  char     *buf;
+  size_t   len;
+  int64_t  job;
+
+  while((job = OrderClaim(PR->O)) != -1){
+    PF  = &PR->V[job];
+    MEM = open_memstream(&buf, &len);
+    fprintf(MEM, "$\t%lf\t%"PRIu64"\t%s\n", PF->value, PF->size, 
+    GetString(PR->names, PF->name));
+    if(FB != NULL){
+      FalbSeek(FB, PF->offset, PF->nEntries);
+      InitEntriesFalb(FIL, PF->size, FB);
+      }
+    else{
+      Fseeko(IN, PF->offset, SEEK_SET);
+      InitEntries(FIL, PF->size, IN);
+      }
+    FilterStream(FIL, MEM);
+    fclose(MEM);
+
+    OrderBegin(PR->O, job);
+    fwrite(buf, 1, len, PR->OUT);
+    fprintf(stderr, "  [+] Filtering & segmenting %s ... Done!\n", 
+    GetString(PR->names, PF->name));
+    OrderEnd(PR->O);
+    free(buf);
+    }
+
+  if(FB != NULL)
+    RemoveFalbStream(FB);
+  DeleteFilter(FIL);
+  fclose(IN);
+  return NULL;
+  }
+
 int32_t P_Filter(char **argv, int argc){
   char **p = *&argv;
-  FILE *OUTPUT = NULL, *INPUT = NULL;
+  FILE *OUTPUT = NULL;
 
   PEYE = (EYEPARAM *) Malloc(1 * sizeof(EYEPARAM));
   if((PEYE->help = ArgsState(DEFAULT_HELP, p, argc, "-h", "--help")) == 1 || argc < 2){
@@ -1702,6 +3001,8 @@ int32_t P_Filter(char **argv, int argc){
 
   PEYE->verbose    = ArgsState  (DEFAULT_VERBOSE, p, argc, "-v", "--verbose");
   PEYE->force      = ArgsState  (DEFAULT_FORCE,   p, argc, "-F", "--force");
+  PEYE->nThreads   = ArgsNum    (DEFAULT_THREADS, p, argc, "-n", MIN_THREADS,
+  MAX_THREADS);
   PEYE->windowSize = ArgsNum    (100,             p, argc, "-s", 1, 999999);
   PEYE->windowType = ArgsNum    (1,               p, argc, "-w", 0, 3);
   PEYE->sampling   = ArgsNum    (10,              p, argc, "-x", 1, 999999);
@@ -1726,37 +3027,24 @@ int32_t P_Filter(char **argv, int argc){
   fprintf(stderr, "==[ PROCESSING ]====================\n");
   TIME *Time = CreateClock(clock());
 
-  int sym;
-  char fname[MAX_NAME];
-  double fvalue;
-  uint64_t fsize;
-
-  FILTER *FIL = CreateFilter(PEYE->windowSize, PEYE->sampling, PEYE->windowType,
-  PEYE->threshold);
-  INPUT = Fopen(argv[argc-1], "r");
-  while((sym = fgetc(INPUT)) != EOF){
-    if(sym == '#'){
-      if(fscanf(INPUT, "\t%lf\t%"PRIu64"\t%s\n", &fvalue, &fsize, fname) != 3){
-        fprintf(stderr, "  [x] Error: unknown type of file!\n");
-        exit(1);
-        }
+  uint32_t  n;
+  PROFILES  *PR = IndexProfiles(argv[argc-1]);
+  pthread_t t[PEYE->nThreads];
 
-      if(fsize > PEYE->upperSize ||  fsize < PEYE->lowerSize ||
-        fvalue > PEYE->upperSimi || fvalue < PEYE->lowerSimi)
-        continue;
+  PR->O   = CreateOrder(PR->nProfiles);
+  PR->OUT = OUTPUT;
+  for(n = 0 ; n < PEYE->nThreads ; ++n)
+    pthread_create(&(t[n]), NULL, FilterThread, (void *) PR);
+  for(n = 0 ; n < PEYE->nThreads ; ++n)
+    pthread_join(t[n], NULL);
 
-      fprintf(stderr, "  [+] Filtering & segmenting %s ... ", fname);
-      fprintf(OUTPUT, "$\t%lf\t%"PRIu64"\t%s\n", fvalue, fsize, fname);
-      InitEntries(FIL, fsize, INPUT);
-      FilterStream(FIL, OUTPUT);
-      DeleteEntries(FIL);
-      fprintf(stderr, "Done!\n");
-      }
-    }
-  DeleteFilter(FIL);
+  RemoveOrder(PR->O);
+  DeleteStrTab(PR->names);
+  if(PR->V != NULL)
+    Free(PR->V);
+  Free(PR);
 
   fclose(OUTPUT);
-  fclose(INPUT);
 
   StopTimeNDRM(Time, clock());
   fprintf(stderr, "\n");
@@ -1770,158 +3058,204 @@ int32_t P_Filter(char **argv, int argc){
   return EXIT_SUCCESS;
   }
 
-int32_t P_Filter_Visual(char **argv, int argc){
-  char **p = *&argv, fname[MAX_NAME];
-  FILE *OUTPUT = NULL, *INPUT = NULL;
-  int sym;
-  double fvalue;
-  uint32_t n, tmp, maxName, extraLength, cmp;
-  uint64_t maxSize = 0, fsize, iPos, ePos, nSeq, filtered;
-  Painter *Paint;
-  COLORS *CLR;
+//////////////////////////////////////////////////////////////////////////////
+// - - - - - - - - - - - - F I L T E R   V I S U A L - - - - - - - - - - - - -
 
-  PEYE = (EYEPARAM *) Malloc(1 * sizeof(EYEPARAM));
-  if((PEYE->help = ArgsState(DEFAULT_HELP, p, argc, "-h", "--help")) == 1 || argc < 2){
-    PrintMenuVisual();
-    Free(P);
-    return EXIT_SUCCESS;
-  }
+// THE .fil FILE IS PARSED ONCE INTO A SEGMENT LIST. ONLY THE SEQUENCES THAT 
+// PASS THE BOUNDS (AND THE -bg SPECIES FILTER) ARE KEPT, WITH THE NAME TO
+// PAINT. ADJACENT SEGMENTS OF THE SAME COLOUR ARE MERGED WHILE LOADING.
 
-  if(ArgsState(DEF_VERSION, p, argc, "-V", "--version")){
-    PrintVersion();
-    Free(P);
-    return EXIT_SUCCESS;
+typedef struct{
+  uint64_t iPos;
+  uint64_t ePos;
+  uint8_t  cmp;
+  }
+VSEG;
+
+typedef struct{
+  double   value;
+  uint64_t size;
+  uint64_t seg;      // First segment in the list
+  uint64_t nSeg;
+  uint32_t name;     // Header of the entry
+  uint32_t label;    // Name to paint (the species with -bg)
+  uint8_t  region;   // '$' has segments, '#' is a top entry
   }
+VSEQ;
+
+typedef struct{
+  VSEQ     *S;
+  uint64_t nSeq;
+  VSEG     *G;
+  uint64_t nSeg;
+  uint64_t maxSeg;
+  uint64_t maxSize;
+  uint64_t filtered;
+  uint64_t unique;
+  uint32_t maxName;
+  STRTAB   *names;
+  }
+VMAP;
 
-  PEYE->verbose    = ArgsState  (DEFAULT_VERBOSE, p, argc, "-v", "--verbose");
-  PEYE->force      = ArgsState  (DEFAULT_FORCE,   p, argc, "-F", "--force");
-  PEYE->width      = ArgsDouble (DEFAULT_WIDTH,   p, argc, "-w");
-  PEYE->space      = ArgsDouble (DEFAULT_SPACE,   p, argc, "-s");
-  PEYE->showScale  = ArgsState  (DEFAULT_SHOWS,   p, argc, "-ss", "-showScale");
-  PEYE->showNames  = ArgsState  (DEFAULT_NAMES,   p, argc, "-sn", "-showNames");
-  PEYE->sameScale  = ArgsState  (DEFAULT_RSCAL,   p, argc, "-rs", "-sameScale");
-  PEYE->best       = ArgsState  (DEFAULT_GBEST,   p, argc, "-bg", "-best");
-  PEYE->start      = ArgsDouble (0.35,            p, argc, "-i");
-  PEYE->rotations  = ArgsDouble (1.50,            p, argc, "-r");
-  PEYE->hue        = ArgsDouble (1.92,            p, argc, "-u");
-  PEYE->gamma      = ArgsDouble (0.50,            p, argc, "-g");
-  PEYE->proportion = ArgsDouble (500,             p, argc, "-p");
-  PEYE->lowerSimi  = ArgsDouble (0.00,            p, argc, "-sl");
-  PEYE->upperSimi  = ArgsDouble (100.00,          p, argc, "-su");
-  PEYE->lowerSize  = ArgsNum64  (1,               p, argc, "-dl", 1,
-  9999999999);
-  PEYE->upperSize  = ArgsNum64  (9999999999,      p, argc, "-du", 1,
-  9999999999);
-  PEYE->enlarge    = ArgsNum64  (0,               p, argc, "-e",  0,
-  9999999999);
-  PEYE->output     = ArgsFileGen(p, argc, "-o", "femap", ".svg");
-
-  if(!PEYE->force)
-    FAccessWPerm(PEYE->output);
-  OUTPUT = Fopen(PEYE->output, "w");
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  fprintf(stderr, "\n");
-  if(PEYE->verbose){
-    PrintArgsEye(PEYE);
+static void AddVSeg(VMAP *VM, uint64_t iPos, uint64_t ePos, uint8_t cmp){
+  VSEQ *S = &VM->S[VM->nSeq-1];
+  VSEG *G;
+  if(S->nSeg > 0){
+    G = &VM->G[VM->nSeg-1];
+    if(G->cmp == cmp && iPos <= G->ePos + 1){ // ADJACENT: MERGE
+      if(ePos > G->ePos)
+        G->ePos = ePos;
+      return;
+      }
+    }
+  if(VM->nSeg == VM->maxSeg){
+    VM->maxSeg = VM->maxSeg == 0 ? 4096 : VM->maxSeg * 2;
+    VM->G = (VSEG *) Realloc(VM->G, VM->maxSeg * sizeof(VSEG), VM->maxSeg / 2
+    * sizeof(VSEG));
     }
+  G = &VM->G[VM->nSeg++];
+  G->iPos = iPos;
+  G->ePos = ePos;
+  G->cmp  = cmp;
+  ++S->nSeg;
+  }
 
-  fprintf(stderr, "==[ PROCESSING ]====================\n");
-  TIME *Time = CreateClock(clock());
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  // TODO: OPTION TO IGNORE SCALE AND SET THEM AT SAME SIZE
+static int ParseVSeg(char *line, uint64_t *iPos, uint64_t *ePos, uint8_t *cmp){
+  char *end;
+  if(*line < '0' || *line > '9')
+    return 0;
+  *iPos = strtoull(line, &end, 10);
+  if(*end != ':')
+    return 0;
+  *ePos = strtoull(end + 1, &end, 10);
+  if(*end != '\t')
+    return 0;
+  *cmp = (uint8_t) strtoul(end + 1, NULL, 10);
+  return 1;
+  }
 
-  CLR = (COLORS *) Calloc(1, sizeof(COLORS));
-  CLR->start     = PEYE->start;
-  CLR->rotations = PEYE->rotations;
-  CLR->hue       = PEYE->hue;
-  CLR->gamma     = PEYE->gamma;
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static VMAP *LoadVMap(FILE *IN){
+  VMAP     *VM = (VMAP *) Calloc(1, sizeof(VMAP));
+  SLABELS  *SL = CreateSLabels();
+  char     *line = NULL, fname[MAX_NAME], *label;
+  size_t   lineSize = 0;
+  uint64_t fsize, iPos, ePos;
+  uint8_t  cmp, keep = 0;
+  double   fvalue;
+  regex_t  regexCompiled;
+  regmatch_t groupArray[2];
+  uint32_t tmp;
 
-  // BUILD UNIQUE ARRAY FOR NAMES USING REGULAR EXPRESSION:
-  //
-  SLABELS *SL = CreateSLabels();
-  uint64_t unique = 0;
   // tested at: https://regex101.com/
   char *regexString = ".*\\|.*\\|.*\\|_([a-z A-Z]*_[a-z A-Z]*)";
-  regex_t regexCompiled;
-  regmatch_t groupArray[2];
   if(PEYE->best == 1){
     if(regcomp(&regexCompiled, regexString, REG_EXTENDED)){
       fprintf(stderr, "  [x] Error: regular expression compilation!\n");
-      return 1;
+      exit(1);
       }
     }
 
-  INPUT = Fopen(argv[argc-1], "r");
-  nSeq = 0;
-  maxName = 0;
-  filtered = 0;
-  while((sym = fgetc(INPUT)) != EOF){
-
-    if(sym == '$' || sym == '#'){
-      if(fscanf(INPUT, "\t%lf\t%"PRIu64"\t%s\n", &fvalue, &fsize, fname) != 3){
-        fprintf(stderr, "  [x] Error: unknown type of file!\n");
-        exit(1);
-        }
-
-      if(PEYE->best == 1){
-        if(regexec(&regexCompiled, fname, 2, groupArray, 0) == 0){
-          char sourceCopy[strlen(fname) + 1];
-          strcpy(sourceCopy, fname);
-          sourceCopy[groupArray[1].rm_eo] = 0;
-          if(SearchSLabels(SL, sourceCopy + groupArray[1].rm_so) == 0){
-            ++unique;
-            AddSLabel(SL, sourceCopy + groupArray[1].rm_so);
-            UpdateSLabels(SL);
-            }
-          else{
-            ++filtered;
-            continue;
-            }
-          }
-        }
+  VM->names = CreateStrTab();
+  while(getline(&line, &lineSize, IN) != -1){
 
-      if(fsize > PEYE->upperSize ||  fsize < PEYE->lowerSize ||
-        fvalue > PEYE->upperSimi || fvalue < PEYE->lowerSimi){
-        ++filtered;
-        continue;
-        }
+    if(line[0] != '$' && line[0] != '#'){
+      if(keep == 1 && ParseVSeg(line, &iPos, &ePos, &cmp))
+        AddVSeg(VM, iPos, ePos, cmp);
+      continue;
+      }
 
-      if(fsize > maxSize)
-        maxSize = fsize;
+    if(sscanf(line + 1, "\t%lf\t%"PRIu64"\t%s", &fvalue, &fsize, fname) != 3){
+      fprintf(stderr, "  [x] Error: unknown type of file!\n");
+      exit(1);
+      }
 
-      if(PEYE->best == 1){
-        if((tmp = strlen(SL->names[SL->idx-1])) > maxName)
-          maxName = tmp;
-        }
-      else{
-        if((tmp = strlen(fname)) > maxName)
-          maxName = tmp;
+    keep  = 0;
+    label = fname;
+    if(PEYE->best == 1){
+      if(regexec(&regexCompiled, fname, 2, groupArray, 0) == 0){
+        char sourceCopy[strlen(fname) + 1];
+        strcpy(sourceCopy, fname);
+        sourceCopy[groupArray[1].rm_eo] = 0;
+        if(SearchSLabels(SL, sourceCopy + groupArray[1].rm_so) == 0){
+          ++VM->unique;
+          AddSLabel(SL, sourceCopy + groupArray[1].rm_so);
+          UpdateSLabels(SL);
+          }
+        else{
+          ++VM->filtered;
+          continue;
+          }
         }
-      ++nSeq;
+      if(SL->idx > 0)
+        label = LastSLabel(SL);
       }
-    }
-  rewind(INPUT);
 
-  fprintf(stderr, "Skipping %"PRIu64" from %"PRIu64" entries.\n",
-  filtered, filtered+nSeq);
+    if(fsize > (uint64_t) PEYE->upperSize || fsize < (uint64_t) 
+    PEYE->lowerSize || fvalue > PEYE->upperSimi || fvalue < PEYE->lowerSimi){
+      ++VM->filtered;
+      continue;
+      }
 
+    if(VM->nSeq % 1024 == 0)
+      VM->S = (VSEQ *) Realloc(VM->S, (VM->nSeq + 1024) * sizeof(VSEQ), 1024 
+      * sizeof(VSEQ));
+    VM->S[VM->nSeq].value  = fvalue;
+    VM->S[VM->nSeq].size   = fsize;
+    VM->S[VM->nSeq].seg    = VM->nSeg;
+    VM->S[VM->nSeq].nSeg   = 0;
+    VM->S[VM->nSeq].name   = AddString(VM->names, fname);
+    VM->S[VM->nSeq].label  = AddString(VM->names, label);
+    VM->S[VM->nSeq].region = line[0];
+    ++VM->nSeq;
+    keep = 1;
+
+    if(fsize > VM->maxSize)
+      VM->maxSize = fsize;
+    if((tmp = strlen(label)) > VM->maxName)
+      VM->maxName = tmp;
+    }
 
   if(PEYE->best == 1){
-    fprintf(stderr, "Number of unique existing species: %"PRIu64".\n", unique);
+    uint32_t n;
+    fprintf(stderr, "Number of unique existing species: %"PRIu64".\n", 
+    VM->unique);
     fprintf(stderr, "Unique species:\n");
     for(n = 0 ; n < SL->idx ; ++n)
-      fprintf(stderr, "  [+] %s\n", SL->names[n]);
-    DeleteSLabels(SL);
-    SL = CreateSLabels();
+      fprintf(stderr, "  [+] %s\n", GetSLabel(SL, n));
+    regfree(&regexCompiled);
     }
-  Paint = CreatePainter(maxSize, PEYE->width, PEYE->space, PEYE->proportion,
-  "#ffffff");
 
-  extraLength = 0;
-  if(PEYE->showNames == 1){
-    extraLength = 10 * maxName; // LETTER SIZE * MAXNAME
-    Paint->cy += extraLength;
-    }
+  DeleteSLabels(SL);
+  free(line);
+  return VM;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void RemoveVMap(VMAP *VM){
+  DeleteStrTab(VM->names);
+  if(VM->S != NULL)
+    Free(VM->S);
+  if(VM->G != NULL)
+    Free(VM->G);
+  Free(VM);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void PaintVMapSvg(FILE *OUTPUT, VMAP *VM, Painter *Paint, COLORS *CLR,
+uint32_t extraLength){
+  char     *colors[5];
+  uint32_t n;
+  uint64_t nSeq = VM->nSeq, k;
+  VSEQ     *S;
+  VSEG     *G;
 
   if(PEYE->showScale == 1)
     nSeq += 2;
@@ -1963,171 +3297,229 @@ int32_t P_Filter_Visual(char **argv, int argc){
     +(Paint->width/2)+4, "-");
     }
 
+  colors[0] = GetRgbColor(LOW_COMPLEX);
+  colors[1] = GetRgbColor(MEDIUML_COMPLEX);
+  colors[2] = GetRgbColor(MEDIUMH_COMPLEX);
+  colors[3] = GetRgbColor(HIGH_COMPLEX);
+  colors[4] = GetRgbColor(0);
+
   if(nSeq > 0) fprintf(stderr, "Addressing regions individually:\n");
-  while((sym = fgetc(INPUT)) != EOF){
+  for(k = 0 ; k < VM->nSeq ; ++k){
+    S = &VM->S[k];
 
-    if(sym == '$' || sym == '#'){
-      if(fscanf(INPUT, "\t%lf\t%"PRIu64"\t%s\n", &fvalue, &fsize, fname) != 3){
-        fprintf(stderr, "  [x] Error: unknown type of file!\n");
-        exit(1);
-        }
+    if(PEYE->showNames == 1)  // PRINT NAMES 90D
+      Text90d(OUTPUT, -(Paint->cy-32), Paint->cx+Paint->width-
+      (Paint->width/2.0)+10, GetString(VM->names, S->label));
 
-      if(sym == '#'){
-        if(PEYE->best == 1){
-          if(regexec(&regexCompiled, fname, 2, groupArray, 0) == 0){
-            char sourceCopy[strlen(fname) + 1];
-            strcpy(sourceCopy, fname);
-            sourceCopy[groupArray[1].rm_eo] = 0;
-            if(SearchSLabels(SL, sourceCopy + groupArray[1].rm_so) == 0){
-              AddSLabel(SL, sourceCopy + groupArray[1].rm_so);
-              UpdateSLabels(SL);
-              }
-            else{ // SKIP
-              continue;
-              }
-            }
-          }
+    if(PEYE->best == 1)
+      fprintf(stderr, "  [+] Painting %s (%s) ... ", GetString(VM->names,
+      S->label), GetString(VM->names, S->name));
+    else
+      fprintf(stderr, "  [+] Painting %s ... ", GetString(VM->names, S->name));
 
-        // SKIPS: FILTERED ATTRIBUTES
-        if(fsize > PEYE->upperSize ||  fsize < PEYE->lowerSize ||
-          fvalue > PEYE->upperSimi || fvalue < PEYE->lowerSimi){
-          continue;
-          }
+    char tmpTxt[MAX_NAME], color[12];
+    if(S->value < 10){
+      sprintf(tmpTxt, "%.1lf", S->value);
+      Text(OUTPUT, (Paint->cx+Paint->width/2)-12, Paint->cy-10, tmpTxt);
+      }
+    else{
+      sprintf(tmpTxt, "%u", (unsigned) S->value);
+      Text(OUTPUT, (Paint->cx+Paint->width/2)-9, Paint->cy-10, tmpTxt);
+      }
+    RectWithBorder(OUTPUT, Paint->width, Paint->width, Paint->cx, Paint->cy,
+    HeatMapColor(BoundDouble(0.0, 1-S->value/100.0, 1.0), color, CLR));
 
-        if(PEYE->showNames == 1){  // PRINT NAMES 90D
-          if(PEYE->best == 1){
-            Text90d(OUTPUT, -(Paint->cy-32), Paint->cx+Paint->width-
-            (Paint->width/2.0)+10, SL->names[SL->idx-1]);
-            }
-          else{
-            Text90d(OUTPUT, -(Paint->cy-32), Paint->cx+Paint->width-
-            (Paint->width/2.0)+10, fname);
-            }
-          }
+    if(S->region == '#'){ // TOP ENTRY: NO LOCAL COMPLEXITY
+      Paint->cx += Paint->width + Paint->space;
+      fprintf(stderr, "Done!\n");
+      continue;
+      }
 
-        if(PEYE->best == 1)
-          fprintf(stderr, "  [+] Painting %s (%s) ... ", SL->names[SL->idx-1],
-          fname);
-        else
-          fprintf(stderr, "  [+] Painting %s ... ", fname);
+    Paint->cy += Paint->width + Paint->space;
+    for(G = &VM->G[S->seg] ; G < &VM->G[S->seg + S->nSeg] ; ++G)
+      RectFill(OUTPUT, Paint->width, GetPoint(Paint, G->ePos-G->iPos+1+
+      PEYE->enlarge), Paint->cx, Paint->cy + GetPoint(Paint, G->iPos),
+      colors[G->cmp < 4 ? G->cmp : 4]);
+    Chromosome(OUTPUT, Paint->width, GetPoint(Paint, S->size), Paint->cx,
+    Paint->cy);
+    Paint->cx += Paint->width + Paint->space;
+    Paint->cy -= Paint->width + Paint->space;
+    fprintf(stderr, "Done!\n");
+    }
 
-        char tmpTxt[MAX_NAME], color[12];
-        if(fvalue < 10){
-          sprintf(tmpTxt, "%.1lf", fvalue);
-          Text(OUTPUT, (Paint->cx+Paint->width/2)-12, Paint->cy-10, tmpTxt);
-          }
-        else{
-          sprintf(tmpTxt, "%u", (unsigned) fvalue);
-          Text(OUTPUT, (Paint->cx+Paint->width/2)-9, Paint->cy-10, tmpTxt);
-          }
-        RectWithBorder(OUTPUT, Paint->width, Paint->width, Paint->cx, Paint->cy,
-        HeatMapColor(BoundDouble(0.0, 1-fvalue/100.0, 1.0), color, CLR));
+  PrintFinal(OUTPUT); // IT ALSO CLOSES THE FILE
 
-        if(nSeq > 0)
-          Paint->cx += Paint->width + Paint->space;
-        fprintf(stderr, "Done!\n");
-        continue; // CONTINUE WITHOUT WRITTING LOCAL COMPLEXITY
-        }
+  for(n = 0 ; n < 5 ; ++n)
+    Free(colors[n]);
+  }
 
-      if(PEYE->best == 1){
-        if(regexec(&regexCompiled, fname, 2, groupArray, 0) == 0){
-          char sourceCopy[strlen(fname) + 1];
-          strcpy(sourceCopy, fname);
-          sourceCopy[groupArray[1].rm_eo] = 0;
-          if(SearchSLabels(SL, sourceCopy + groupArray[1].rm_so) == 0){
-            AddSLabel(SL, sourceCopy + groupArray[1].rm_so);
-            UpdateSLabels(SL);
-            }
-          else{ // SKIP
-            while(fscanf(INPUT, "%"PRIu64":%"PRIu64"\t%u\n", &iPos, &ePos, &cmp)
-            == 3)
-              ; // DO NOTHING
-            continue;
-            }
-          }
-        }
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// THE PIXEL MAP HAS THE SAME LAYOUT AS THE SVG, WITHOUT THE TEXT
 
-      // SKIPS: FILTERED ATTRIBUTES
-      if(fsize > PEYE->upperSize ||  fsize < PEYE->lowerSize ||
-        fvalue > PEYE->upperSimi || fvalue < PEYE->lowerSimi){
-        while(fscanf(INPUT, "%"PRIu64":%"PRIu64"\t%u\n", &iPos, &ePos, &cmp)
-        == 3)
-          ; // DO NOTHING
-        continue;
-        }
+typedef struct{
+  VMAP     *VM;
+  Painter  *Paint;
+  COLORS   *CLR;
+  RgbColor colors[5];
+  }
+VPAINT;
+
+static void VMapRaster(RASTER *R, void *Vp){
+  VPAINT   *VP = (VPAINT *) Vp;
+  Painter  *Pa = VP->Paint;
+  RgbColor black = { 0, 0, 0 };
+  double   cx, cy = Pa->cy;
+  uint64_t k;
+  uint32_t n, size;
+  VSEQ     *S;
+  VSEG     *G;
 
-      if(PEYE->showNames == 1){  // PRINT NAMES 90D
-        if(PEYE->best == 1){
-          Text90d(OUTPUT, -(Paint->cy-32), Paint->cx+Paint->width-
-          (Paint->width/2.0)+10, SL->names[SL->idx-1]);
-          }
-        else{
-          Text90d(OUTPUT, -(Paint->cy-32), Paint->cx+Paint->width-
-          (Paint->width/2.0)+10, fname);
-          }
-        }
+  if(PEYE->showScale == 1){
+    size = 4 * Pa->width;
+    for(n = 0 ; n < size ; ++n)
+      RasterRect(R, Pa->width, 1, Pa->cx - (Pa->width*2), cy + n, 
+      HeatMapRgb(((double) n / size), VP->CLR));
+    for(n = 1 ; n <= 4 ; ++n) // HIGH, MEDIUMH, MEDIUML AND LOW COMPLEX
+      RasterRect(R, Pa->width, Pa->width, Pa->cx - (Pa->width*2), cy + n *
+      Pa->width + size, VP->colors[4-n]);
+    }
 
-      char tmpTxt[MAX_NAME], color[12];
-      if(fvalue < 10){
-        sprintf(tmpTxt, "%.1lf", fvalue);
-        Text(OUTPUT, (Paint->cx+Paint->width/2)-12, Paint->cy-10, tmpTxt);
-        }
-      else{
-        sprintf(tmpTxt, "%u", (unsigned) fvalue);
-        Text(OUTPUT, (Paint->cx+Paint->width/2)-9, Paint->cy-10, tmpTxt);
-        }
-      RectWithBorder(OUTPUT, Paint->width, Paint->width, Paint->cx, Paint->cy,
-      HeatMapColor(BoundDouble(0.0, 1-fvalue/100.0, 1.0), color, CLR));
-
-      Paint->cy += Paint->width + Paint->space;
-
-      if(PEYE->best == 1)
-        fprintf(stderr, "  [+] Painting %s (%s) ... ", SL->names[SL->idx-1],
-        fname);
-      else
-        fprintf(stderr, "  [+] Painting %s ... ", fname);
-      while(1){
-        off_t beg = Ftello(INPUT);
-        if(fscanf(INPUT, "%"PRIu64":%"PRIu64"\t%u\n", &iPos, &ePos, &cmp) != 3){
-          Fseeko(INPUT, (off_t) beg, SEEK_SET);
-          Chromosome(OUTPUT, Paint->width, GetPoint(Paint, fsize), Paint->cx,
-          Paint->cy);
-          if(nSeq > 0)
-            Paint->cx += Paint->width + Paint->space;
-          break;
-          }
-        else{
-          int color = 0;
-          switch(cmp){
-            case 0: color = LOW_COMPLEX;     break;
-            case 1: color = MEDIUML_COMPLEX; break;
-            case 2: color = MEDIUMH_COMPLEX; break;
-            case 3: color = HIGH_COMPLEX;    break;
-            default: color = 0;
-            }
-          if(PEYE->enlarge == 0){
-            Rect(OUTPUT, Paint->width, GetPoint(Paint, ePos-iPos+1), Paint->cx,
-            Paint->cy + GetPoint(Paint, iPos), GetRgbColor(color));
-            }
-          else{
-            Rect(OUTPUT, Paint->width, GetPoint(Paint, ePos-iPos+1+PEYE->enlarge),
-            Paint->cx, Paint->cy + GetPoint(Paint, iPos), GetRgbColor(color));
-            }
-          }
-        }
+  for(k = 0 ; k < VP->VM->nSeq ; ++k){
+    S  = &VP->VM->S[k];
+    cx = Pa->cx + k * (Pa->width + Pa->space);
+    if(cx > R->x0 + R->width || cx + Pa->width < R->x0)
+      continue; // OUT OF THE VIEW
+
+    RasterRect(R, Pa->width, Pa->width, cx, cy, HeatMapRgb(BoundDouble(0.0,
+    1-S->value/100.0, 1.0), VP->CLR));
+    RasterFrame(R, Pa->width, Pa->width, cx, cy, black);
+    if(S->region == '#')
+      continue;
+
+    for(G = &VP->VM->G[S->seg] ; G < &VP->VM->G[S->seg + S->nSeg] ; ++G)
+      RasterRect(R, Pa->width, GetPoint(Pa, G->ePos-G->iPos+1+PEYE->enlarge),
+      cx, cy + Pa->width + Pa->space + GetPoint(Pa, G->iPos), 
+      VP->colors[G->cmp < 4 ? G->cmp : 4]);
+    RasterFrame(R, Pa->width, GetPoint(Pa, S->size), cx, cy + Pa->width + 
+    Pa->space, black);
+    }
+  }
 
-      Paint->cy -= Paint->width + Paint->space;
-      fprintf(stderr, "Done!\n");
-      }
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// THE NAMES ARE NOT DRAWN ON A RASTER, SO NO ROWS ARE KEPT FOR THEM
+
+static void PaintVMapRaster(VMAP *VM, Painter *Paint, COLORS *CLR){
+  VPAINT   VP = { VM, Paint, CLR, { HueRgb(LOW_COMPLEX), HueRgb(MEDIUML_COMPLEX),
+  HueRgb(MEDIUMH_COMPLEX), HueRgb(HIGH_COMPLEX), HueRgb(0) } };
+  uint64_t nSeq = VM->nSeq + (PEYE->showScale == 1 ? 2 : 0);
+
+  if(PEYE->showScale == 1)
+    Paint->cx += (2 * Paint->width + PEYE->space);
+  fprintf(stderr, "  [+] Painting %"PRIu64" regions (no text) ... ", 
+  VM->nSeq);
+  PaintRaster(PEYE->output, (2 * DEFAULT_CX) + (((Paint->width + PEYE->space) 
+  * nSeq) - PEYE->space), Paint->size + EXTRA + Paint->width, PEYE->tile,
+  VMapRaster, &VP);
+  fprintf(stderr, "Done!\n");
+  }
+
+int32_t P_Filter_Visual(char **argv, int argc){
+  char **p = *&argv;
+  FILE *OUTPUT = NULL, *INPUT = NULL;
+  uint32_t extraLength;
+  uint64_t nSeq;
+  Painter *Paint;
+  COLORS *CLR;
+  VMAP *VM;
+
+  PEYE = (EYEPARAM *) Malloc(1 * sizeof(EYEPARAM));
+  if((PEYE->help = ArgsState(DEFAULT_HELP, p, argc, "-h", "--help")) == 1 || argc < 2){
+    PrintMenuVisual();
+    Free(P);
+    return EXIT_SUCCESS;
+  }
+
+  if(ArgsState(DEF_VERSION, p, argc, "-V", "--version")){
+    PrintVersion();
+    Free(P);
+    return EXIT_SUCCESS;
+  }
+
+  PEYE->verbose    = ArgsState  (DEFAULT_VERBOSE, p, argc, "-v", "--verbose");
+  PEYE->force      = ArgsState  (DEFAULT_FORCE,   p, argc, "-F", "--force");
+  PEYE->width      = ArgsDouble (DEFAULT_WIDTH,   p, argc, "-w");
+  PEYE->space      = ArgsDouble (DEFAULT_SPACE,   p, argc, "-s");
+  PEYE->showScale  = ArgsState  (DEFAULT_SHOWS,   p, argc, "-ss", "-showScale");
+  PEYE->showNames  = ArgsState  (DEFAULT_NAMES,   p, argc, "-sn", "-showNames");
+  PEYE->sameScale  = ArgsState  (DEFAULT_RSCAL,   p, argc, "-rs", "-sameScale");
+  PEYE->best       = ArgsState  (DEFAULT_GBEST,   p, argc, "-bg", "-best");
+  PEYE->start      = ArgsDouble (0.35,            p, argc, "-i");
+  PEYE->rotations  = ArgsDouble (1.50,            p, argc, "-r");
+  PEYE->hue        = ArgsDouble (1.92,            p, argc, "-u");
+  PEYE->gamma      = ArgsDouble (0.50,            p, argc, "-g");
+  PEYE->proportion = ArgsDouble (500,             p, argc, "-p");
+  PEYE->lowerSimi  = ArgsDouble (0.00,            p, argc, "-sl");
+  PEYE->upperSimi  = ArgsDouble (100.00,          p, argc, "-su");
+  PEYE->lowerSize  = ArgsNum64  (1,               p, argc, "-dl", 1,
+  9999999999);
+  PEYE->upperSize  = ArgsNum64  (9999999999,      p, argc, "-du", 1,
+  9999999999);
+  PEYE->enlarge    = ArgsNum64  (0,               p, argc, "-e",  0,
+  9999999999);
+  PEYE->tile       = ArgsNum64  (0,               p, argc, "-tile", 0, 
+  UINT32_MAX);
+  PEYE->output     = ArgsFileGen(p, argc, "-o", "femap", ".svg");
+
+  if(!PEYE->force)
+    FAccessWPerm(PEYE->output);
+  if(RasterType(PEYE->output) == RASTER_NONE){
+    OUTPUT = Fopen(PEYE->output, "w");
+    setvbuf(OUTPUT, NULL, _IOFBF, 1 << 22); // ONE FLUSH PER 4 MB OF SVG
     }
 
-  PrintFinal(OUTPUT);
+  fprintf(stderr, "\n");
+  if(PEYE->verbose){
+    PrintArgsEye(PEYE);
+    }
 
-  fclose(OUTPUT);
+  fprintf(stderr, "==[ PROCESSING ]====================\n");
+  TIME *Time = CreateClock(clock());
+
+  // TODO: OPTION TO IGNORE SCALE AND SET THEM AT SAME SIZE
+
+  CLR = (COLORS *) Calloc(1, sizeof(COLORS));
+  CLR->start     = PEYE->start;
+  CLR->rotations = PEYE->rotations;
+  CLR->hue       = PEYE->hue;
+  CLR->gamma     = PEYE->gamma;
+
+  // A .falb FILE ONLY GIVES ITS HEADERS (AS THE '#' LINES OF A .fal FILE)
+  INPUT = IsFalb(argv[argc-1]) ? FalbHeaders(argv[argc-1]) : 
+  Fopen(argv[argc-1], "r");
+  VM = LoadVMap(INPUT);
   fclose(INPUT);
+  nSeq = VM->nSeq;
+
+  fprintf(stderr, "Skipping %"PRIu64" from %"PRIu64" entries.\n",
+  VM->filtered, VM->filtered+nSeq);
+
+  Paint = CreatePainter(VM->maxSize, PEYE->width, PEYE->space, PEYE->proportion,
+  "#ffffff");
+
+  extraLength = 0;
+  if(PEYE->showNames == 1 && RasterType(PEYE->output) == RASTER_NONE){
+    extraLength = 10 * VM->maxName; // LETTER SIZE * MAXNAME
+    Paint->cy += extraLength;
+    }
+
+  if(RasterType(PEYE->output) == RASTER_NONE)
+    PaintVMapSvg(OUTPUT, VM, Paint, CLR, extraLength);
+  else
+    PaintVMapRaster(VM, Paint, CLR);
+
+  RemovePainter(Paint);
+  RemoveVMap(VM);
   Free(CLR);
-  if(PEYE->best == 1)
-    DeleteSLabels(SL);
   StopTimeNDRM(Time, clock());
   fprintf(stderr, "\n");
 
@@ -2143,8 +3535,11 @@ int32_t P_Inter(char **argv, int argc){
   char        **p = *&argv, **xargv, *xpl = NULL;
   int32_t     xargc = 0;
   uint32_t    n, k, col, ref;
+  uint8_t     *have;
+  char        *ckpName;
   double      gamma;
   Threads     *T;
+  MCKP        *CK;
 
   P = (Parameters *) Malloc(1 * sizeof(Parameters));
   if((P->help = ArgsState(DEFAULT_HELP, p, argc, "-h", "--help")) == 1 || argc < 2){
@@ -2171,6 +3566,14 @@ int32_t P_Inter(char **argv, int argc){
   P->level    = ArgsNum    (0, p, argc, "-l", MIN_LEV, MAX_LEV);
   P->nThreads = ArgsNum    (DEFAULT_THREADS, p, argc, "-n", MIN_THREADS,
   MAX_THREADS);
+  P->ram      = ArgsNum64  (DEFAULT_RAM,     p, argc, "-ram", 0, UINT64_MAX);
+  P->cache    = ArgsString (NULL,            p, argc, "-cache", "--cache");
+  P->resume   = ArgsState  (0,               p, argc, "-R", "--resume");
+  P->sketch   = ArgsDouble (DEFAULT_SKETCH,  p, argc, "-j");
+  if(P->sketch < 0 || P->sketch > 1){
+    fprintf(stderr, "  [x] Error: the sketch cutoff (-j) must be in [0;1]!\n");
+    exit(1);
+    }
 
   P->nModels = 0;
   for(n = 1 ; n < argc ; ++n)
@@ -2228,6 +3631,9 @@ int32_t P_Inter(char **argv, int argc){
       }
     }
 
+  if(P->cache != NULL && CreateModelCache(P->cache) != 0)
+    return EXIT_FAILURE;
+
   fprintf(stderr, "\n");
   if(P->verbose) PrintArgsInter(P, T[0]);
 
@@ -2238,21 +3644,30 @@ int32_t P_Inter(char **argv, int argc){
     P->matrix[n] = (double *) Calloc(P->nFiles, sizeof(double));
     }
 
-  if(P->nThreads > P->nFiles){
-    fprintf(stderr, "Error: the number of threads must not be higher than the "
-    "number of files\n");
-    exit(1);
-    }
+  if((uint64_t) P->nThreads > (uint64_t) P->nFiles * P->nFiles)
+    P->nThreads = P->nFiles * P->nFiles; // NO MORE THREADS THAN JOBS
+
+  // THE CELLS ARE KEPT IN <matrix>.ckp AS THEY END
+  have = (uint8_t *) Calloc((uint64_t) P->nFiles * P->nFiles, sizeof(uint8_t));
+  ckpName = concatenate(P->output, ".ckp");
+  CK = OpenMatrixCkp(ckpName, P->files, P->nFiles, ModelParamsHash(
+  MODEL_HASH_SEED ^ (uint64_t) (P->gamma * 65536), T[0].model, P->nModels, 
+  P->col), P->resume, P->matrix, have);
 
   fprintf(stderr, "==[ PROCESSING ]====================\n");
-  TIME *Time = CreateClock(clock());
-  for(n = 0 ; n < P->nFiles ; ++n){
-    CompressActionInter(T, n);
-    for(k = 0 ; k < P->nFiles ; ++k){
-      fprintf(stderr, "%.4lf\t", P->matrix[n][k]);
-      }
-    fprintf(stderr, "\n");
+  if(P->resume)
+    fprintf(stderr, "  [+] Resumed %"PRIu64" of %"PRIu64" cells from %s\n",
+    CK->resumed, (uint64_t) P->nFiles * P->nFiles, ckpName);
+  if(P->sketch > 0){
+    fprintf(stderr, "  [+] Sketching %u files ... ", P->nFiles);
+    fprintf(stderr, "Done! %"PRIu64" distant cells estimated.\n",
+    SketchScreen(have));
     }
+  TIME *Time = CreateClock(clock());
+  CompressActionInter(T, have, CK);
+  CloseMatrixCkp(CK);
+  Free(ckpName);
+  Free(have);
   StopTimeNDRM(Time, clock());
   fprintf(stderr, "\n");
 
@@ -2279,8 +3694,8 @@ int32_t P_Inter(char **argv, int argc){
   for(ref = 0 ; ref < P->nFiles ; ++ref)
     Free(T[ref].model);
   Free(T);
-  if(!OUTPUT) fclose(OUTPUT);
-  if(!LABELS) fclose(LABELS);
+  fclose(OUTPUT);
+  fclose(LABELS);
 
   return EXIT_SUCCESS;
   }
@@ -2288,6 +3703,7 @@ int32_t P_Inter(char **argv, int argc){
 int32_t P_Inter_Visual(char **argv, int argc){
   char        **p = *&argv;
   uint32_t    n;
+  uint64_t    tile;
   double      start, rotations, hue, gamma, width, space;
 
   P = (Parameters *) Malloc(1 * sizeof(Parameters));
@@ -2313,6 +3729,8 @@ int32_t P_Inter_Visual(char **argv, int argc){
   rotations   = ArgsDouble   (1.50,            p, argc, "-r");
   hue         = ArgsDouble   (1.92,            p, argc, "-u");
   gamma       = ArgsDouble   (0.50,            p, argc, "-g");
+  tile        = ArgsNum64    (0,               p, argc, "-tile", 0, 
+  UINT32_MAX);
 
   fprintf(stderr, "\n");
   if(P->verbose){
@@ -2327,6 +3745,8 @@ int32_t P_Inter_Visual(char **argv, int argc){
     fprintf(stderr, "  [+] Gamma ........................ %.3g\n", gamma);
     fprintf(stderr, "Input labels filename .............. %s\n",   P->labels);
     fprintf(stderr, "Output heatmap filename ............ %s\n",   P->image);
+    if(tile != 0)
+      fprintf(stderr, "Raster tile size ................... %"PRIu64"\n", tile);
     fprintf(stderr, "\n");
     }
 
@@ -2347,12 +3767,460 @@ int32_t P_Inter_Visual(char **argv, int argc){
   ReadMatrix(argv[argc-1]);
   fprintf(stderr, "Done!\n");
   fprintf(stderr, "  [+] Painting heatmap ... ");
-  PaintMatrix(start, rotations, hue, gamma, width, space);
+  PaintMatrix(start, rotations, hue, gamma, width, space, tile);
   fprintf(stderr, "Done!\n\n");
 
   return EXIT_SUCCESS;
   }
 
+//////////////////////////////////////////////////////////////////////////////
+// - - - - - - - - - - - - - - - - - S E R V E - - - - - - - - - - - - - - - -
+// LONG-RUNNING SERVER (serve): THE DATABASE IS PARSED ONCE AND KEPT PACKED IN
+// MEMORY (PACKDB), WITH THE OPTIONAL FROZEN MODELS OF -M. EACH JOB (A SAMPLE,
+// A LEVEL AND A TOP SIZE) IS A libfalcon CONTEXT THAT ONLY TRAINS THE SAMPLE
+// AND SCANS THE RESIDENT RECORDS WITH THE -n THREADS. THE JOBS RUN ONE AT A 
+// TIME; THE CONNECTIONS THAT ARRIVE MEANWHILE WAIT IN THE SOCKET BACKLOG. 
+// query IS THE CLIENT.
+
+typedef struct{
+  char     *name;             // .fcm file
+  FALCON   *F;
+  }
+FROZEN;
+
+typedef struct{
+  PACKDB   *D;
+  FROZEN   *Fz;               // Resident models (-M)
+  uint32_t nFrozen;
+  uint32_t level;             // Defaults of the jobs
+  uint32_t topSize;
+  FALCON   *F;                // Context of the running job
+  ORDER    *O;                // Records of the running job
+  }
+SERVER;
+
+typedef struct{
+  SERVER   *S;
+  uint32_t id;
+  }
+SERVEJOB;
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void *ServeScanThread(void *Sj){
+  SERVEJOB *J = (SERVEJOB *) Sj;
+  SERVER   *S = J->S;
+  FALCON   *F = S->F;
+  PACKDB   *D = S->D;
+  SCRATCH  *Sc = CreateScratch(F->M, F->nModels);
+  double   bits;
+  uint64_t i, nBase;
+  int64_t  r;
+
+  while((r = OrderClaim(S->O)) != -1){
+    ResetScratch(Sc);
+    bits = 0;
+    for(i = D->start[r] ; i < D->start[r+1] ; ++i)
+      bits += MixSymbol(Sc, F->M, PackDbBase(D, i), F->gamma);
+    nBase = D->start[r+1] - D->start[r];
+    FalconAddTop(F, J->id, BPBB(bits, nBase), (uint8_t *) GetString(
+    D->names, D->name[r]), nBase, D->db[r], D->rec[r]);
+    }
+
+  RemoveScratch(Sc);
+  return NULL;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// THE CONTEXT OF A JOB: FROZEN (-M), LOADED FROM A .fcm OR TRAINED WITH THE
+// LEVEL. RETURNS NULL (AFTER WRITING THE ERROR TO OUT) IF THE SAMPLE CANNOT
+// BE READ OR ITS MODELS DO NOT FIT. *owned TELLS IF THE CONTEXT MUST BE
+// REMOVED AFTER THE JOB.
+
+static FALCON *ServeModels(SERVER *S, FILE *OUT, char *sample, uint32_t 
+level, uint32_t topSize, uint8_t *owned){
+  char     *spec = GetLevels(level), *list, *file, *save;
+  uint32_t n, nModels, col;
+  FALCON   *F;
+
+  *owned = 0;
+  for(n = 0 ; n < S->nFrozen ; ++n)
+    if(strcmp(S->Fz[n].name, sample) == 0){
+      F = S->Fz[n].F;
+      Free(ParseSpec(spec, &nModels, &col, &F->gamma)); // GAMMA OF THE LEVEL
+      FalconResetTop(F, topSize);
+      return F;
+      }
+
+  *owned = 1;
+  if(ends_with(sample, ".fcm")){
+    if((F = FalconLoad(sample, spec, P->nThreads, topSize)) == NULL)
+      fprintf(OUT, "# error: cannot load the models %s\n", sample);
+    return F;
+    }
+
+  list = CloneString(sample);
+  for(file = strtok_r(list, ":", &save) ; file != NULL ; file = 
+  strtok_r(NULL, ":", &save))
+    if(access(file, R_OK) != 0){
+      fprintf(OUT, "# error: cannot read %s\n", file);
+      Free(list);
+      return NULL;
+      }
+  Free(list);
+
+  if((F = FalconCreate(spec, P->nThreads, topSize)) == NULL){
+    fprintf(OUT, "# error: the models of level %u do not fit in memory\n", 
+    level);
+    return NULL;
+    }
+  list = CloneString(sample);
+  for(file = strtok_r(list, ":", &save) ; file != NULL ; file = 
+  strtok_r(NULL, ":", &save))
+    FalconTrain(F, file);
+  Free(list);
+  return F;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// RUNS THE JOB "SAMPLE [LEVEL] [TOP]" AND STREAMS ITS ANSWER TO OUT
+
+static int ServeJob(SERVER *S, FILE *OUT, char *line){
+  char      *sample, *arg;
+  uint32_t  level = S->level, topSize = S->topSize, n;
+  uint8_t   owned;
+  double    t0 = WallClock(), t1;
+  pthread_t t[P->nThreads];
+  SERVEJOB  J[P->nThreads];
+  TOP       *Top;
+
+  if((sample = strtok(line, " \t\r")) == NULL){
+    fprintf(OUT, "# error: empty job\n");
+    return 1;
+    }
+  if((arg = strtok(NULL, " \t\r")) != NULL && atoi(arg) != 0)
+    level = atoi(arg);
+  if(arg != NULL && (arg = strtok(NULL, " \t\r")) != NULL && atoi(arg) != 0)
+    topSize = atoi(arg);
+  if(level < MIN_LEV || level > MAX_LEV || topSize < MIN_TOP || topSize > 
+  MAX_TOP){
+    fprintf(OUT, "# error: the level must be in [%u;%u] and the top in "
+    "[%u;%u]\n", MIN_LEV, MAX_LEV, MIN_TOP, MAX_TOP);
+    return 1;
+    }
+
+  fprintf(OUT, "# sample %s, level %u, top %u\n", sample, level, topSize);
+  fflush(OUT);
+  if((S->F = ServeModels(S, OUT, sample, level, topSize, &owned)) == NULL)
+    return 1;
+  t1 = WallClock();
+  fprintf(OUT, "# models ready: %u models in %.3lf s\n", S->F->nModels, t1 - 
+  t0);
+  fflush(OUT);
+
+  S->O = CreateOrder(S->D->nRecords);
+  for(n = 0 ; n < P->nThreads ; ++n){
+    J[n].S  = S;
+    J[n].id = n;
+    pthread_create(&(t[n]), NULL, ServeScanThread, (void *) &J[n]);
+    }
+  for(n = 0 ; n < P->nThreads ; ++n)
+    pthread_join(t[n], NULL);
+  RemoveOrder(S->O);
+
+  Top = FalconTop(S->F);
+  fprintf(OUT, "# scanned %"PRIu64" records in %.3lf s\n", S->D->nRecords,
+  WallClock() - t1);
+  #ifdef LOCAL_SIMILARITY
+  PrintTop(OUT, Top, topSize, P->dbFiles);
+  #else
+  PrintTop(OUT, Top, topSize);
+  #endif
+  DeleteTop(Top);
+
+  if(owned)
+    FalconRemove(S->F);
+  return 0;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+int32_t P_Serve(char **argv, int argc){
+  char     **p = *&argv, *sock, *frozen, *file, *save, *path;
+  char     line[SERVE_LINE];
+  uint32_t n, jobs = 0;
+  int      lfd, fd;
+  double   t0;
+  FILE     *OUT;
+  SERVER   S;
+
+  P = (Parameters *) Calloc(1, sizeof(Parameters));
+  if(ArgsState(DEFAULT_HELP, p, argc, "-h", "--help") == 1 || argc < 2){
+    PrintMenuServe();
+    Free(P);
+    return EXIT_SUCCESS;
+    }
+
+  memset(&S, 0, sizeof(SERVER));
+  P->verbose  = ArgsState  (DEFAULT_VERBOSE, p, argc, "-v", "--verbose");
+  S.level     = ArgsNum    (DEFAULT_LEVEL,   p, argc, "-l", MIN_LEV, MAX_LEV);
+  S.topSize   = ArgsNum    (DEF_TOP,         p, argc, "-t", MIN_TOP, MAX_TOP);
+  P->nThreads = ArgsNum    (DEFAULT_THREADS, p, argc, "-n", MIN_THREADS,
+  MAX_THREADS);
+  sock        = ArgsString (SERVE_SOCKET, p, argc, "-u", "--socket");
+  frozen      = ArgsString (NULL,         p, argc, "-M", "--models");
+  P->nDatabases = ReadDBFNames(P, argv[argc-1], 0);
+
+  fprintf(stderr, "==[ LOADING ]=======================\n");
+  t0 = WallClock();
+  if(frozen != NULL)
+    for(file = strtok_r(frozen, ":", &save) ; file != NULL ; file = 
+    strtok_r(NULL, ":", &save)){
+      S.Fz = (FROZEN *) Realloc(S.Fz, (S.nFrozen + 1) * sizeof(FROZEN), 
+      sizeof(FROZEN));
+      if((S.Fz[S.nFrozen].F = FalconLoad(file, GetLevels(S.level), 
+      P->nThreads, S.topSize)) == NULL){
+        fprintf(stderr, "  [x] Error: cannot load the models %s!\n", file);
+        exit(1);
+        }
+      path = realpath(file, NULL); // THE CLIENTS SEND ABSOLUTE PATHS
+      S.Fz[S.nFrozen].name = CloneString(path != NULL ? path : file);
+      free(path);
+      fprintf(stderr, "  [+] Frozen models %s\n", file);
+      ++S.nFrozen;
+      }
+  fprintf(stderr, "  [+] Packing %u database file(s) ... ", P->nDatabases);
+  S.D = CreatePackDb(P->dbFiles, P->nDatabases);
+  fprintf(stderr, "Done!\n");
+  fprintf(stderr, "      %"PRIu64" records, %"PRIu64" bases in %.3lf s\n", 
+  S.D->nRecords, S.D->nBases, WallClock() - t0);
+
+  lfd = ServeListen(sock);
+  signal(SIGPIPE, SIG_IGN); // A CLIENT THAT LEAVES DOES NOT STOP THE SERVER
+  fprintf(stderr, "==[ SERVING ]=======================\n");
+  fprintf(stderr, "  [+] Listening on %s\n", sock);
+
+  for(;;){
+    if((fd = ServeAccept(lfd)) < 0)
+      continue;
+    if(ReadJobLine(fd, line, SERVE_LINE) < 0){
+      close(fd);
+      continue;
+      }
+    if(strcmp(line, SERVE_STOP) == 0){
+      close(fd);
+      break;
+      }
+    if((OUT = fdopen(fd, "w")) == NULL){
+      close(fd);
+      continue;
+      }
+    t0 = WallClock();
+    if(P->verbose)
+      fprintf(stderr, "  [+] Job %u: %s\n", jobs + 1, line);
+    n = ServeJob(&S, OUT, line);
+    fclose(OUT);
+    fprintf(stderr, "  [+] Job %u %s in %.3lf s\n", ++jobs, n == 0 ? "done" 
+    : "failed", WallClock() - t0);
+    }
+
+  fprintf(stderr, "  [+] Stopped after %u jobs\n", jobs);
+  close(lfd);
+  unlink(sock);
+  for(n = 0 ; n < S.nFrozen ; ++n){
+    FalconRemove(S.Fz[n].F);
+    Free(S.Fz[n].name);
+    }
+  if(S.Fz != NULL)
+    Free(S.Fz);
+  RemovePackDb(S.D);
+  Free(P->dbFiles);
+  Free(P);
+  return EXIT_SUCCESS;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// CLIENT OF serve: THE SAMPLE FILES ARE SENT AS ABSOLUTE PATHS (THE SERVER 
+// MAY RUN IN ANOTHER DIRECTORY). THE '#' LINES GO TO stderr AND THE TOP TO
+// THE OUTPUT FILE (OR stdout).
+
+int32_t P_Query(char **argv, int argc){
+  char     **p = *&argv, *sock, *output, *sample, *file, *save, *path;
+  char     *line = NULL, *job;
+  size_t   lineSize = 0, jobSize;
+  uint32_t level, topSize;
+  int      fd, failed = 0;
+  FILE     *IN, *OUT = stdout;
+
+  if(ArgsState(DEFAULT_HELP, p, argc, "-h", "--help") == 1 || argc < 2){
+    PrintMenuQuery();
+    return EXIT_SUCCESS;
+    }
+
+  sock    = ArgsString (SERVE_SOCKET, p, argc, "-u", "--socket");
+  output  = ArgsString (NULL,         p, argc, "-x", "--output");
+  level   = ArgsNum    (0,            p, argc, "-l", MIN_LEV, MAX_LEV);
+  topSize = ArgsNum    (0,            p, argc, "-t", MIN_TOP, MAX_TOP);
+
+  if((fd = ServeConnect(sock)) < 0){
+    fprintf(stderr, "  [x] Error: no server is listening on %s!\n", sock);
+    return EXIT_FAILURE;
+    }
+
+  if(ArgsState(0, p, argc, "-q", "--quit")){
+    if(write(fd, SERVE_STOP "\n", strlen(SERVE_STOP) + 1) < 0)
+      failed = 1;
+    close(fd);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+  jobSize = 64;
+  job     = (char *) Calloc(jobSize, sizeof(char));
+  sample  = CloneString(argv[argc-1]);
+  for(file = strtok_r(sample, ":", &save) ; file != NULL ; file = 
+  strtok_r(NULL, ":", &save)){
+    if((path = realpath(file, NULL)) == NULL){
+      fprintf(stderr, "  [x] Error: cannot read %s!\n", file);
+      return EXIT_FAILURE;
+      }
+    job = (char *) Realloc(job, jobSize + strlen(path) + 1, strlen(path) + 1);
+    jobSize += strlen(path) + 1;
+    if(job[0] != '\0')
+      strcat(job, ":");
+    strcat(job, path);
+    free(path);
+    }
+  sprintf(job + strlen(job), " %u %u\n", level, topSize);
+  Free(sample);
+
+  if(write(fd, job, strlen(job)) != (ssize_t) strlen(job) || (IN = fdopen(fd,
+  "r")) == NULL){
+    fprintf(stderr, "  [x] Error: unable to send the job to %s!\n", sock);
+    return EXIT_FAILURE;
+    }
+  Free(job);
+  if(output != NULL)
+    OUT = Fopen(output, "w");
+
+  while(getline(&line, &lineSize, IN) != -1){
+    if(line[0] != '#'){
+      fputs(line, OUT);
+      continue;
+      }
+    if(strncmp(line, "# error", 7) == 0)
+      failed = 1;
+    fputs(line, stderr);
+    }
+
+  free(line);
+  fclose(IN);
+  if(OUT != stdout)
+    fclose(OUT);
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+  }
+
+
+//////////////////////////////////////////////////////////////////////////////
+// - - - - - - - - - - - - - - - - M E R G E - - - - - - - - - - - - - - - - -
+//
+// JOINS THE PARTIAL TOPS OF THE N SHARDS OF A meta RUN. EACH SHARD KEEPS THE
+// BEST topSize RECORDS OF ITS OWN RECORDS, SO THE BEST topSize OF THE UNION
+// ARE THE ONES OF THE WHOLE DATABASE, WITH THE SAME TIE ORDER (TopRec).
+
+int32_t P_Merge(char **argv, int argc){
+  char     **p = *&argv, *output, *list, *file, *save;
+  uint32_t n, x, k, nParts = 0, topSize;
+  uint8_t  *seen;
+  FTOP     **Part = NULL;
+  STRTAB   *Names;
+  TOP      *Top;
+  FILE     *OUT;
+
+  if(ArgsState(DEFAULT_HELP, p, argc, "-h", "--help") == 1 || argc < 2){
+    PrintMenuMerge();
+    return EXIT_SUCCESS;
+    }
+
+  output  = ArgsFileGen(p, argc, "-x", "top", ".csv");
+  topSize = ArgsNum    (0, p, argc, "-t", MIN_TOP, MAX_TOP);
+  if(!ArgsState(DEFAULT_FORCE, p, argc, "-F", "--force"))
+    FAccessWPerm(output);
+
+  Names = CreateStrTab();
+  list  = CloneString(argv[argc-1]);
+  for(file = strtok_r(list, ":", &save) ; file != NULL ; file = 
+  strtok_r(NULL, ":", &save)){
+    Part = (FTOP **) Realloc(Part, (nParts + 1) * sizeof(FTOP *), 
+    sizeof(FTOP *));
+    Part[nParts++] = ReadFtop(file, Names);
+    }
+  Free(list);
+
+  if(nParts == 0){
+    fprintf(stderr, "  [x] Error: no partial top was given!\n");
+    return EXIT_FAILURE;
+    }
+  if(Part[0]->nShards != nParts){
+    fprintf(stderr, "  [x] Error: the run has %u shards and %u partial tops "
+    "were given!\n", Part[0]->nShards, nParts);
+    return EXIT_FAILURE;
+    }
+  seen = (uint8_t *) Calloc(nParts, sizeof(uint8_t));
+  for(n = 0 ; n < nParts ; ++n){
+    if(Part[n]->key != Part[0]->key || Part[n]->nShards != nParts ||
+    Part[n]->topSize != Part[0]->topSize || Part[n]->nDb != Part[0]->nDb){
+      fprintf(stderr, "  [x] Error: the partial tops are not of the same run "
+      "(models, gamma, top or database)!\n");
+      return EXIT_FAILURE;
+      }
+    for(x = 0 ; x < Part[0]->nDb ; ++x)
+      if(strcmp(Part[n]->dbFiles[x], Part[0]->dbFiles[x]) != 0){
+        fprintf(stderr, "  [x] Error: the partial tops were computed with "
+        "other databases!\n");
+        return EXIT_FAILURE;
+        }
+    if(seen[Part[n]->shard]++ != 0){
+      fprintf(stderr, "  [x] Error: the shard %u/%u is given twice!\n",
+      Part[n]->shard + 1, nParts);
+      return EXIT_FAILURE;
+      }
+    }
+  Free(seen);
+
+  if(topSize == 0)
+    topSize = Part[0]->topSize;
+  if(topSize > Part[0]->topSize){
+    fprintf(stderr, "  [x] Error: the shards only kept a top of %u!\n",
+    Part[0]->topSize);
+    return EXIT_FAILURE;
+    }
+
+  Top = CreateTop(Part[0]->topSize * nParts, Names);
+  for(k = 0, n = 0 ; n < nParts ; ++n)
+    for(x = 0 ; x < Part[n]->nEntries ; ++x)
+      Top->V[k++] = Part[n]->V[x];
+  qsort(Top->V, k, sizeof(VT), SortByValue);
+
+  OUT = Fopen(output, "w");
+  #ifdef LOCAL_SIMILARITY
+  PrintTop(OUT, Top, topSize, Part[0]->dbFiles);
+  #else
+  PrintTop(OUT, Top, topSize);
+  #endif
+  fclose(OUT);
+  fprintf(stderr, "  [+] Merged %u partial tops (%u entries) in %s.\n", 
+  nParts, k, output);
+
+  DeleteTop(Top);
+  for(n = 0 ; n < nParts ; ++n)
+    RemoveFtop(Part[n]);
+  Free(Part);
+  DeleteStrTab(Names);
+  Free(output);
+  return EXIT_SUCCESS;
+  }
+
+
 //////////////////////////////////////////////////////////////////////////////
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 // - - - - - - - - - - - - - - - - - M A I N - - - - - - - - - - - - - - - - -
@@ -2382,6 +4250,9 @@ int32_t main(int argc, char *argv[])
     case K4: P_Filter_Visual                 (argv+1, argc-1);  break;
     case K5: P_Inter                         (argv+1, argc-1);  break;
     case K6: P_Inter_Visual                  (argv+1, argc-1);  break;
+    case K7: return P_Serve                  (argv+1, argc-1);
+    case K8: return P_Query                  (argv+1, argc-1);
+    case K9: return P_Merge                  (argv+1, argc-1);
 
     default:
       PrintWarning("unknown menu option!");
@@ -11,34 +11,148 @@
 #include "models.h"
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// WEIGHTED MEAN OF THE WINDOW CENTERED IN n, FROM THE ENTRIES (O(size))
 
-static ENTP Mean(FILTER *FIL, int64_t n){
+ENTP FilterMean(FILTER *FIL, int64_t n){
   int64_t k, s;
   ENTP sum = 0, wSum = 0, tmp;
   for(k = -FIL->size ; k <= FIL->size ; ++k){
     s = n+k;
     if(s >= 0 && s < FIL->nEntries){
-      sum  += (tmp= FIL->weights[FIL->size+k]) * FIL->entries[s];
+      sum  += (tmp= FIL->weights[FIL->size+k]) * FIL->entries[s % FIL->ring];
       wSum += tmp;
       }
     }
   return sum/wSum;
   }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// ADDS (sign = 1) OR REMOVES (sign = -1) THE ENTRY s FROM THE SLIDING SUMS
+
+static void SlideEntry(FILTER *FIL, int64_t s, ENTP sign){
+  ENTP *ph, x;
+  if(s < 0 || s >= FIL->nEntries)
+    return;
+  ph = &FIL->slide.phase[(s % (2*FIL->size+1)) << 2];
+  x  = sign * FIL->entries[s % FIL->ring];
+  FIL->slide.sum[0] += x;
+  FIL->slide.sum[1] += x * ph[0];
+  FIL->slide.sum[2] += x * ph[1];
+  FIL->slide.sum[3] += x * ph[2];
+  FIL->slide.sum[4] += x * ph[3];
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// RECOMPUTES THE SLIDING SUMS OF THE WINDOW CENTERED IN n (O(size))
+
+void ResyncSlide(FILTER *FIL, int64_t n){
+  int64_t s;
+  memset(FIL->slide.sum, 0, 5 * sizeof(ENTP));
+  for(s = n - FIL->size ; s <= n + FIL->size ; ++s)
+    SlideEntry(FIL, s, 1);
+  FIL->slide.center = n;
+  FIL->slide.steps  = 0;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// MOVES THE WINDOW ONE POSITION FORWARD, TO THE CENTER n
+
+void SlideTo(FILTER *FIL, int64_t n){
+  SLIDE *S = &FIL->slide;
+  if(S->steps >= SLIDE_RESYNC){
+    ResyncSlide(FIL, n);
+    return;
+    }
+  SlideEntry(FIL, n - 1 - FIL->size, -1);
+  SlideEntry(FIL, n + FIL->size, 1);
+  S->center = n;
+  ++S->steps;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// WEIGHTED MEAN OF THE WINDOW CENTERED IN n, FROM THE SLIDING SUMS. VALUES TOO
+// CLOSE TO THE THRESHOLD ARE RECOMPUTED WITH FilterMean, SO THAT ROUNDING CAN
+// NOT CHANGE THE SEGMENTS.
+
+ENTP SlideMean(FILTER *FIL, int64_t n){
+  SLIDE   *S = &FIL->slide;
+  ENTP    *ph, sum, wSum, val;
+  int64_t lo, hi;
+
+  ph   = &S->phase[(n % (2*FIL->size+1)) << 2];
+  sum  = S->a[0] * S->sum[0] + S->a[1] * (ph[0] * S->sum[1] + ph[1] * 
+  S->sum[2]) + S->a[2] * (ph[2] * S->sum[3] + ph[3] * S->sum[4]);
+  lo   = n - FIL->size < 0 ? 0 : n - FIL->size;
+  hi   = n + FIL->size >= FIL->nEntries ? FIL->nEntries - 1 : n + FIL->size;
+  wSum = S->wAcc[hi - n + FIL->size + 1] - S->wAcc[lo - n + FIL->size];
+  val  = sum / wSum;
+
+  if(fabs(val - FIL->threshold) < SLIDE_EPS)
+    return FilterMean(FIL, n);
+  return val;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// READS THE PROFILE UNTIL THE ENTRY n (OR ITS END). THE RING KEEPS THE LAST 
+// 2 size + 2 ENTRIES, WHICH IS ALL THE WINDOW NEEDS.
+
+static void LoadEntries(FILTER *FIL, int64_t n){
+  SymValue SM;
+  int      c;
+  uint8_t  sym, value;
+  if(FIL->FB != NULL){
+    while(FIL->loaded <= n && FIL->loaded < FIL->nEntries){
+      FalbNext(FIL->FB, &sym, &value);
+      FIL->bases  [FIL->loaded % FIL->ring] = sym;
+      FIL->entries[FIL->loaded % FIL->ring] = (ENTP) value * 0.25;
+      ++FIL->loaded;
+      }
+    return;
+    }
+  while(FIL->loaded <= n && FIL->loaded < FIL->nEntries){
+    c = getc(FIL->IN);
+    if(c == EOF || c == '\n'){
+      fprintf(stderr, "  [x] Error: filtering symbols larger than size!");
+      exit(1);
+      }
+    UnPackByte(&SM, c);
+    FIL->bases  [FIL->loaded % FIL->ring] = (uint8_t) SM.sym;
+    FIL->entries[FIL->loaded % FIL->ring] = (ENTP)    SM.value * 0.25;
+    ++FIL->loaded;
+    }
+  }
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 void FilterStream(FILTER *FIL, FILE *OUT){
   int64_t  n = 1;
-  ENTP     val = Mean(FIL, 0);
-  int      region = val < FIL->threshold ? LOW_REGION : HIGH_REGION, cmp = 0;
+  ENTP     val;
+  int      region, cmp = 0;
   uint64_t initPosition = 1;
   uint64_t lastPosition = n;
+
+  if(FIL->nEntries == 0)
+    return;
+
+  LoadEntries(FIL, FIL->size);
+  ResyncSlide(FIL, 0);
+  val    = SlideMean(FIL, 0);
+  region = val < FIL->threshold ? LOW_REGION : HIGH_REGION;
+  if(region == LOW_REGION)
+    ResetSelfSim(FIL->SS, 0);
+
+  // THE BASES OF A LOW REGION ARE FED TO THE SELF-SIMILARITY MODEL AS THE 
+  // WINDOW MOVES: AT CENTER n, THE BASE n-1 (THE REGION [init, n] IS 1-BASED)
   for(n = 1 ; n < FIL->nEntries ; ++n){
+    LoadEntries(FIL, n + FIL->size);
+    SlideTo(FIL, n);
+    if(region == LOW_REGION)
+      FeedSelfSim(FIL->SS, FIL->bases[(n-1) % FIL->ring]);
     if(n % FIL->drop == 0){
-      if((val = Mean(FIL, n)) >= FIL->threshold){
+      if((val = SlideMean(FIL, n)) >= FIL->threshold){
         if(region == LOW_REGION){
           region = HIGH_REGION;
-          cmp = SelfSimilarity(FIL->bases, initPosition, n);
+          cmp = SelfSimClass(FIL->SS);
           fprintf(OUT, "%"PRIu64":%"PRIu64"\t%u\n", initPosition, n, cmp);
           }
         }
@@ -46,13 +160,16 @@ void FilterStream(FILTER *FIL, FILE *OUT){
         if(region == HIGH_REGION){
           region       = LOW_REGION;
           initPosition = n;
+          ResetSelfSim(FIL->SS, 0);
+          FeedSelfSim(FIL->SS, FIL->bases[(n-1) % FIL->ring]);
           }
         }
       lastPosition = n;
       }
     }
   if(region == LOW_REGION){
-    cmp = SelfSimilarity(FIL->bases, initPosition, n);
+    FeedSelfSim(FIL->SS, FIL->bases[(n-1) % FIL->ring]);
+    cmp = SelfSimClass(FIL->SS);
     fprintf(OUT, "%"PRIu64":%"PRIu64"\t%u\n", initPosition, lastPosition, cmp);
     }
   }
@@ -61,6 +178,13 @@ void FilterStream(FILTER *FIL, FILE *OUT){
 
 void InitWeights(FILTER *FIL){
   int64_t k, sizedb = 2 * FIL->size + 1;
+  ENTP    *a = FIL->slide.a;
+  switch(FIL->type){
+    case W_HAMMING:     a[0] = 0.54; a[1] = 0.46; a[2] = 0;    break;
+    case W_HANN:        a[0] = 0.5;  a[1] = 0.5;  a[2] = 0;    break;
+    case W_BLACKMAN:    a[0] = 0.42; a[1] = 0.5;  a[2] = 0.08; break;
+    case W_RECTANGULAR: a[0] = 1;    a[1] = 0;    a[2] = 0;    break;
+    }
   switch(FIL->type){
     case W_HAMMING:
       for(k = -FIL->size ; k <= FIL->size ; ++k)
@@ -80,37 +204,37 @@ void InitWeights(FILTER *FIL){
         FIL->weights[FIL->size+k] = 1;
     break;
     }
+
+  FIL->slide.wAcc[0] = 0;
+  for(k = 0 ; k < sizedb ; ++k){
+    FIL->slide.wAcc[k+1] = FIL->slide.wAcc[k] + FIL->weights[k];
+    FIL->slide.phase[(k<<2)]   = cos((2 * M_PI * k) / sizedb);
+    FIL->slide.phase[(k<<2)+1] = sin((2 * M_PI * k) / sizedb);
+    FIL->slide.phase[(k<<2)+2] = cos((4 * M_PI * k) / sizedb);
+    FIL->slide.phase[(k<<2)+3] = sin((4 * M_PI * k) / sizedb);
+    }
   }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+// ATTACHES THE PROFILE OF nEntries THAT STARTS AT THE CURRENT POSITION OF 
+// INPUT. ITS ENTRIES ARE READ WHILE IT IS FILTERED.
+
 void InitEntries(FILTER *FIL, uint64_t nEntries, FILE *INPUT){
-  int c;
-  uint64_t idx;
-  SymValue *SM  = Calloc(1, sizeof(SymValue));
   FIL->nEntries = nEntries;
-  FIL->entries  = (ENTP    *) Malloc(FIL->nEntries * sizeof(ENTP   )); 
-  FIL->bases    = (uint8_t *) Malloc(FIL->nEntries * sizeof(uint8_t)); 
-  for(idx = 0 ; idx < FIL->nEntries ; ++idx){
-    c = fgetc(INPUT);
-    if(c == EOF || c == '\n'){
-      fprintf(stderr, "  [x] Error: filtering symbols larger than size!");
-      exit(1);
-      }
-    UnPackByte(SM, c);
-    FIL->bases  [idx] = (uint8_t) SM->sym;
-    FIL->entries[idx] = (ENTP)    SM->value * 0.25;
-    }
-  Free(SM);
+  FIL->IN       = INPUT;
+  FIL->FB       = NULL;
+  FIL->loaded   = 0;
   }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// SAME, FOR A PROFILE OF A .falb FILE (FB IS ALREADY AT ITS FIRST BLOCK)
 
-void DeleteEntries(FILTER *FIL){
-  Free(FIL->entries);
-  Free(FIL->bases);
-  FIL->entries = NULL;
-  FIL->bases   = NULL;
+void InitEntriesFalb(FILTER *FIL, uint64_t nEntries, FALBSTREAM *FB){
+  FIL->nEntries = nEntries;
+  FIL->IN       = NULL;
+  FIL->FB       = FB;
+  FIL->loaded   = 0;
   }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -123,9 +247,15 @@ threshold){
   FIL->type      = type;
   FIL->threshold = threshold;
   FIL->weights   = (ENTP *) Malloc((2*FIL->size+1) * sizeof(ENTP));
+  FIL->slide.phase = (ENTP *) Malloc(4*(2*FIL->size+1) * sizeof(ENTP));
+  FIL->slide.wAcc  = (ENTP *) Malloc((2*FIL->size+2) * sizeof(ENTP));
   InitWeights(FIL);
-  FIL->entries   = NULL;
-  FIL->bases     = NULL;
+  FIL->ring      = 2*FIL->size+2;
+  FIL->entries   = (ENTP    *) Malloc(FIL->ring * sizeof(ENTP   ));
+  FIL->bases     = (uint8_t *) Malloc(FIL->ring * sizeof(uint8_t));
+  FIL->IN        = NULL;
+  FIL->FB        = NULL;
+  FIL->SS        = CreateSelfSim();
   return FIL;
   }
 
@@ -133,10 +263,11 @@ threshold){
 
 void DeleteFilter(FILTER *FIL){
   Free(FIL->weights);
-  if(FIL->entries != NULL)
-    Free(FIL->entries);
-  if(FIL->bases   != NULL)
-    Free(FIL->bases);
+  Free(FIL->slide.phase);
+  Free(FIL->slide.wAcc);
+  Free(FIL->entries);
+  Free(FIL->bases);
+  RemoveSelfSim(FIL->SS);
   Free(FIL);
   }
 
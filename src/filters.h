@@ -1,8 +1,11 @@
 #ifndef FILTERS_H_INCLUDED
 #define FILTERS_H_INCLUDED
 
+#include <stdio.h>
 #include "defs.h"
 #include "param.h"
+#include "models.h"
+#include "falb.h"
 
 #define W_HAMMING     0
 #define W_HANN        1
@@ -11,19 +14,44 @@
 #define LOW_REGION    0
 #define HIGH_REGION   1
 
+#define SLIDE_RESYNC  65536   // Steps between exact recomputations of the sums
+#define SLIDE_EPS     1e-9    // Near the threshold, use the direct weighted mean
+
 typedef double ENTP;
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// THE WINDOWS ARE COSINE SUMS w(k) = a0 + a1 cos(wk) + a2 cos(2wk), WITH
+// w = 2 PI / (2 size + 1). SINCE cos(w(s-n)) = cos(ws)cos(wn) + sin(ws)sin(wn),
+// THE WEIGHTED SUM AROUND n IS OBTAINED FROM FIVE SLIDING SUMS OF THE ENTRIES
+// (PLAIN AND MULTIPLIED BY cos/sin OF ws AND 2ws), UPDATED IN O(1) PER BASE.
+
+typedef struct{
+  ENTP     a[3];     // Cosine-sum coefficients of the window
+  ENTP     *phase;   // cos(ws), sin(ws), cos(2ws), sin(2ws) for s mod (2size+1)
+  ENTP     *wAcc;    // Prefix sums of the weights (for the profile edges)
+  ENTP     sum[5];   // Sliding sums over the entries inside the window
+  int64_t  center;
+  int64_t  steps;    // Since the last exact recomputation
+  }
+SLIDE;
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 typedef struct{
   int64_t  size;
   int64_t  drop;
   int64_t  nEntries;
-  ENTP     *entries;
-  uint8_t  *bases;
+  int64_t  loaded;   // Entries already read from IN
+  int64_t  ring;     // Entries kept in memory: 2 size + 2
+  ENTP     *entries; // Ring of the last entries read
+  uint8_t  *bases;   // Ring of their bases
+  FILE     *IN;
+  FALBSTREAM *FB;    // Instead of IN, for .falb profiles
   ENTP     *weights;
   double   threshold;
   uint8_t  type;
+  SSModel  *SS;      // Reused by the self-similarity of every region
+  SLIDE    slide;
   }
 FILTER;
 
@@ -32,9 +60,13 @@ FILTER;
 FILTER   *CreateFilter      (uint64_t, uint64_t, uint8_t, double);
 void     InitWeights        (FILTER *);
 void     InitEntries        (FILTER *, uint64_t, FILE *);
+void     InitEntriesFalb    (FILTER *, uint64_t, FALBSTREAM *);
 void     DeleteFilter       (FILTER *);
-void     DeleteEntries      (FILTER *);
 void     FilterStream       (FILTER *, FILE *);
+ENTP     FilterMean         (FILTER *, int64_t);
+void     ResyncSlide        (FILTER *, int64_t);
+void     SlideTo            (FILTER *, int64_t);
+ENTP     SlideMean          (FILTER *, int64_t);
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
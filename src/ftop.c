@@ -0,0 +1,167 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ftop.h"
+#include "strtab.h"
+#include "common.h"
+#include "mem.h"
+
+#define FTOP_HEAD      32     // Bytes of the file header (up to N_DB)
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void PutU32(FILE *F, uint32_t x){
+  uint8_t b[4] = { x, x >> 8, x >> 16, x >> 24 };
+  fwrite(b, 1, 4, F);
+  }
+
+static void PutU64(FILE *F, uint64_t x){
+  PutU32(F, (uint32_t) x);
+  PutU32(F, (uint32_t) (x >> 32));
+  }
+
+static uint32_t LoadU32(uint8_t *b){
+  return b[0] | (uint32_t) b[1] << 8 | (uint32_t) b[2] << 16 |
+  (uint32_t) b[3] << 24;
+  }
+
+static uint64_t LoadU64(uint8_t *b){
+  return LoadU32(b) | (uint64_t) LoadU32(b + 4) << 32;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void PutName(FILE *F, char *name){
+  uint32_t len = strlen(name);
+  PutU32(F, len);
+  fwrite(name, 1, len, F);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// READS A NAME_LEN(4) NAME FIELD IN A NEW STRING, NULL IF IT IS TRUNCATED
+
+static char *LoadName(FILE *F){
+  uint8_t  b[4];
+  uint32_t len;
+  char     *name;
+
+  if(fread(b, 1, 4, F) != 4 || (len = LoadU32(b)) >= MAX_NAME)
+    return NULL;
+  name = (char *) Calloc(len + 1, sizeof(char));
+  if(fread(name, 1, len, F) != len){
+    Free(name);
+    return NULL;
+    }
+  return name;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// WRITES THE FIRST n ENTRIES OF Top (SORTED). THE EMPTY SLOTS ARE LEFT OUT.
+
+void WriteFtop(char *name, TOP *Top, uint32_t n, uint64_t key, uint32_t
+topSize, uint32_t shard, uint32_t nShards, char **dbFiles, uint32_t nDb){
+  FILE     *F = Fopen(name, "wb");
+  uint64_t bits;
+  uint32_t x, nEntries;
+  uint8_t  head[8] = { 'F', 'T', 'O', 'P', FTOP_VERSION, 0, 0, 0 };
+
+  for(nEntries = 0, x = 0 ; x < n ; ++x)
+    if(Top->V[x].rec != TOP_NO_REC)
+      ++nEntries;
+
+  fwrite(head, 1, 8, F);
+  PutU64(F, key);
+  PutU32(F, topSize);
+  PutU32(F, shard);
+  PutU32(F, nShards);
+  PutU32(F, nDb);
+  for(x = 0 ; x < nDb ; ++x)
+    PutName(F, dbFiles[x]);
+
+  PutU32(F, nEntries);
+  for(x = 0 ; x < n ; ++x){
+    if(Top->V[x].rec == TOP_NO_REC)
+      continue;
+    memcpy(&bits, &Top->V[x].value, 8);
+    PutU64(F, bits);
+    PutU64(F, Top->V[x].size);
+    PutU64(F, Top->V[x].rec);
+    PutU32(F, Top->V[x].dbIndex);
+    PutName(F, TopName(Top, x));
+    }
+
+  if(ferror(F) || fclose(F) != 0){
+    fprintf(stderr, "  [x] Error: unable to write %s!\n", name);
+    exit(1);
+    }
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void Corrupt(char *name){
+  fprintf(stderr, "  [x] Error: the partial top %s is corrupted!\n", name);
+  exit(1);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// READS A PARTIAL TOP. THE HEADERS OF THE ENTRIES ARE INTERNED IN names.
+
+FTOP *ReadFtop(char *name, STRTAB *names){
+  FILE     *F = Fopen(name, "rb");
+  FTOP     *T = (FTOP *) Calloc(1, sizeof(FTOP));
+  uint8_t  head[FTOP_HEAD], b[28];
+  uint64_t bits;
+  uint32_t x;
+  char     *str;
+
+  if(fread(head, 1, FTOP_HEAD, F) != FTOP_HEAD || memcmp(head, FTOP_MAGIC, 4)
+  != 0 || head[4] != FTOP_VERSION){
+    fprintf(stderr, "  [x] Error: %s is not a partial top!\n", name);
+    exit(1);
+    }
+  T->key     = LoadU64(head + 8);
+  T->topSize = LoadU32(head + 16);
+  T->shard   = LoadU32(head + 20);
+  T->nShards = LoadU32(head + 24);
+  T->nDb     = LoadU32(head + 28);
+  if(T->nShards == 0 || T->shard >= T->nShards || T->nDb > MAX_STR)
+    Corrupt(name);
+
+  T->dbFiles = (char **) Calloc(T->nDb + 1, sizeof(char *));
+  for(x = 0 ; x < T->nDb ; ++x)
+    if((T->dbFiles[x] = LoadName(F)) == NULL)
+      Corrupt(name);
+
+  if(fread(b, 1, 4, F) != 4 || (T->nEntries = LoadU32(b)) > T->topSize)
+    Corrupt(name);
+  T->V = (VT *) Calloc(T->nEntries + 1, sizeof(VT));
+  for(x = 0 ; x < T->nEntries ; ++x){
+    if(fread(b, 1, 28, F) != 28)
+      Corrupt(name);
+    bits = LoadU64(b);
+    memcpy(&T->V[x].value, &bits, 8);
+    T->V[x].size    = LoadU64(b + 8);
+    T->V[x].rec     = LoadU64(b + 16);
+    T->V[x].dbIndex = LoadU32(b + 24);
+    if(T->V[x].dbIndex >= T->nDb || (str = LoadName(F)) == NULL)
+      Corrupt(name);
+    T->V[x].name = InternString(names, str);
+    Free(str);
+    }
+
+  fclose(F);
+  return T;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void RemoveFtop(FTOP *T){
+  uint32_t x;
+  for(x = 0 ; x < T->nDb ; ++x)
+    Free(T->dbFiles[x]);
+  Free(T->dbFiles);
+  Free(T->V);
+  Free(T);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
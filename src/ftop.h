@@ -0,0 +1,45 @@
+#ifndef FTOP_H_INCLUDED
+#define FTOP_H_INCLUDED
+
+#include <stdio.h>
+#include "defs.h"
+#include "top.h"
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// PARTIAL TOP OF A SHARD (.ftop), WRITTEN BY meta --shard AND READ BY merge.
+// ALL INTEGERS ARE LITTLE ENDIAN.
+//
+//   FILE  : "FTOP" VERSION(1) 0(3) KEY(8) TOP(4) SHARD(4) N_SHARDS(4)
+//           N_DB(4) DB... N_ENTRIES(4) ENTRY...
+//   DB    : NAME_LEN(4) NAME                           (DATABASE FILE)
+//   ENTRY : VALUE(8, DOUBLE) SIZE(8) REC(8) DB(4) NAME_LEN(4) NAME
+//
+// KEY HASHES THE MODELS AND GAMMA, AS IN THE INTER CHECKPOINT. THE ENTRIES
+// KEEP THEIR RECORD KEY (TopRec), SO THE MERGED TOP HAS THE SAME TIE ORDER
+// AS AN UNSHARDED RUN.
+
+#define FTOP_MAGIC     "FTOP"
+#define FTOP_VERSION   1
+
+typedef struct{
+  uint64_t key;
+  uint32_t topSize;
+  uint32_t shard;             // From 0
+  uint32_t nShards;
+  uint32_t nDb;
+  char     **dbFiles;
+  uint32_t nEntries;
+  VT       *V;                // The names are ids of the table of ReadFtop
+  }
+FTOP;
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void        WriteFtop       (char *, TOP *, uint32_t, uint64_t, uint32_t,
+                            uint32_t, uint32_t, char **, uint32_t);
+FTOP        *ReadFtop       (char *, STRTAB *);
+void        RemoveFtop      (FTOP *);
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#endif
@@ -13,6 +13,9 @@
 #define K4  4
 #define K5  5
 #define K6  6
+#define K7  7
+#define K8  8
+#define K9  9
 
 typedef struct
   {
@@ -28,7 +31,10 @@ static K_STRUCT LT_KEYS[] =
     { "filter"        , K3  },  // Filter and segment regions identified by FALCON
     { "fvisual"       , K4  },  // Create visualization of filtered regions
     { "inter"         , K5  },  // Evaluate similarity of genomes
-    { "ivisual"       , K6  }   // Create heatmap visualization of genome similarities
+    { "ivisual"       , K6  },  // Create heatmap visualization of genome similarities
+    { "serve"         , K7  },  // Keep the database resident and answer jobs
+    { "query"         , K8  },  // Send a job to a running server
+    { "merge"         , K9  }   // Merge the partial tops of the shards
   };
 
 #define NKEYS (sizeof(LT_KEYS)/sizeof(K_STRUCT))
@@ -8,61 +8,63 @@
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 SLABELS *CreateSLabels(void){
-  uint32_t n;
   SLABELS *SL = (SLABELS *) Calloc(1, sizeof(SLABELS));
   SL->idx     = 0;
-  SL->maxV    = SLCACHE;
   SL->maxH    = SLMAXSTR;
-  SL->names   = (uint8_t **) Calloc(SL->maxV, sizeof(uint8_t *));
-  for(n = 0 ; n < SL->maxV ; ++n)
-    SL->names[n] = (uint8_t *) Calloc(SL->maxH+1, sizeof(uint8_t));
+  SL->names   = CreateStrTab();
   return SL;
   }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-void AddSLabel(SLABELS *SL, char *str){
+static void LowerLabel(SLABELS *SL, char *dst, char *str){
   uint32_t n;
-  char c;
-  for(n = 0 ; n < SL->maxH ; ++n){
-    if((c = str[n]) == '\0')
-      break;
-    SL->names[SL->idx][n] = tolower(c);  
-    }
-  SL->names[SL->idx][n] = '\0';
+  for(n = 0 ; n < SL->maxH && str[n] != '\0' ; ++n)
+    dst[n] = tolower(str[n]);
+  dst[n] = '\0';
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void AddSLabel(SLABELS *SL, char *str){
+  char low[SL->maxH+1];
+  LowerLabel(SL, low, str);
+  InternString(SL->names, low);
   SL->idx++;
   }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// NOTHING TO DO: THE TABLE GROWS WHEN A LABEL IS ADDED.
 
 void UpdateSLabels(SLABELS *SL){
-  uint32_t n;
-  if(SL->idx == SL->maxV){
-    SL->maxV += SLCACHE;
-    SL->names = (uint8_t **) 
-    Realloc(SL->names, SL->maxV * sizeof(uint8_t *), 0);
-    for(n = SL->idx ; n < SL->maxV ; ++n)
-      SL->names[n] = (uint8_t *) Calloc(SL->maxH+1, sizeof(uint8_t));
-    }
+  (void) SL;
   }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 int SearchSLabels(SLABELS *SL, char *str){
-  uint32_t n;
-  for(n = 0 ; n < SL->idx ; ++n)
-    if(Strcasecmp(SL->names[n], str) == 0)
-      return 1;
-  return 0;
+  char low[SL->maxH+1];
+  LowerLabel(SL, low, str);
+  return FindString(SL->names, low) < 0 ? 0 : 1;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+char *LastSLabel(SLABELS *SL){
+  return GetString(SL->names, SL->names->nStr - 1);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// LABEL n (FROM 0, IN THE ORDER THEY WERE ADDED). ID 0 IS THE EMPTY STRING.
+
+char *GetSLabel(SLABELS *SL, uint32_t n){
+  return GetString(SL->names, n + 1);
   }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 void DeleteSLabels(SLABELS *SL){
-  uint32_t n;
-  for(n = 0 ; n < SL->maxV ; ++n)
-    Free(SL->names[n]);
-  Free(SL->names);
+  DeleteStrTab(SL->names);
   Free(SL);
   }
 
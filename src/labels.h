@@ -3,6 +3,7 @@
 
 #include "defs.h"
 #include "common.h"
+#include "strtab.h"
 #include <stdlib.h>
 #include <stdio.h>
 
@@ -12,9 +13,8 @@
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 typedef struct{
-  uint8_t  **names;
+  STRTAB   *names;  // Lowercase labels, interned
   uint32_t maxH;
-  uint32_t maxV;
   uint32_t idx;
   }
 SLABELS;
@@ -25,6 +25,8 @@ SLABELS    *CreateSLabels  (void);
 void       AddSLabel       (SLABELS *, char *);
 void       UpdateSLabels   (SLABELS *);
 int        SearchSLabels   (SLABELS *, char *);
+char       *LastSLabel     (SLABELS *);
+char       *GetSLabel      (SLABELS *, uint32_t);
 void       DeleteSLabels   (SLABELS *);
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
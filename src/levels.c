@@ -4,7 +4,7 @@
 #include "levels.h"
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-// GET PARAMETERS FROM LEVELS
+// GET PARAMETERS FROM LEVELS (NULL IF THE LEVEL DOES NOT EXIST)
 //
 char *GetLevels(uint8_t l){
   switch(l){
@@ -55,8 +55,7 @@ char *GetLevels(uint8_t l){
     case 45: return LEVEL_45;
     case 46: return LEVEL_46;
     case 47: return LEVEL_47;
-    default: fprintf(stderr, "[x] Unknown level!\n");
-    exit(1);
+    default: return NULL;
     }
   }
 
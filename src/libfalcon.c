@@ -0,0 +1,421 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "libfalcon.h"
+#include "serialization.h"
+#include "file_compression.h"
+#include "scratch.h"
+#include "parser.h"
+#include "buffer.h"
+#include "common.h"
+#include "mem.h"
+
+typedef struct{
+  FALCON   *F;
+  char     *db;
+  uint32_t dbIdx;
+  uint32_t id;
+  }
+FSCAN;
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// THE MODELS, COLLISIONS AND GAMMA OF A SPEC (GAMMA ROUNDED AS IN meta).
+// RETURNS NULL IF THERE IS NO SPEC OR A MODEL OR THE COLLISIONS ARE OUT OF
+// RANGE.
+
+ModelPar *ParseSpec(char *spec, uint32_t *nModels, uint32_t *col, double
+*gamma){
+  char     **xargv = NULL, *s;
+  int32_t  xargc, n, bad = 0;
+  ModelPar *MP;
+  uint32_t k = 0;
+
+  *nModels = 0;
+  if(spec == NULL) // AN UNKNOWN LEVEL
+    return NULL;
+  s     = concatenate(" ", spec); // xargv[0] IS SKIPPED
+  xargc = StrToArgv(s, &xargv);
+  *col     = MAX_COLLISIONS;
+  *gamma   = DEFAULT_GAMMA;
+  for(n = 1 ; n < xargc - 1 ; ++n){
+    if(strcmp(xargv[n], "-m") == 0) *nModels += 1;
+    if(strcmp(xargv[n], "-c") == 0) *col      = atoi(xargv[n+1]);
+    if(strcmp(xargv[n], "-g") == 0) *gamma    = atof(xargv[n+1]);
+    }
+  *gamma = ((int) (*gamma * 65536)) / 65536.0;
+  if(*col < 1 || *col > 253)
+    bad = 1;
+
+  MP = (ModelPar *) Calloc(*nModels + 1, sizeof(ModelPar));
+  for(n = 1 ; n < xargc - 1 ; ++n)
+    if(strcmp(xargv[n], "-m") == 0 && ParseModel(xargv[n+1], &MP[k++]) != 0)
+      bad = 1;
+
+  Free(xargv[0]);
+  Free(xargv);
+  Free(s);
+  if(bad){
+    Free(MP);
+    *nModels = 0;
+    return NULL;
+    }
+  return MP;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// THE (REFERENCE) MODELS OF THE PARAMETERS. RETURNS NULL, WITH NOTHING LEFT
+// ALLOCATED, IF THEIR COUNTERS DO NOT FIT IN MEMORY.
+
+CModel **CreateModels(ModelPar *MP, uint32_t nModels, uint32_t col){
+  CModel   **M = (CModel **) Malloc((nModels + 1) * sizeof(CModel *));
+  uint32_t n;
+
+  for(n = 0 ; n < nModels ; ++n)
+    if((M[n] = CreateCModel(MP[n].ctx, MP[n].den, MP[n].ir, REFERENCE, col,
+    MP[n].edits, MP[n].eDen)) == NULL){
+      while(n--)
+        FreeCModel(M[n]);
+      Free(M);
+      return NULL;
+      }
+  return M;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void TrainSym(CModel **M, uint32_t nModels, CBUF *symBuf, uint8_t sym,
+uint64_t idx){
+  uint32_t n;
+  uint8_t  irSym = 0;
+
+  symBuf->buf[symBuf->idx] = sym;
+  for(n = 0 ; n < nModels ; ++n){
+    CModel *CM = M[n];
+    GetPModelIdx(symBuf->buf+symBuf->idx-1, CM);
+    if(CM->ir == 1) // INVERTED REPEATS
+      irSym = GetPModelIdxIR(symBuf->buf+symBuf->idx, CM);
+    if(idx >= CM->ctx){
+      UpdateCModelCounter(CM, sym, CM->pModelIdx);
+      if(CM->ir == 1) // INVERTED REPEATS
+        UpdateCModelCounter(CM, irSym, CM->pModelIdxIR);
+      }
+    }
+  UpdateCBuffer(symBuf);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// TRAINS THE MODELS WITH A (FASTA, FASTQ OR SEQUENCE) FILE. RETURNS THE 
+// NUMBER OF BASES.
+
+uint64_t TrainModels(CModel **M, uint32_t nModels, char *fName){
+  FILE     *Reader = CFopen(fName, "r");
+  uint32_t n;
+  uint64_t idx = 0, k, idxPos, bases = 0;
+  PARSER   *PA = CreateParser();
+  CBUF     *symBuf = CreateCBuffer(BUFFER_SIZE, BGUARD);
+  uint8_t  *readBuf = (uint8_t *) Calloc(BUFFER_SIZE, sizeof(uint8_t)), sym;
+
+  FileType(PA, Reader);
+  rewind(Reader);
+
+  while((k = fread(readBuf, 1, BUFFER_SIZE, Reader)))
+    for(idxPos = 0 ; idxPos < k ; ++idxPos){
+      if(ParseSym(PA, (sym = readBuf[idxPos])) == -1){
+        idx = 0;
+        continue;
+        }
+      TrainSym(M, nModels, symBuf, DNASymToNum(sym), idx++);
+      ++bases;
+      }
+
+  for(n = 0 ; n < nModels ; ++n)
+    ResetCModelIdx(M[n]);
+  RemoveCBuffer(symBuf);
+  Free(readBuf);
+  RemoveParser(PA);
+  fclose(Reader);
+  return bases;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static FALCON *CreateFalcon(uint32_t nThreads, uint32_t topSize){
+  FALCON *F = (FALCON *) Calloc(1, sizeof(FALCON));
+  F->nThreads = nThreads == 0 ? 1 : nThreads;
+  FalconResetTop(F, topSize);
+  return F;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// RETURNS NULL IF THE SPEC IS NOT VALID OR ITS MODELS DO NOT FIT IN MEMORY
+
+FALCON *FalconCreate(char *spec, uint32_t nThreads, uint32_t topSize){
+  FALCON   *F = CreateFalcon(nThreads, topSize);
+  ModelPar *MP = ParseSpec(spec, &F->nModels, &F->col, &F->gamma);
+
+  if(MP == NULL || (F->M = CreateModels(MP, F->nModels, F->col)) == NULL){
+    if(MP != NULL)
+      Free(MP);
+    F->nModels = 0; // NO MODEL TO FREE
+    FalconRemove(F);
+    return NULL;
+    }
+  Free(MP);
+  return F;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// A CONTEXT WITH MODELS THAT ARE ALREADY TRAINED OR LOADED (AS meta BUILDS
+// THEM). THE CONTEXT OWNS THEM: FalconRemove FREES THEM.
+
+FALCON *FalconBind(CModel **M, uint32_t nModels, uint32_t col, double gamma,
+uint32_t nThreads, uint32_t topSize){
+  FALCON *F = CreateFalcon(nThreads, topSize);
+  F->M       = M;
+  F->nModels = nModels;
+  F->col     = col;
+  F->gamma   = gamma;
+  return F;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// A CONTEXT WITH THE MODELS OF A .fcm (THE SPEC ONLY GIVES GAMMA). RETURNS
+// NULL IF THE FILE CANNOT BE LOADED OR THE SPEC IS NOT VALID.
+
+FALCON *FalconLoad(char *fcm, char *spec, uint32_t nThreads, uint32_t
+topSize){
+  FALCON   *F;
+  ModelPar *MP;
+  uint32_t nModels, col;
+  double   gamma;
+
+  if(access(fcm, R_OK) != 0)
+    return NULL;
+  F = CreateFalcon(nThreads, topSize);
+  if(LoadModels(fcm, &F->M, &F->nModels, &F->col) != 0){
+    F->nModels = 0;
+    FalconRemove(F);
+    return NULL;
+    }
+  if((MP = ParseSpec(spec, &nModels, &col, &gamma)) == NULL){
+    FalconRemove(F);
+    return NULL;
+    }
+  F->gamma = gamma;
+  Free(MP);
+  return F;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+int FalconSave(FALCON *F, char *fcm){
+  return SaveModels(fcm, F->M, F->nModels, F->col);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// RETURNS -1 IF THE FILE CANNOT BE READ
+
+int FalconTrain(FALCON *F, char *fName){
+  if(access(fName, R_OK) != 0)
+    return -1;
+  TrainModels(F->M, F->nModels, fName);
+  return 0;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// TRAINS WITH A SEQUENCE IN MEMORY (ASCII BASES, NO HEADERS)
+
+void FalconTrainSeq(FALCON *F, uint8_t *seq, uint64_t len){
+  CBUF     *symBuf = CreateCBuffer(BUFFER_SIZE, BGUARD);
+  uint64_t i;
+  uint32_t n;
+
+  for(i = 0 ; i < len ; ++i)
+    TrainSym(F->M, F->nModels, symBuf, DNASymToNum(seq[i]), i);
+  for(n = 0 ; n < F->nModels ; ++n)
+    ResetCModelIdx(F->M[n]);
+  RemoveCBuffer(symBuf);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// SCORES A RECORD (ASCII BASES, THE ONES OUTSIDE ACGT ARE IGNORED). RETURNS
+// THE TOP VALUE (BPBB) AND THE NUMBER OF BASES IN *nBase.
+
+double FalconScore(FALCON *F, uint8_t *seq, uint64_t len, uint64_t *nBase){
+  SCRATCH  *S = CreateScratch(F->M, F->nModels);
+  double   bits = 0;
+  uint64_t i;
+  uint8_t  sym;
+
+  for(*nBase = 0, i = 0 ; i < len ; ++i)
+    if((sym = DNASymToNum(seq[i])) != 4){
+      bits += MixSymbol(S, F->M, sym, F->gamma);
+      ++*nBase;
+      }
+
+  RemoveScratch(S);
+  return BPBB(bits, *nBase);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// ADDS A SCORED RECORD (INDEX rec OF THE DATABASE dbIdx) TO THE TOP id
+
+void FalconAddTop(FALCON *F, uint32_t id, double value, uint8_t *name,
+uint64_t nBase, uint32_t dbIdx, uint64_t rec){
+  F->tops[id]->rec = TopRec(dbIdx, rec);
+  UpdateTopWithDB(value, name, F->tops[id], nBase, dbIdx);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// THE RECORD SPLIT OF EVERY SCAN: FEEDS A SYMBOL OF A (MULTI-)FASTA FILE TO
+// THE PARSER AND KEEPS THE HEADER OF THE RECORD IN name, WITH *r SYMBOLS (THE
+// SPACES AND NON-PRINTABLE SYMBOLS AS '_', THE LEADING ONES DROPPED). RETURNS
+// THE ParseMF ACTION: -1 AT A NEW HEADER (name STILL HOLDS THE LAST ONE), -2
+// OR -3 IN A HEADER, -99 AT A LINE BREAK OR AN EXTRA SYMBOL, ELSE THE SYMBOL.
+
+int FalconParse(PARSER *PA, uint8_t sym, uint8_t *name, uint32_t *r){
+  int32_t action = ParseMF(PA, sym);
+
+  switch(action){
+    case -1: *r = 0; break; // IT IS THE BEGGINING OF THE HEADER
+    case -2: name[*r] = '\0'; break; // IT IS THE '\n' HEADER END
+    case -3: // IF IS A SYMBOL OF THE HEADER
+      if(*r >= MAX_NAME-1)
+        name[*r] = '\0';
+      else if(sym == ' ' || sym < 32 || sym > 126){ // PROTECT INTERVAL
+        if(*r != 0)
+          name[(*r)++] = '_'; // PROTECT OUT SYM WITH UNDERL
+        }
+      else
+        name[(*r)++] = sym;
+    break;
+    }
+  return action;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// EACH THREAD READS THE DATABASE AND SCORES THE RECORDS i WITH i % nThreads
+// == id (meta ADDS SHARDS, CHUNKS AND PROFILES TO THE SAME SPLIT)
+
+static void *ScanThread(void *Fs){
+  FSCAN    *J = (FSCAN *) Fs;
+  FALCON   *F = J->F;
+  FILE     *Reader = CFopen(J->db, "r");
+  PARSER   *PA = CreateParser();
+  SCRATCH  *S = CreateScratch(F->M, F->nModels);
+  uint8_t  *readBuf = (uint8_t *) Calloc(BUFFER_SIZE, sizeof(uint8_t));
+  uint8_t  sym, conName[MAX_NAME];
+  uint64_t nBase = 0;
+  uint32_t k, idxPos, r = 0;
+  double   bits = 0;
+  int      action;
+
+  conName[0] = '\0';
+  while((k = fread(readBuf, 1, BUFFER_SIZE, Reader)))
+    for(idxPos = 0 ; idxPos < k ; ++idxPos){
+      if((action = FalconParse(PA, readBuf[idxPos], conName, &r)) < 0){
+        if(action == -1){ // A NEW RECORD: THE LAST ONE IS DONE
+          if((PA->nRead-1) % F->nThreads == J->id && PA->nRead>1 && nBase>1)
+            FalconAddTop(F, J->id, BPBB(bits, nBase), conName, nBase,
+            J->dbIdx, PA->nRead-1);
+          ResetScratch(S);
+          nBase = bits = 0;
+          }
+        continue;
+        }
+      if(PA->nRead % F->nThreads != J->id)
+        continue;
+      if((sym = DNASymToNum(action)) == 4)
+        continue; // IT IGNORES EXTRA SYMBOLS
+      bits += MixSymbol(S, F->M, sym, F->gamma);
+      ++nBase;
+      }
+
+  if(PA->nRead % F->nThreads == J->id && nBase > 0)
+    FalconAddTop(F, J->id, BPBB(bits, nBase), conName, nBase, J->dbIdx,
+    PA->nRead);
+
+  RemoveScratch(S);
+  Free(readBuf);
+  RemoveParser(PA);
+  fclose(Reader);
+  return NULL;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// SCANS A DATABASE FILE (INDEX dbIdx IN THE TOP) WITH THE nThreads OF THE
+// CONTEXT. RETURNS -1 IF IT CANNOT BE READ.
+
+int FalconScan(FALCON *F, char *db, uint32_t dbIdx){
+  pthread_t t[F->nThreads];
+  FSCAN     J[F->nThreads];
+  uint32_t  n;
+
+  if(access(db, R_OK) != 0)
+    return -1;
+  for(n = 0 ; n < F->nThreads ; ++n){
+    J[n].F     = F;
+    J[n].db    = db;
+    J[n].dbIdx = dbIdx;
+    J[n].id    = n;
+    pthread_create(&(t[n]), NULL, ScanThread, (void *) &J[n]);
+    }
+  for(n = 0 ; n < F->nThreads ; ++n)
+    pthread_join(t[n], NULL);
+  return 0;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// THE TOP OF ALL THE THREADS, SORTED. IT SHARES THE NAMES OF THE CONTEXT, SO
+// IT MUST BE DELETED BEFORE FalconResetTop OR FalconRemove.
+
+TOP *FalconTop(FALCON *F){
+  TOP      *Top = CreateTop(F->topSize * F->nThreads, F->names);
+  uint32_t n, e, x = 0;
+
+  for(n = 0 ; n < F->nThreads ; ++n)
+    for(e = 0 ; e < F->tops[n]->size-1 ; ++e)
+      Top->V[x++] = F->tops[n]->V[e]; // THE NAMES ARE SHARED BY ID
+  qsort(Top->V, x, sizeof(VT), SortByValue);
+  return Top;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// EMPTIES THE TOPS (FOR A NEW SAMPLE WITH THE SAME MODELS)
+
+void FalconResetTop(FALCON *F, uint32_t topSize){
+  uint32_t n;
+
+  if(F->tops != NULL){
+    for(n = 0 ; n < F->nThreads ; ++n)
+      DeleteTop(F->tops[n]);
+    Free(F->tops);
+    DeleteStrTab(F->names);
+    }
+  F->topSize = topSize;
+  F->names   = CreateStrTab();
+  F->tops    = (TOP **) Malloc(F->nThreads * sizeof(TOP *));
+  for(n = 0 ; n < F->nThreads ; ++n)
+    F->tops[n] = CreateTop(topSize, F->names);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void FalconRemove(FALCON *F){
+  uint32_t n;
+
+  for(n = 0 ; n < F->nModels ; ++n)
+    FreeCModel(F->M[n]);
+  if(F->M != NULL)
+    Free(F->M);
+  for(n = 0 ; n < F->nThreads ; ++n)
+    DeleteTop(F->tops[n]);
+  Free(F->tops);
+  DeleteStrTab(F->names);
+  Free(F);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -0,0 +1,68 @@
+#ifndef LIBFALCON_H_INCLUDED
+#define LIBFALCON_H_INCLUDED
+
+#include <stdio.h>
+#include "defs.h"
+#include "models.h"
+#include "param.h"
+#include "parser.h"
+#include "strtab.h"
+#include "top.h"
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// LIBRARY API (libfalcon.a): ALL THE STATE OF AN ANALYSIS IS IN ITS FALCON
+// CONTEXT, SO SEVERAL CONTEXTS CAN LIVE IN ONE PROCESS. THE FLOW IS
+//
+//   F = FalconCreate(GetLevels(47), nThreads, topSize);
+//   FalconTrain(F, "reads.fq");                 (OR FalconTrainSeq)
+//   FalconScan(F, "db.fa", 0);                  (OR FalconScore + FalconAddTop)
+//   Top = FalconTop(F);  ...  DeleteTop(Top);
+//   FalconRemove(F);
+//
+// A SPEC IS A LIST OF OPTIONS AS THE LEVELS: "-m 12:20:1:0/0 -c 30 -g 0.9".
+// ONCE TRAINED, THE MODELS ARE ONLY READ: FalconScore MAY BE CALLED BY MANY
+// THREADS AT ONCE, AND FalconAddTop BY ONE THREAD PER TOP (id < nThreads).
+// meta SCANS WITH THE SAME CONTEXT (FalconBind OVER THE MODELS IT BUILDS)
+// AND THE SAME RECORD SPLIT (FalconParse).
+//
+// THE LIBRARY DOES NOT EXIT: A BAD SPEC, A FILE THAT CANNOT BE READ OR
+// WRITTEN, OR MODELS THAT DO NOT FIT IN MEMORY RETURN NULL OR A NEGATIVE
+// VALUE. A SMALL ALLOCATION THAT FAILS CALLS THE SetMemFail HANDLER (mem.h),
+// WHICH EXITS UNLESS THE CALLER SETS ITS OWN.
+
+typedef struct{
+  CModel   **M;
+  uint32_t nModels;
+  uint32_t col;
+  double   gamma;
+  uint32_t nThreads;
+  uint32_t topSize;
+  STRTAB   *names;            // Headers of the top entries
+  TOP      **tops;            // Of each thread
+  }
+FALCON;
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+ModelPar   *ParseSpec      (char *, uint32_t *, uint32_t *, double *);
+CModel     **CreateModels  (ModelPar *, uint32_t, uint32_t);
+uint64_t   TrainModels     (CModel **, uint32_t, char *);
+FALCON     *FalconCreate   (char *, uint32_t, uint32_t);
+FALCON     *FalconBind     (CModel **, uint32_t, uint32_t, double, uint32_t,
+                           uint32_t);
+FALCON     *FalconLoad     (char *, char *, uint32_t, uint32_t);
+int        FalconSave      (FALCON *, char *);
+int        FalconTrain     (FALCON *, char *);
+void       FalconTrainSeq  (FALCON *, uint8_t *, uint64_t);
+double     FalconScore     (FALCON *, uint8_t *, uint64_t, uint64_t *);
+void       FalconAddTop    (FALCON *, uint32_t, double, uint8_t *, uint64_t,
+                           uint32_t, uint64_t);
+int        FalconParse    (PARSER *, uint8_t, uint8_t *, uint32_t *);
+int        FalconScan      (FALCON *, char *, uint32_t);
+TOP        *FalconTop      (FALCON *);
+void       FalconResetTop  (FALCON *, uint32_t);
+void       FalconRemove    (FALCON *);
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#endif
@@ -2,30 +2,58 @@
 #include "defs.h"
 #include <math.h>
 #include <stdlib.h>
+#include <stdatomic.h>
 
-static uint64_t totalMemory = 0;
+// THE THREADS ALLOCATE AT ONCE (SCRATCHES, TOPS, PROFILES), SO THE COUNTER IS
+// ATOMIC. IT IS ONLY A TALLY, HENCE THE RELAXED ORDER.
+
+static _Atomic uint64_t totalMemory = 0;
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void MemFailExit(size_t size){
+  fprintf(stderr, "Error allocating %zu bytes.\n", size);
+  exit(1);
+  }
+
+// THE HANDLER IS SET BEFORE ANY THREAD STARTS (SEE mem.h)
+
+static MEMFAIL memFail = MemFailExit;
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void SetMemFail(MEMFAIL handler){
+  memFail = handler == NULL ? MemFailExit : handler;
+  }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 void *Malloc(size_t size){
   void *pointer = malloc(size);
   if(pointer == NULL){
-    fprintf(stderr, "Error allocating %zu bytes.\n", size);
-    exit(1);
+    memFail(size);
+    return NULL;
     }
-  totalMemory += size;
+  atomic_fetch_add_explicit(&totalMemory, size, memory_order_relaxed);
   return pointer;
   }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 void *Calloc(size_t nmemb, size_t size){
+  void *pointer = TryCalloc(nmemb, size);
+  if(pointer == NULL)
+    memFail(nmemb * size);
+  return pointer;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void *TryCalloc(size_t nmemb, size_t size){
   void *pointer = calloc(nmemb, size);
-  if(pointer == NULL){
-    fprintf(stderr, "Error allocating %zu bytes.\n", size);
-    exit(1);
-    }
-  totalMemory += nmemb * size;
+  if(pointer != NULL)
+    atomic_fetch_add_explicit(&totalMemory, nmemb * size, 
+    memory_order_relaxed);
   return pointer;
   }
 
@@ -34,10 +62,10 @@ void *Calloc(size_t nmemb, size_t size){
 void *Realloc(void *ptr, size_t size, size_t addSize){
   void *pointer = realloc(ptr, size);	
   if(pointer == NULL){
-    fprintf(stderr, "Error allocating %zu bytes.\n", size);
-    exit(1);
+    memFail(size);
+    return NULL;
     }
-  totalMemory += addSize;
+  atomic_fetch_add_explicit(&totalMemory, addSize, memory_order_relaxed);
   return pointer;
   }
 
@@ -50,7 +78,7 @@ void Free(void *ptr){
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 uint64_t TotalMemory(){
-  return totalMemory;
+  return atomic_load_explicit(&totalMemory, memory_order_relaxed);
   }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -4,12 +4,23 @@
 #include <stdio.h>
 #include <stdint.h>
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// A FAILED Malloc, Calloc OR Realloc CALLS THE MEMFAIL HANDLER WITH THE SIZE.
+// THE DEFAULT ONE PRINTS IT AND ENDS THE PROGRAM; A PROGRAM THAT EMBEDS THE 
+// LIBRARY MAY SET ITS OWN (E.G. A longjmp OUT OF THE REQUEST). IF THE HANDLER
+// RETURNS, THE CALL RETURNS NULL. TryCalloc NEVER CALLS IT: THE MODEL TABLES
+// (THE LARGE BLOCKS) USE IT AND THEIR CALLERS GET THE NULL.
+
+typedef void (*MEMFAIL)(size_t);
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 void     *Malloc      (size_t);
 void     *Calloc      (size_t, size_t);
+void     *TryCalloc   (size_t, size_t);
 void     *Realloc     (void *, size_t, size_t);
 void     Free         (void *);
+void     SetMemFail   (MEMFAIL);
 uint64_t TotalMemory  (void);
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -22,23 +22,46 @@ static uint64_t ZHASH(uint64_t z){
   }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// THE BUCKETS ARE CUT FROM ONE SLAB (entries[0]), SO A HASH MODEL COSTS
+// EXACTLY WHAT CModelBytes SAYS, WITHOUT A malloc HEADER PER BUCKET. RETURNS
+// -1 (NOTHING ALLOCATED) IF THEY DO NOT FIT IN MEMORY.
 
-static void InitHashTable(CModel *M, U32 c){ 
+int InitHashBuckets(HashTable *H){
   uint32_t k;
+  Entry    *slab;
+  if((slab = (Entry *) TryCalloc((size_t) HASH_SIZE * H->maxC, 
+  sizeof(Entry))) == NULL)
+    return -1;
+  if((H->entries = (Entry **) TryCalloc(HASH_SIZE, sizeof(Entry *))) == NULL){
+    Free(slab);
+    return -1;
+    }
+  H->entries[0] = slab;
+  for(k = 1 ; k < HASH_SIZE ; ++k)
+    H->entries[k] = H->entries[k-1] + H->maxC;
+  return 0;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static int InitHashTable(CModel *M, U32 c){ 
   M->hTable.maxC    = c;
-  M->hTable.index   = (ENTMAX *) Calloc(HASH_SIZE, sizeof(ENTMAX));
-  M->hTable.entries = (Entry **) Calloc(HASH_SIZE, sizeof(Entry *));
-  for(k = 0 ; k < HASH_SIZE ; ++k)
-    M->hTable.entries[k] = (Entry *) Calloc(M->hTable.maxC, sizeof(Entry));
+  if((M->hTable.index = (ENTMAX *) TryCalloc(HASH_SIZE, sizeof(ENTMAX))) == 
+  NULL)
+    return -1;
+  if(InitHashBuckets(&M->hTable) != 0){
+    Free(M->hTable.index);
+    return -1;
+    }
+  return 0;
   }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 void FreeCModel(CModel *M){
-  U32 k;
   if(M->mode == HASH_TABLE_MODE){
-    for(k = 0 ; k < HASH_SIZE ; ++k)
-      Free(M->hTable.entries[k]);
+    if(M->hTable.entries != NULL) // NULL: A LOAD THAT FAILED
+      Free(M->hTable.entries[0]);
     Free(M->hTable.entries);
     Free(M->hTable.index);
     }
@@ -63,8 +86,9 @@ void FreeShadow(CModel *M){
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-static void InitArray(CModel *M){
-  M->array.counters = (ACC *) Calloc(M->nPModels<<2, sizeof(ACC));
+static int InitArray(CModel *M){
+  M->array.counters = (ACC *) TryCalloc(M->nPModels<<2, sizeof(ACC));
+  return M->array.counters == NULL ? -1 : 0;
   }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -98,7 +122,9 @@ void GetFreqsFromHCC(HCC c, uint32_t a, PModel *P){
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-void GetHCCounters(HashTable *H, U64 key, PModel *P, uint32_t a){
+// RETURNS 1 IF THE KEY IS IN THE TABLE, 0 IF THE UNIFORM COUNTS ARE USED
+
+int GetHCCounters(HashTable *H, U64 key, PModel *P, uint32_t a){
   U32 n, hIndex = key % HASH_SIZE;
   #if defined(PREC32B)
   U32 b = key & 0xffffffff;
@@ -113,14 +139,14 @@ void GetHCCounters(HashTable *H, U64 key, PModel *P, uint32_t a){
   for(n = pos+1 ; n-- ; ){
     if(H->entries[hIndex][n].key == b){
       GetFreqsFromHCC(H->entries[hIndex][n].counters, a, P);
-      return;
+      return 1;
       }
     }
   // FROM MAX_COLISIONS TO INDEX
   for(n = (H->maxC-1) ; n > pos ; --n){
     if(H->entries[hIndex][n].key == b){
       GetFreqsFromHCC(H->entries[hIndex][n].counters, a, P);
-      return;
+      return 1;
       }
     }
 
@@ -130,7 +156,7 @@ void GetHCCounters(HashTable *H, U64 key, PModel *P, uint32_t a){
   P->freqs[2] = 1;
   P->freqs[3] = 1;
   P->sum      = 4; 
-  return;
+  return 0;
   }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -151,10 +177,19 @@ void UpdateCModelCounter(CModel *M, U32 sym, U64 im){
     U8  b = idx & 0xff;
     #endif
 
+    #ifdef HASH_STATS
+    ++M->stats.updates;
+    #endif
     for(n = 0 ; n < M->hTable.maxC ; ++n){
       if(M->hTable.entries[hIndex][n].key == b){
+        #ifdef HASH_STATS
+        ++M->stats.hits;
+        #endif
         sc = (M->hTable.entries[hIndex][n].counters>>(sym<<2))&0x0f;
         if(sc == 15){ // IT REACHES THE MAXIMUM COUNTER: RENORMALIZE
+          #ifdef HASH_STATS
+          ++M->stats.renorms;
+          #endif
           for(s = 0 ; s < 4 ; ++s){ // RENORMALIZE EACH AND STORE
             counter = ((M->hTable.entries[hIndex][n].counters>>(s<<2))&0x0f)>>1;
             M->hTable.entries[hIndex][n].counters &= ~(0x0f<<(s<<2));
@@ -170,11 +205,23 @@ void UpdateCModelCounter(CModel *M, U32 sym, U64 im){
         }
       }
 
+    #ifdef HASH_STATS
+    ++M->stats.inserts;
+    if(M->hTable.entries[hIndex][(M->hTable.index[hIndex] + 1) % 
+    M->hTable.maxC].counters != 0) // A USED ENTRY IS NEVER ALL ZEROS
+      ++M->stats.evictions;
+    #endif
     InsertKey(&M->hTable, hIndex, b, sym); // KEY NOT FOUND: WRITE ON OLDEST
     }
   else{
     AC = &M->array.counters[idx << 2];
+    #ifdef HASH_STATS
+    ++M->stats.updates;
+    #endif
     if(++AC[sym] == M->maxCount){    
+      #ifdef HASH_STATS
+      ++M->stats.renorms;
+      #endif
       AC[0] >>= 1;
       AC[1] >>= 1;
       AC[2] >>= 1;
@@ -184,19 +231,43 @@ void UpdateCModelCounter(CModel *M, U32 sym, U64 im){
   }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// BYTES THAT CreateCModel ALLOCATES FOR A MODEL OF ORDER ctx WITH col 
+// COLLISIONS (THE COUNTERS, WITHOUT THE SUBSTITUTION BUFFERS)
+
+uint64_t CModelBytes(U32 ctx, U32 col){
+  if(ctx >= HASH_TABLE_BEGIN_CTX)
+    return (uint64_t) HASH_SIZE * (sizeof(ENTMAX) + sizeof(Entry *) + 
+    (uint64_t) col * sizeof(Entry));
+  return ((uint64_t) pow(ALPHABET_SIZE, ctx) << 2) * sizeof(ACC);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// ALL THE BYTES OF A MODEL: THE STRUCTURE, THE COUNTERS AND, FOR A TOLERANT
+// MODEL (edits != 0), ITS SUBSTITUTION BUFFERS
+
+uint64_t CModelTotalBytes(U32 ctx, U32 col, U32 edits){
+  uint64_t bytes = sizeof(CModel) + CModelBytes(ctx, col);
+  if(edits != 0)
+    bytes += sizeof(CBUF) + BUFFER_SIZE + BGUARD + BGUARD;
+  return bytes;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// RETURNS NULL IF THE CONTEXT IS OUT OF [1;MAX_HASH_CTX] OR IF THE COUNTERS
+// DO NOT FIT IN MEMORY
 
 CModel *CreateCModel(U32 ctx, U32 aDen, U32 ir, U8 ref, U32 col, U32 edits, 
 U32 eDen){
-  CModel *M = (CModel *) Calloc(1, sizeof(CModel));
+  CModel *M;
   U64    prod = 1, *mult;
   U32    n;
+  int    fail;
 
-  if(ctx > MAX_HASH_CTX){
-    fprintf(stderr, "Error: context size cannot be greater than %d\n", 
-    MAX_HASH_CTX);
-    exit(1);
-    }
+  if(ctx == 0 || ctx > MAX_HASH_CTX)
+    return NULL;
 
+  M              = (CModel *) Calloc(1, sizeof(CModel));
   mult           = (U64 *) Calloc(ctx, sizeof(U64));
   M->nPModels    = (U64) pow(ALPHABET_SIZE, ctx);
   M->ctx         = ctx;
@@ -210,12 +281,17 @@ U32 eDen){
   if(ctx >= HASH_TABLE_BEGIN_CTX){
     M->mode     = HASH_TABLE_MODE;
     M->maxCount = DEFAULT_MAX_COUNT >> 8;
-    InitHashTable(M, col);
+    fail        = InitHashTable(M, col);
     }
   else{
     M->mode     = ARRAY_MODE;
     M->maxCount = DEFAULT_MAX_COUNT;
-    InitArray(M);
+    fail        = InitArray(M);
+    }
+  if(fail){
+    Free(mult);
+    Free(M);
+    return NULL;
     }
 
   for(n = 0 ; n < M->ctx ; ++n){
@@ -267,6 +343,36 @@ CModel *CreateShadowModel(CModel *XP){
   return M;
   }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// SAME AS CreateShadowModel, BUT ALL THE MEMORY BELONGS TO THE ARENA.
+
+CModel *CreateShadowModelIn(ARENA *A, CModel *XP){
+  CModel *M = (CModel *) ArenaCalloc(A, 1, sizeof(CModel));
+   
+  M->nPModels    = XP->nPModels;
+  M->ctx         = XP->ctx;
+  M->alphaDen    = XP->alphaDen;
+  M->edits       = XP->edits;
+  M->pModelIdx   = XP->pModelIdx;
+  M->pModelIdxIR = XP->pModelIdxIR;
+  M->ir          = XP->ir;
+  M->ref         = XP->ref;
+  M->mode        = XP->mode;
+  M->maxCount    = XP->maxCount;
+  M->multiplier  = XP->multiplier;
+
+  if(M->edits != 0){
+    M->SUBS.seq       = CreateCBufferIn(A, BUFFER_SIZE, BGUARD);
+    M->SUBS.in        = XP->SUBS.in;
+    M->SUBS.idx       = XP->SUBS.idx;
+    M->SUBS.mask      = (uint8_t *) ArenaCalloc(A, BGUARD, sizeof(uint8_t));
+    M->SUBS.threshold = XP->SUBS.threshold;
+    M->SUBS.eDen      = XP->SUBS.eDen;
+    }
+
+  return M;
+  }
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 void ResetCModelIdx(CModel *M){
@@ -279,13 +385,10 @@ void ResetCModelIdx(CModel *M){
 void ResetShadowModel(CModel *M){
   ResetCModelIdx(M);
   if(M->edits != 0){
-    RemoveCBuffer(M->SUBS.seq);
-    M->SUBS.seq = CreateCBuffer(BUFFER_SIZE, BGUARD);
+    ResetCBuffer(M->SUBS.seq);
     M->SUBS.in  = 0;
     M->SUBS.idx = 0;
-    uint32_t n;
-    for(n = 0 ; n < BGUARD ; ++n)
-      M->SUBS.mask[n] = 0;
+    memset(M->SUBS.mask, 0, BGUARD * sizeof(uint8_t));
     }
   }
 
@@ -387,11 +490,14 @@ void CorrectXModels(CModel **Shadow, PModel **PM, uint8_t sym, uint32_t nm){
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-void ComputePModel(CModel *M, PModel *P, uint64_t idx, uint32_t aDen){
+// RETURNS 0 WHEN THE CONTEXT WAS NEVER TRAINED: NOT IN THE TABLE OF A HASH
+// MODEL OR (ONLY COUNTED WITH HASH_STATS) WITH ZERO COUNTERS IN AN ARRAY
+
+int ComputePModel(CModel *M, PModel *P, uint64_t idx, uint32_t aDen){
   ACC *ac;
   switch(M->mode){
     case HASH_TABLE_MODE:
-      GetHCCounters(&M->hTable, ZHASH(idx), P, aDen);
+      return GetHCCounters(&M->hTable, ZHASH(idx), P, aDen);
     break;
     case ARRAY_MODE:
       ac = &M->array.counters[idx<<2];
@@ -400,57 +506,220 @@ void ComputePModel(CModel *M, PModel *P, uint64_t idx, uint32_t aDen){
       P->freqs[2] = 1 + aDen * ac[2]; // +1 IS NOT NEEDED BECAUSE THERE IS NO AC
       P->freqs[3] = 1 + aDen * ac[3]; // +1 IS NOT NEEDED BECAUSE THERE IS NO AC
       P->sum = P->freqs[0] + P->freqs[1] + P->freqs[2] + P->freqs[3];
+      #ifdef HASH_STATS // A CONTEXT WITH ZERO COUNTERS WAS NEVER TRAINED
+      return (ac[0] | ac[1] | ac[2] | ac[3]) != 0;
+      #endif
     break;
-    default:
-    fprintf(stderr, "Error: not implemented!\n");
-    exit(1);
     }
+  return 1;
   }
 
+#ifdef HASH_STATS
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-int SelfSimilarity(uint8_t *seq, uint64_t init, uint64_t end){
-  uint64_t n, bases = 0;
-  double   bits = 0;
-  CBUF     *symBuf  = CreateCBuffer(BUFFER_SIZE, BGUARD);
-  uint8_t  *readBuf = Calloc(BUFFER_SIZE, sizeof(uint8_t));
-  uint8_t  sym, irSym = 0;
-  CModel   *CM = CreateCModel(13, 10, 1, 1, 0, 0, 0);
-  PModel   *PM = CreatePModel(ALPHABET_SIZE);
-  
-  for(n = init-1 ; n < end ; ++n){
-    symBuf->buf[symBuf->idx] = sym = seq[n];
+static double Pct(U64 a, U64 b){
+  return b == 0 ? 0 : 100.0 * a / b;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// PRINTS THE TRAINING EVENTS OF MODEL id AND HOW FULL IT IS: THE SHARE OF 
+// THE USED CONTEXTS OF AN ARRAY, OR THE HISTOGRAM OF THE KEYS PER BUCKET OF 
+// A HASH TABLE (A USED ENTRY NEVER HAS ALL ITS COUNTERS AT ZERO)
+
+void PrintHashStats(FILE *F, CModel *M, uint32_t id){
+  HashStats *S = &M->stats;
+  U64       k, used, *hist;
+  U32       n, c;
+
+  if(M->mode == ARRAY_MODE){
+    for(used = 0, k = 0 ; k < M->nPModels ; ++k)
+      if(M->array.counters[k<<2] | M->array.counters[(k<<2)+1] | 
+      M->array.counters[(k<<2)+2] | M->array.counters[(k<<2)+3])
+        ++used;
+    fprintf(F, "Model %u (array, order %u):\n", id, M->ctx);
+    fprintf(F, "  [+] Updates ...................... %"PRIu64"\n", S->updates);
+    fprintf(F, "  [+] Renormalizations ............. %"PRIu64" (%.3lf%%)\n",
+    S->renorms, Pct(S->renorms, S->updates));
+    fprintf(F, "  [+] Used contexts ................ %"PRIu64" (%.2lf%%)\n", 
+    used, Pct(used, M->nPModels));
+    return;
+    }
+
+  hist = (U64 *) Calloc(M->hTable.maxC + 1, sizeof(U64));
+  for(k = 0 ; k < HASH_SIZE ; ++k){
+    for(c = 0, n = 0 ; n < M->hTable.maxC ; ++n)
+      if(M->hTable.entries[k][n].counters != 0)
+        ++c;
+    ++hist[c];
+    }
+
+  fprintf(F, "Model %u (hash, order %u, %u collisions):\n", id, M->ctx, 
+  M->hTable.maxC);
+  fprintf(F, "  [+] Updates ...................... %"PRIu64"\n", S->updates);
+  fprintf(F, "  [+] Hits ......................... %"PRIu64" (%.2lf%%)\n", 
+  S->hits, Pct(S->hits, S->updates));
+  fprintf(F, "  [+] Inserts ...................... %"PRIu64"\n", S->inserts);
+  fprintf(F, "  [+] Evictions of the oldest ...... %"PRIu64" (%.2lf%% of "
+  "the inserts)\n", S->evictions, Pct(S->evictions, S->inserts));
+  fprintf(F, "  [+] Renormalizations ............. %"PRIu64" (%.3lf%%)\n",
+  S->renorms, Pct(S->renorms, S->updates));
+  fprintf(F, "  [+] Keys per bucket .............. ");
+  for(c = 0 ; c <= M->hTable.maxC ; ++c)
+    if(hist[c] != 0)
+      fprintf(F, "%u:%.2lf%% ", c, Pct(hist[c], HASH_SIZE));
+  fprintf(F, "\n");
+  Free(hist);
+  }
+
+#endif
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+SSModel *CreateSelfSim(void){
+  SSModel *S    = (SSModel *) Calloc(1, sizeof(SSModel));
+  S->size       = SS_MIN_SIZE;
+  S->entries    = (SSEntry *) Calloc(S->size, sizeof(SSEntry));
+  S->gen        = 0;
+  S->ctx        = SS_CTX;
+  S->alphaDen   = SS_ALPHA_DEN;
+  S->maxCount   = DEFAULT_MAX_COUNT;
+  S->multiplier = (U64) 1 << ((SS_CTX - 1) << 1);
+  ResetSelfSim(S, 0);
+  return S;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// STARTS A NEW REGION OF n BASES (0 IF UNKNOWN): THE TABLE IS ONLY CLEARED 
+// WHEN IT MUST GROW OR WHEN THE GENERATION WRAPS, OTHERWISE A NEW GENERATION
+// DISCARDS THE OLD ENTRIES WITHOUT TOUCHING THEM.
+
+void ResetSelfSim(SSModel *S, uint64_t n){
+  uint64_t size = S->size;
+  while(size < 2 * n && size < SS_MAX_SIZE)
+    size <<= 1;
+  if(size != S->size){
+    Free(S->entries);
+    S->size    = size;
+    S->entries = (SSEntry *) Calloc(S->size, sizeof(SSEntry));
+    S->gen     = 0;
+    }
+  if(++S->gen == 0){
+    memset(S->entries, 0, S->size * sizeof(SSEntry));
+    S->gen = 1;
+    }
+  S->used        = 0;
+  S->bits        = 0;
+  S->bases       = 0;
+  S->pModelIdx   = 0;
+  S->pModelIdxIR = ((U64) 1 << (S->ctx << 1)) - 1;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void RemoveSelfSim(SSModel *S){
+  Free(S->entries);
+  Free(S);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// RETURNS THE SLOT OF THE CONTEXT key: ITS OWN ENTRY OR THE EMPTY ONE WHERE IT
+// SHOULD BE INSERTED
+
+static SSEntry *SelfSimSlot(SSModel *S, U64 key){
+  U64 i = (key * 0x9E3779B97F4A7C15ULL) & (S->size - 1);
+  while(S->entries[i].gen == S->gen && S->entries[i].key != key)
+    i = (i + 1) & (S->size - 1);
+  return &S->entries[i];
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-    if(sym == 4){ // IF EXIST: SKIP OTHER CHARS
-      bits += 2.0;
-      ++bases;
-      continue;
+static void GrowSelfSim(SSModel *S){
+  U64     n, oldSize = S->size;
+  SSEntry *old = S->entries, *E;
+  S->size    <<= 1;
+  S->entries = (SSEntry *) Calloc(S->size, sizeof(SSEntry));
+  for(n = 0 ; n < oldSize ; ++n)
+    if(old[n].gen == S->gen){
+      E  = SelfSimSlot(S, old[n].key);
+      *E = old[n];
       }
+  Free(old);
+  }
 
-    GetPModelIdx(symBuf->buf+symBuf->idx-1, CM);
-    if(CM->ir == 1) // INVERTED REPEATS
-      irSym = GetPModelIdxIR(symBuf->buf+symBuf->idx, CM);
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-    if(bases >= CM->ctx){
-      ComputePModel(CM, PM, CM->pModelIdx, CM->alphaDen);
-      bits += PModelSymbolLog(PM, sym);
-      UpdateCModelCounter(CM, sym, CM->pModelIdx);
-      if(CM->ir == 1) // INVERTED REPEATS
-        UpdateCModelCounter(CM, irSym, CM->pModelIdxIR);
+static void UpdateSelfSim(SSModel *S, U32 sym, U64 key){
+  SSEntry *E = SelfSimSlot(S, key);
+  if(E->gen != S->gen){
+    if(2 * (S->used + 1) > S->size){
+      if(S->size >= SS_MAX_SIZE) // FULL: NEW CONTEXTS ARE NOT LEARNED
+        return;
+      GrowSelfSim(S);
+      E = SelfSimSlot(S, key);
       }
+    E->gen = S->gen;
+    E->key = key;
+    memset(E->counters, 0, sizeof(E->counters));
+    ++S->used;
+    }
+  if(++E->counters[sym] == S->maxCount){
+    E->counters[0] >>= 1;
+    E->counters[1] >>= 1;
+    E->counters[2] >>= 1;
+    E->counters[3] >>= 1;
+    }
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void ComputeSelfSim(SSModel *S, PModel *PM, U64 key){
+  SSEntry *E = SelfSimSlot(S, key);
+  U32     n;
+  PM->sum = 0;
+  for(n = 0 ; n < 4 ; ++n){
+    PM->freqs[n] = 1 + (E->gen == S->gen ? S->alphaDen * E->counters[n] : 0);
+    PM->sum += PM->freqs[n];
+    }
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// FEEDS THE NEXT BASE OF THE REGION. THE ORIGINAL MODEL NEVER ADVANCED ITS 
+// SYMBOL BUFFER, THEREFORE ITS FORWARD CONTEXT IS ALWAYS ZERO AND THE INVERTED
+// REPEAT SYMBOL IS ALWAYS THE COMPLEMENT OF ZERO. THIS IS KEPT SO THAT THE 
+// CLASSES DO NOT CHANGE.
+
+void FeedSelfSim(SSModel *S, uint8_t sym){
+  U32    freqs[4];
+  PModel PM = { freqs, 0 };
+
+  if(sym == 4){ // IF EXIST: SKIP OTHER CHARS
+    S->bits += 2.0;
+    ++S->bases;
+    return;
+    }
+
+  // INVERTED REPEATS
+  S->pModelIdxIR = (S->pModelIdxIR>>2)+GetCompNum(sym)*S->multiplier;
 
-    ++bases;
+  if(S->bases >= S->ctx){
+    ComputeSelfSim(S, &PM, S->pModelIdx);
+    S->bits += PModelSymbolLog(&PM, sym);
+    UpdateSelfSim(S, sym, S->pModelIdx);
+    UpdateSelfSim(S, GetCompNum(0), S->pModelIdxIR);
     }
 
-  if(bases > CM->ctx)  // FOR SHORT PIECES IGNORE CTX
-    bases -= CM->ctx;
+  ++S->bases;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// CLASS OF THE REGION FED SO FAR, BY ITS SELF-COMPRESSION
 
-  FreeCModel(CM);  
-  RemovePModel(PM);
-  RemoveCBuffer(symBuf);
-  Free(readBuf);
+int SelfSimClass(SSModel *S){
+  U64    bases = S->bases;
+  if(bases > S->ctx)  // FOR SHORT PIECES IGNORE CTX
+    bases -= S->ctx;
 
-  double bavg = bits / bases;
+  double bavg = S->bits / bases;
   if      (bavg > 1.95) return 0;
   else if (bavg > 1.60) return 1;
   else if (bavg > 1.25) return 2;
@@ -458,3 +727,14 @@ int SelfSimilarity(uint8_t *seq, uint64_t init, uint64_t end){
   }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// CLASSIFIES THE REGION [init, end] (1-BASED) OF seq
+
+int SelfSimilarity(SSModel *S, uint8_t *seq, uint64_t init, uint64_t end){
+  uint64_t n;
+  ResetSelfSim(S, end >= init ? end - init + 1 : 0);
+  for(n = init-1 ; n < end ; ++n)
+    FeedSelfSim(S, seq[n]);
+  return SelfSimClass(S);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
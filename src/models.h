@@ -1,6 +1,7 @@
 #ifndef MODELS_H_INCLUDED
 #define MODELS_H_INCLUDED
 
+#include <stdio.h>
 #include "defs.h"
 #include "buffer.h"
 #include "pmodels.h"
@@ -61,6 +62,17 @@ typedef struct{
   }
 Correct;
 
+#ifdef HASH_STATS
+typedef struct{               // Events of the training (SEE defs.h)
+  U64        updates;         // Counter updates
+  U64        hits;            // Updates that found their key (hash)
+  U64        inserts;         // Keys written, the updates that missed (hash)
+  U64        evictions;       // Inserts over the oldest key of a full bucket
+  U64        renorms;         // Counters halved on saturation
+  }
+HashStats;
+#endif
+
 typedef struct{
   U32        ctx;             // Current depth of context template
   U64        nPModels;        // Maximum number of probability models
@@ -76,14 +88,46 @@ typedef struct{
   U64        pModelIdxIR;
   U32        edits;
   Correct    SUBS;
+  #ifdef HASH_STATS
+  HashStats  stats;
+  #endif
   }
 CModel;
 
+#define SS_CTX                13     // Context of the self-similarity model
+#define SS_ALPHA_DEN          10
+#define SS_MIN_SIZE           1024   // Minimum entries of its table
+#define SS_MAX_SIZE           (1<<21)// Maximum entries: bounds its memory
+
+typedef struct{
+  U64        key;             // Context
+  U32        gen;             // Entry is empty if gen differs from the model
+  ACC        counters[4];
+  }
+SSEntry;
+
+typedef struct{
+  SSEntry    *entries;        // Open addressing table, power of two size
+  U64        size;
+  U64        used;
+  U32        gen;             // Bumped on each reset: clears in O(1)
+  U32        ctx;
+  U32        alphaDen;
+  U32        maxCount;
+  U64        multiplier;
+  U64        pModelIdx;
+  U64        pModelIdxIR;
+  double     bits;            // Of the region being fed
+  U64        bases;
+  }
+SSModel;
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 int32_t         BestId               (uint32_t *, uint32_t);
 void            HitSUBS              (CModel *);
 void            FailSUBS             (CModel *);
+int             InitHashBuckets      (HashTable *);
 void            FreeCModel           (CModel *);
 void            FreeShadow           (CModel *);
 void            GetPModelIdx         (U8 *, CModel *);
@@ -93,11 +137,22 @@ void            CorrectCModelSUBS    (CModel *, PModel *, uint8_t);
 void            ResetCModelIdx       (CModel *);
 void            ResetShadowModel     (CModel *);
 void            UpdateCModelCounter  (CModel *, U32, U64);
+uint64_t        CModelBytes          (U32, U32);
+uint64_t        CModelTotalBytes     (U32, U32, U32);
 CModel          *CreateCModel        (U32, U32, U32, U8, U32, U32, U32);
 CModel          *CreateShadowModel   (CModel *);
-void            ComputePModel        (CModel *, PModel *, uint64_t, uint32_t);
+CModel          *CreateShadowModelIn (ARENA *, CModel *);
+int             ComputePModel        (CModel *, PModel *, uint64_t, uint32_t);
 void            CorrectXModels       (CModel **, PModel **, uint8_t, uint32_t);    
-int             SelfSimilarity       (uint8_t *, uint64_t, uint64_t);
+#ifdef HASH_STATS
+void            PrintHashStats       (FILE *, CModel *, uint32_t);
+#endif
+SSModel         *CreateSelfSim       (void);
+void            ResetSelfSim         (SSModel *, uint64_t);
+void            RemoveSelfSim        (SSModel *);
+void            FeedSelfSim          (SSModel *, uint8_t);
+int             SelfSimClass         (SSModel *);
+int             SelfSimilarity       (SSModel *, uint8_t *, uint64_t, uint64_t);
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
@@ -60,6 +60,9 @@ void PrintMainMenu(void)
   "                 (Previously falcon-inter)                               \n"
   "      ivisual  - Create heatmap visualization of genome similarities     \n"
   "                 (Previously falcon-inter-visual)                        \n"
+  "      serve    - Keep a database in memory and answer meta jobs          \n"
+  "      query    - Send a sample to a running server                       \n"
+  "      merge    - Merge the partial tops of a sharded meta run            \n"
   "                                                                         \n"
   "      Use 'FALCON2 <command> -h' for help with a specific command.       \n"
   "                                                                         \n"
@@ -119,9 +122,39 @@ void PrintMenuFalcon(void){
   "      -p, --sample <rate>          subsampling (default: %u),            \n"
   "      -t, --top <num>              top of similarity (default: %u),      \n"
   "      -n, --nThreads <num>         number of threads (default: %u),      \n"
+  "      -k <len>                     split records longer than <len> bases \n"
+  "                                   in chunks scored by different threads,\n"
+  "                                   0 to disable (default: %u),           \n"
+  "      -w <len>                     bases to warm the models before each  \n"
+  "                                   chunk (default: %u). The chunks do not\n"
+  "                                   see the full record history, so the   \n"
+  "                                   similarity may differ slightly (often \n"
+  "                                   on the third decimal place),          \n"
+  "      -r <len>                     with -Z, keep the profiles of the top \n"
+  "                                   records up to <len> bases while       \n"
+  "                                   scanning, so they are not compressed  \n"
+  "                                   again, 0 to disable (default: %u),    \n"
+  "                                                                         \n"
+  "      --ckp <sec>                  save the state of the scan in         \n"
+  "                                   <output>.ckp every <sec> seconds,     \n"
+  "                                   0 to disable (default: %u),           \n"
+  "      -R, --resume                 restart the scan from <output>.ckp,   \n"
+  "                                   with the same options and files,      \n"
+  "      --shard <i>/<N>              scan only the shard i of N of the     \n"
+  "                                   database records and write a partial  \n"
+  "                                   top (default: top.<i>.ftop) for       \n"
+  "                                   FALCON2 merge (not with -Z, -B, -T),  \n"
+  "      --max-mem <MB>               lower the collisions and then the     \n"
+  "                                   orders of the models until the models \n"
+  "                                   and threads fit in <MB> (the plan is  \n"
+  "                                   printed with -v, not with -L, -B),    \n"
+  "      --stats-json <file>          write the wall and CPU time, bases/s  \n"
+  "                                   and peak RSS of each phase (and of    \n"
+  "                                   each thread, as with -v) in JSON,     \n"
   "                                                                         \n"
   "      -x, --output <file>          similarity top filename,              \n"
-  "      -y, --profile <file>         profile filename (-Z must be on).     \n"
+  "      -y, --profile <file>         profile filename (-Z must be on),     \n"
+  "                                   binary profiles if it ends in .falb.  \n"
   "                                                                         \n"
   "      -S, --save-model             save models after learning,           \n"
   "      -L, --load-model             load models previously saved model,   \n"
@@ -132,6 +165,14 @@ void PrintMenuFalcon(void){
   "                                   (Attention!) Is expected to only receive \n"
   "                                   the first file group (FASTQ)             \n"
   "                                                                         \n"
+  "      -B, --batch <manifest>       batch mode: one sample per line of the\n"
+  "                                   manifest, as \"SAMPLE [OUTPUT]\", where \n"
+  "                                   SAMPLE is a \":\" list of read files or \n"
+  "                                   a .fcm model. The database (the only  \n"
+  "                                   file argument) is read once for all   \n"
+  "                                   the samples, each with its own top    \n"
+  "                                   (default: SAMPLE.top.csv),            \n"
+  "                                                                         \n"
   "      Mandatory arguments:                                               \n"
   "                                                                         \n"
   "      [FILE1]:[FILE2]:...  metagenomic filename (FASTQ),                 \n"
@@ -165,7 +206,9 @@ void PrintMenuFalcon(void){
   "      License v3 <http://www.gnu.org/licenses/gpl.html>.                 \n"
   "                                                                         \n",
   VERSION, RELEASE, (uint32_t) MIN_LEV, (uint32_t) MAX_LEV, (uint32_t) 
-  DEFAULT_SAMPLE, (uint32_t) DEF_TOP, (uint32_t) DEFAULT_THREADS);
+  DEFAULT_SAMPLE, (uint32_t) DEF_TOP, (uint32_t) DEFAULT_THREADS, (uint32_t)
+  DEFAULT_SPLIT, (uint32_t) DEFAULT_WARMUP, (uint32_t)
+  DEFAULT_TRACE, (uint32_t) DEFAULT_CKP);
   }
 
 void PrintMenuFilter(void){
@@ -191,7 +234,7 @@ void PrintMenuFilter(void){
   "DESCRIPTION                                                              \n"
   "      It filter and segments regions identified by FALCON.               \n"
   "      It estimates de redundancy of each segmented region.               \n"
-  "      The input is provided by the output of FALCON (-y).                \n"
+  "      The input is provided by the output of FALCON (-y), .fal or .falb. \n"
   "                                                                         \n"
   "      Non-mandatory arguments:                                           \n"
   "                                                                         \n"
@@ -200,6 +243,7 @@ void PrintMenuFilter(void){
   "      -V                     display version number,                     \n"
   "      -v                     verbose mode (more information),            \n"
   "                                                                         \n"
+  "      -n  <nThreads>         number of threads (profiles in parallel),   \n"
   "      -s  <size>             filter window size,                         \n"
   "      -w  <type>             filter window type,                         \n"
   "      -x  <sampling>         filter window sampling,                     \n"
@@ -256,6 +300,23 @@ void PrintMenuInter(void){
   "      -s                   how compression levels,                       \n"
   "      -l <level>           compression level [1;30],                     \n"
   "      -n <nThreads>        number of threads,                            \n"
+  "      -ram <MB>            memory for the reference models. Each one     \n"
+  "                           costs the size of its models (shown in the    \n"
+  "                           log), so by default only one is kept and the  \n"
+  "                           threads share its targets. A larger budget    \n"
+  "                           keeps up to one per thread, so the threads    \n"
+  "                           also overlap the loads of the references,     \n"
+  "      -cache <DIR>         directory of cached reference models (.fcm):  \n"
+  "                           only new or changed files are trained,        \n"
+  "      -R, --resume         skip the cells of the checkpoint <matrix>.ckp,\n"
+  "                           written as the cells end. New files in the    \n"
+  "                           list only compute their rows and columns,     \n"
+  "      -j <J>               sketch pre-screening: the pairs with a        \n"
+  "                           FracMinHash Jaccard estimate below J are not  \n"
+  "                           compressed and get NDR 1 (default: 0, off);   \n"
+  "                           the genomes with fewer than max(50, 1/J)      \n"
+  "                           hashes (one per ~1000 bases) are never        \n"
+  "                           screened,                                     \n"
   "      -x <FILE>            similarity matrix filename,                   \n"
   "      -o <FILE>            labels filename,                              \n"
   "                                                                         \n"
@@ -320,7 +381,10 @@ void PrintMenuVisual(void){
   "      -ss                 do NOT show global scale,                      \n"
   "      -sn                 do NOT show names,                             \n"
   "                                                                         \n"
-  "      -o <FILE>           output image (SVG) filename.                   \n"
+  "      -tile <px>          split a raster image in tiles of <px> pixels,  \n"
+  "                                                                         \n"
+  "      -o <FILE>           output image filename: SVG, or a raster image  \n"
+  "                          (no text) if it ends in .png or .ppm.          \n"
   "                                                                         \n"
   "      Mandatory arguments:                                               \n"
   "                                                                         \n"
@@ -371,7 +435,9 @@ void PrintMenuInterVisual(void){
   "      -u             color hue,                                          \n"
   "      -g             color gamma,                                        \n"
   "      -l <FILE>      labels filename,                                    \n"
-  "      -x <FILE>      heatmap filename,                                   \n"
+  "      -x <FILE>      heatmap filename: SVG, or a raster image (no text)  \n"
+  "                     if it ends in .png or .ppm,                         \n"
+  "      -tile <px>     split a raster image in tiles of <px> pixels,       \n"
   "                                                                         \n"
   "      Mandatory arguments:                                               \n"
   "                                                                         \n"
@@ -386,6 +452,113 @@ void PrintMenuInterVisual(void){
   VERSION, RELEASE);
   }
 
+void PrintMenuServe(void){
+  fprintf(stderr,
+  "                                                                         \n"
+  "                                                                         \n"
+  "      ███████╗ █████╗ ██╗      ██████╗ ██████╗ ███╗   ██╗                \n"
+  "      ██╔════╝██╔══██╗██║     ██╔════╝██╔═══██╗████╗  ██║                \n"
+  "      █████╗  ███████║██║     ██║     ██║   ██║██╔██╗ ██║                \n"
+  "      ██╔══╝  ██╔══██║██║     ██║     ██║   ██║██║╚██╗██║                \n"
+  "      ██║     ██║  ██║███████╗╚██████╗╚██████╔╝██║ ╚████║                \n"
+  "      ╚═╝     ╚═╝  ╚═╝╚══════╝ ╚═════╝ ╚═════╝ ╚═╝  ╚═══╝                \n"
+  "                                                                         \n"
+  "NAME                                                                     \n"
+  "      FALCON2 serve v%u.%u: a resident FALCON database server.           \n"
+  "                                                                         \n"
+  "SYNOPSIS                                                                 \n"
+  "      FALCON2 serve [OPTION]... [DB_FILE]:[DB_FILE2]:...                 \n"
+  "                                                                         \n"
+  "SAMPLE                                                                   \n"
+  "      FALCON2 serve -n 8 -u /tmp/falcon.sock DB.fa                       \n"
+  "      FALCON2 query -u /tmp/falcon.sock -l 47 -x top.csv reads.fq        \n"
+  "                                                                         \n"
+  "DESCRIPTION                                                              \n"
+  "      It loads the database once, packed in memory, and answers the      \n"
+  "      jobs sent by FALCON2 query over a Unix domain socket. Each job     \n"
+  "      only trains the sample and scans the resident database, with the   \n"
+  "      same top as FALCON2 meta. The jobs run one at a time: a client     \n"
+  "      that sends no job within 5 seconds is dropped.                     \n"
+  "                                                                         \n"
+  "      Non-mandatory arguments:                                           \n"
+  "                                                                         \n"
+  "      -h                   give this help,                               \n"
+  "      -v                   verbose mode (more information),              \n"
+  "      -u <FILE>            socket (default: falcon.sock),                \n"
+  "      -l <level>           default level of the jobs,                    \n"
+  "      -t <top>             default top size of the jobs,                 \n"
+  "      -n <nThreads>        number of threads of each scan,               \n"
+  "      -M <FILE>:<FILE>     frozen models (.fcm) kept in memory: a job    \n"
+  "                           naming one of them does not load it,          \n"
+  "                                                                         \n"
+  "      Mandatory arguments:                                               \n"
+  "                                                                         \n"
+  "      [DB_FILE]            database file (last argument).                \n"
+  "                           Use \":\" for file splitting.                 \n"
+  "                                                                         \n"
+  "COPYRIGHT                                                                \n"
+  "      Copyright (C) 2014-2025, IEETA, University of Aveiro.              \n"
+  "      This is a Free software, under GPLv3. You may redistribute         \n"
+  "      copies of it under the terms of the GNU - General Public           \n"
+  "      License v3 <http://www.gnu.org/licenses/gpl.html>.                 \n"
+  "                                                                         \n",
+  VERSION, RELEASE);
+  }
+
+void PrintMenuQuery(void){
+  fprintf(stderr,
+  "                                                                         \n"
+  "NAME                                                                     \n"
+  "      FALCON2 query v%u.%u: client of FALCON2 serve.                     \n"
+  "                                                                         \n"
+  "SYNOPSIS                                                                 \n"
+  "      FALCON2 query [OPTION]... [FILE]:[FILE2]:...                       \n"
+  "                                                                         \n"
+  "DESCRIPTION                                                              \n"
+  "      It sends a sample to a running server and writes its top. The      \n"
+  "      progress of the job is written to stderr.                          \n"
+  "                                                                         \n"
+  "      -h                   give this help,                               \n"
+  "      -u <FILE>            socket (default: falcon.sock),                \n"
+  "      -l <level>           level (default: the one of the server),       \n"
+  "      -t <top>             top size (default: the one of the server),    \n"
+  "      -x <FILE>            top filename (default: stdout),               \n"
+  "      -q, --quit           stop the server,                              \n"
+  "                                                                         \n"
+  "      [FILE]               sample files or a .fcm model (last argument). \n"
+  "                                                                         \n",
+  VERSION, RELEASE);
+  }
+
+void PrintMenuMerge(void){
+  fprintf(stderr,
+  "                                                                         \n"
+  "NAME                                                                     \n"
+  "      FALCON2 merge v%u.%u: merge the partial tops of FALCON2 meta.      \n"
+  "                                                                         \n"
+  "SYNOPSIS                                                                 \n"
+  "      FALCON2 merge [OPTION]... [FILE]:[FILE2]:...                       \n"
+  "                                                                         \n"
+  "SAMPLE                                                                   \n"
+  "      FALCON2 meta --shard 1/2 -l 47 reads.fq DB.fa    (machine 1)       \n"
+  "      FALCON2 meta --shard 2/2 -l 47 reads.fq DB.fa    (machine 2)       \n"
+  "      FALCON2 merge -F -x top.csv top.1.ftop:top.2.ftop                  \n"
+  "                                                                         \n"
+  "DESCRIPTION                                                              \n"
+  "      It joins the partial tops (.ftop) of all the shards of a run in    \n"
+  "      the top of FALCON2 meta, the same as the one of an unsharded run.  \n"
+  "      The shards must use the same models, top and database files.       \n"
+  "                                                                         \n"
+  "      -h                   give this help,                               \n"
+  "      -F                   force mode (overwrites top file),             \n"
+  "      -t <top>             top size (default: the one of the shards),    \n"
+  "      -x <FILE>            top filename (default: top.csv),              \n"
+  "                                                                         \n"
+  "      [FILE]               partial tops, one per shard (last argument).  \n"
+  "                                                                         \n",
+  VERSION, RELEASE);
+  }
+
 void PrintVersion(void){
   fprintf(stderr,
   "                                                                         \n"
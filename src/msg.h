@@ -12,6 +12,9 @@ void PrintMenuFilter      (void);
 void PrintMenuInter       (void);
 void PrintMenuVisual      (void);
 void PrintMenuInterVisual (void);
+void PrintMenuServe       (void);
+void PrintMenuQuery       (void);
+void PrintMenuMerge       (void);
 void PrintVersion         (void);
 
 #endif
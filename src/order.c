@@ -0,0 +1,56 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "order.h"
+#include "mem.h"
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+ORDER *CreateOrder(uint64_t nJobs){
+  ORDER *O   = (ORDER *) Calloc(1, sizeof(ORDER));
+  O->next    = 0;
+  O->claimed = 0;
+  O->nJobs   = nJobs;
+  pthread_mutex_init(&O->lock, NULL);
+  pthread_cond_init(&O->turn, NULL);
+  return O;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// RETURNS THE NEXT JOB TO PROCESS OR -1 WHEN ALL WERE GIVEN
+
+int64_t OrderClaim(ORDER *O){
+  int64_t job = -1;
+  pthread_mutex_lock(&O->lock);
+  if(O->claimed < O->nJobs)
+    job = (int64_t) O->claimed++;
+  pthread_mutex_unlock(&O->lock);
+  return job;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// WAITS UNTIL ALL THE JOBS BEFORE job ARE WRITTEN. THE LOCK IS KEPT UNTIL 
+// OrderEnd, SO THE CALLER WRITES ALONE.
+
+void OrderBegin(ORDER *O, uint64_t job){
+  pthread_mutex_lock(&O->lock);
+  while(O->next != job)
+    pthread_cond_wait(&O->turn, &O->lock);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void OrderEnd(ORDER *O){
+  ++O->next;
+  pthread_cond_broadcast(&O->turn);
+  pthread_mutex_unlock(&O->lock);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void RemoveOrder(ORDER *O){
+  pthread_mutex_destroy(&O->lock);
+  pthread_cond_destroy(&O->turn);
+  Free(O);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
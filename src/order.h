@@ -0,0 +1,32 @@
+#ifndef ORDER_H_INCLUDED
+#define ORDER_H_INCLUDED
+
+#include <pthread.h>
+#include "defs.h"
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// ORDERED OUTPUT STAGE: JOBS ARE NUMBERED 0, 1, 2, ... AND PROCESSED BY ANY 
+// THREAD, BUT THEIR OUTPUT IS WRITTEN IN JOB ORDER. A THREAD THAT FINISHES A
+// JOB WAITS FOR ITS TURN WITH OrderBegin, WRITES AND CALLS OrderEnd. HENCE AT 
+// MOST ONE FINISHED JOB PER THREAD IS KEPT IN MEMORY.
+
+typedef struct{
+  pthread_mutex_t lock;
+  pthread_cond_t  turn;
+  uint64_t        next;      // Job that can write now
+  uint64_t        claimed;   // Next job to be given to a thread
+  uint64_t        nJobs;
+  }
+ORDER;
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+ORDER      *CreateOrder    (uint64_t);
+int64_t    OrderClaim      (ORDER *);
+void       OrderBegin      (ORDER *, uint64_t);
+void       OrderEnd        (ORDER *);
+void       RemoveOrder     (ORDER *);
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#endif
@@ -76,16 +76,19 @@ HsvColor RgbToHsv(RgbColor rgb){
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-char *GetRgbColor(uint8_t hue){
-  RgbColor RGB;
+RgbColor HueRgb(uint8_t hue){
   HsvColor HSV;
-  char *color = (char *) Malloc(8 * sizeof(char));
-  
   HSV.h = hue;
   HSV.s = LEVEL_SATURATION;
   HSV.v = LEVEL_VALUE;
+  return HsvToRgb(HSV);
+  }
 
-  RGB = HsvToRgb(HSV);
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+char *GetRgbColor(uint8_t hue){
+  RgbColor RGB = HueRgb(hue);
+  char *color = (char *) Malloc(8 * sizeof(char));
 
   sprintf(color, "#%X%X%X", RGB.r, RGB.g, RGB.b); 
 
@@ -94,7 +97,8 @@ char *GetRgbColor(uint8_t hue){
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-char *HeatMapColor(double lambda, char *color, COLORS *CLR){
+RgbColor HeatMapRgb(double lambda, COLORS *CLR){
+  RgbColor RGB;
   // CHANGE BEHAVIOUR [SENSITIVITY: NEAR LOW SIMILARITY // COMMENT 4 UNIFORM
   lambda = (1 + lambda*lambda*lambda + tanh(8*(lambda-1))) / 2;
 
@@ -105,12 +109,17 @@ char *HeatMapColor(double lambda, char *color, COLORS *CLR){
   double G = lambdaGamma - a*0.29227*cos(phi) - a*0.90649*sin(phi);
   double B = lambdaGamma + a*1.97294*cos(phi);
 
-  R = BoundDouble(0.0, R, 1.0);
-  G = BoundDouble(0.0, G, 1.0);
-  B = BoundDouble(0.0, B, 1.0);
+  RGB.r = (int) (BoundDouble(0.0, R, 1.0) * 255);
+  RGB.g = (int) (BoundDouble(0.0, G, 1.0) * 255);
+  RGB.b = (int) (BoundDouble(0.0, B, 1.0) * 255);
+  return RGB;
+  }
 
-  sprintf(color, "#%02X%02X%02X", (int) (R * 255), (int) (G * 255), (int) (B *
-  255));
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+char *HeatMapColor(double lambda, char *color, COLORS *CLR){
+  RgbColor RGB = HeatMapRgb(lambda, CLR);
+  sprintf(color, "#%02X%02X%02X", RGB.r, RGB.g, RGB.b);
   return color;
   }
 
@@ -205,6 +214,14 @@ void Rect(FILE *F, double w, double h, double x, double y, char *color){
            "/>\n", color, w, h, x, y);
   }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// SAME AS Rect WITHOUT THE (UNUSED) STROKE STYLE: FOR MAPS WITH MANY SEGMENTS
+
+void RectFill(FILE *F, double w, double h, double x, double y, char *color){
+  fprintf(F, "<rect fill=\"%s\" width=\"%.2lf\" height=\"%.2lf\" "
+  "x=\"%.2lf\" y=\"%.2lf\"/>\n", color, w, h, x, y);
+  }
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 void RectIR(FILE *F, double w, double h, double x, double y, char *color){
@@ -53,18 +53,21 @@ HsvColor;
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+RgbColor  HeatMapRgb         (double, COLORS *);
 char      *HeatMapColor       (double, char *, COLORS *);
 Painter   *CreatePainter      (double, double, double, double, char *);
 Painter   *CreateBasicPainter (double, double, double);
 void      RemovePainter       (Painter *);
 RgbColor  HsvToRgb            (HsvColor);
 HsvColor  RgbToHsv            (RgbColor);
+RgbColor  HueRgb             (uint8_t);
 char      *GetRgbColor        (uint8_t);
 void      PrintFinal          (FILE *);
 void      PrintHead           (FILE *, double, double);
 void      RectOval            (FILE *, double, double, double, double, char *);
 void      RectOvalIR          (FILE *, double, double, double, double, char *);
 void      Rect                (FILE *, double, double, double, double, char *);
+void      RectFill            (FILE *, double, double, double, double, char *);
 void      RectWithBorder      (FILE *, double, double, double, double, char *);
 void      RectIR              (FILE *, double, double, double, double, char *);
 void      Chromosome          (FILE *, double, double, double, double);
@@ -4,6 +4,7 @@
 #include "defs.h"
 #include "models.h"
 #include "top.h"
+#include "stream.h"
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
@@ -26,6 +27,7 @@ typedef struct{
   #ifdef LOCAL_SIMILARITY
   U8       local;
   char     *outLoc;
+  U64      trace;       // Longest record whose profile is kept from the scan
   #endif
   U32      sample;
   U32      col;
@@ -36,15 +38,25 @@ typedef struct{
   U32      index;
   U32      nModels;
   U32      nThreads;
-  U8       nFiles;
+  U64      split;       // Records longer than this are split in chunks
+  U64      warmup;      // Bases used to warm the models before a chunk
+  U32      shard;       // Shard of the database that is scanned (from 0)
+  U32      nShards;     // Processes sharing the database (--shard, 1: off)
+  U64      maxMem;      // MB for the models and threads (--max-mem, 0: off)
+  char     *statsJson;  // Phase statistics in JSON (--stats-json, NULL: off)
+  U32      nFiles;
   U8       nDatabases;
-  U8       currentDBIdx;
   // GULL ADDED ====
   char     **files;
   char     **dbFiles;
   double   **matrix;
   uint8_t  *labels;
   uint32_t ref;
+  U64      ram;         // MB for the inter reference models (0: -n)
+  char     *cache;      // Directory of the cached inter models (.fcm)
+  U8       resume;      // Restart from the checkpoint (inter and meta)
+  U32      ckp;         // Seconds between the meta scan checkpoints (0: off)
+  double   sketch;      // Jaccard cutoff of the inter pre-screening (0: off)
   // ===============
   U64      *size;
   TOP      *top;
@@ -57,6 +69,7 @@ typedef struct{
   U8       trainModel;  // Flag to train models
   U8       modelInfo;   // Flag to show model information
   char     *modelFile;  // File to save/load model
+  char     *batch;      // Manifest of the samples of the batch mode
   // ===============
   U8       useMagnet;        // Flag to enable MAGNET filtering
   char     *magnetFilter;    // FASTA file for MAGNET filtering
@@ -74,7 +87,16 @@ typedef struct{
   uint32_t ref;
   uint64_t min;
   TOP      *top;
+  PARTIALS *parts;
   ModelPar *model;
+  STREAM   *trace;      // Profile of the record being scanned (-r)
+  uint64_t resume;     // Key of the last record restored from the checkpoint
+  FILE     *spill;      // Profiles of the records that entered the top
+  uint64_t spillMark;  // Spill size at its last compaction check
+  #ifdef HASH_STATS
+  uint64_t *lookups;    // Of each model and tolerant model (SEE defs.h)
+  uint64_t *found;      // Lookups whose context was in the model
+  #endif
   }
 Threads;
 
@@ -99,6 +121,7 @@ typedef struct{
   double   lowerSimi;
   int64_t  upperSize;
   int64_t  lowerSize;
+  uint32_t nThreads;
   int64_t  windowSize;
   int      windowType;
   int64_t  sampling;
@@ -109,6 +132,7 @@ typedef struct{
   U8       showScale;
   U8       showNames;
   U8       sameScale;
+  uint64_t tile;        // Pixels of the raster tiles (0: one image)
   char     *output;
   }
 EYEPARAM;
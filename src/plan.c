@@ -0,0 +1,129 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "plan.h"
+#include "parser.h"
+#include "scratch.h"
+#include "mem.h"
+
+#define MB(x) ((double) (x) / 1048576.0)
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// BYTES OF EACH THREAD: THE SCRATCH OF CompressTarget, THE TOP, THE PARSER
+// AND THE READ BUFFER
+
+static uint64_t ThreadBytes(ModelPar *M, uint32_t nModels, uint32_t topSize){
+  uint32_t n, *edits = (uint32_t *) Calloc(nModels, sizeof(uint32_t));
+  uint64_t bytes;
+
+  for(n = 0 ; n < nModels ; ++n)
+    edits[n] = M[n].edits;
+  bytes = ScratchBytes(edits, nModels) + sizeof(TOP) + (uint64_t) (topSize
+  + 1) * sizeof(VT) + sizeof(PARSER) + BUFFER_SIZE;
+  Free(edits);
+  return bytes;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+MEMPLAN PlanMemory(ModelPar *M, uint32_t nModels, uint32_t col, uint32_t 
+nThreads, uint32_t topSize){
+  MEMPLAN  Plan;
+  uint32_t n;
+
+  Plan.models = nModels * sizeof(CModel *);
+  for(n = 0 ; n < nModels ; ++n)
+    Plan.models += CModelTotalBytes(M[n].ctx, col, M[n].edits);
+  Plan.thread = ThreadBytes(M, nModels, topSize);
+  Plan.total  = Plan.models + nThreads * Plan.thread;
+  return Plan;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// HIGHEST ORDER BELOW ctx THAT TAKES LESS MEMORY (A HASH MODEL DOES NOT 
+// SHRINK WITH ITS ORDER, SO IT MOVES TO THE LARGEST ARRAY THAT IS SMALLER).
+// 0 IF THERE IS NONE.
+
+static uint32_t LowerOrder(uint32_t ctx, uint32_t col){
+  uint64_t bytes = CModelBytes(ctx, col);
+  uint32_t c;
+
+  for(c = ctx ; c-- > MIN_CTX ; )
+    if(CModelBytes(c, col) < bytes)
+      return c;
+  return 0;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// LOWERS THE LARGEST MODEL, ONE STEP AT A TIME, UNTIL THE MODELS FIT IN 
+// budget BYTES: A HASH MODEL LOSES A COLLISION (ALL THE HASH MODELS SHARE 
+// col) WHILE IT HAS MORE THAN ONE, ANY OTHER ONE GOES TO A LOWER ORDER. 
+// RETURNS 0 IF NOTHING CHANGED, 1 IF THE MODELS WERE LOWERED AND -1 IF THEY
+// CANNOT FIT.
+
+int FitMemory(ModelPar *M, uint32_t nModels, uint32_t *col, uint32_t 
+nThreads, uint32_t topSize, uint64_t budget){
+  uint32_t n, big;
+  int      lowered = 0;
+
+  while(PlanMemory(M, nModels, *col, nThreads, topSize).total > budget){
+    big = nModels;
+    for(n = 0 ; n < nModels ; ++n)
+      if((*col > 1 && M[n].ctx >= HASH_TABLE_BEGIN_CTX) || LowerOrder(M[n].ctx,
+      *col) != 0)
+        if(big == nModels || CModelBytes(M[n].ctx, *col) >= 
+        CModelBytes(M[big].ctx, *col))
+          big = n;
+    if(big == nModels)
+      return -1;
+
+    if(*col > 1 && M[big].ctx >= HASH_TABLE_BEGIN_CTX)
+      --*col;
+    else
+      M[big].ctx = LowerOrder(M[big].ctx, *col);
+    lowered = 1;
+    }
+
+  return lowered;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void PrintItem(FILE *F, char *item, double mb){
+  char     line[40];
+  uint32_t n = strlen(item);
+
+  memset(line, '.', 36);
+  line[36] = '\0';
+  memcpy(line, item, n < 35 ? n : 35);
+  line[n < 35 ? n : 35] = ' ';
+  fprintf(F, "%s %.1lf MB\n", line, mb);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void PrintPlan(FILE *F, ModelPar *M, uint32_t nModels, uint32_t col, 
+uint32_t nThreads, uint32_t topSize, uint64_t budget){
+  MEMPLAN  Plan = PlanMemory(M, nModels, col, nThreads, topSize);
+  char     item[64];
+  uint32_t n;
+
+  fprintf(F, "==[ MEMORY PLAN ]===================\n");
+  for(n = 0 ; n < nModels ; ++n){
+    if(M[n].ctx >= HASH_TABLE_BEGIN_CTX)
+      sprintf(item, "Model %u (hash, order %u, col %u)", n + 1, M[n].ctx,
+      col);
+    else
+      sprintf(item, "Model %u (array, order %u)", n + 1, M[n].ctx);
+    PrintItem(F, item, MB(CModelTotalBytes(M[n].ctx, col, M[n].edits)));
+    }
+  PrintItem(F, "Shared models", MB(Plan.models));
+  sprintf(item, "Each of the %u threads", nThreads);
+  PrintItem(F, item, MB(Plan.thread));
+  PrintItem(F, "Total", MB(Plan.total));
+  if(budget != 0)
+    PrintItem(F, "Budget (--max-mem)", MB(budget));
+  fprintf(F, "\n");
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -0,0 +1,33 @@
+#ifndef PLAN_H_INCLUDED
+#define PLAN_H_INCLUDED
+
+#include <stdio.h>
+#include "defs.h"
+#include "param.h"
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// MEMORY PLANNER: THE BYTES OF A SET OF MODELS ARE COMPUTED FROM THEIR 
+// PARAMETERS, BEFORE ANYTHING IS ALLOCATED. THE MODELS ARE SHARED BY ALL THE
+// THREADS; EACH THREAD HAS ITS OWN SCRATCH (SHADOWS, TOLERANT BUFFERS AND 
+// MIXER), TOP, PARSER AND READ BUFFER. THE TOP ENTRIES OF THE RECORD NAMES
+// AND THE CHUNK PARTIALS GROW WITH THE DATABASE AND ARE LEFT OUT.
+
+typedef struct{
+  uint64_t models;            // Shared models
+  uint64_t thread;            // State of each thread
+  uint64_t total;             // models + nThreads * thread
+  }
+MEMPLAN;
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+MEMPLAN    PlanMemory      (ModelPar *, uint32_t, uint32_t, uint32_t, 
+                           uint32_t);
+int        FitMemory       (ModelPar *, uint32_t, uint32_t *, uint32_t, 
+                           uint32_t, uint64_t);
+void       PrintPlan       (FILE *, ModelPar *, uint32_t, uint32_t, uint32_t,
+                           uint32_t, uint64_t);
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#endif
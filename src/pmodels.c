@@ -23,6 +23,19 @@ CMWeight *CreateWeightModel(uint32_t size){
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+CMWeight *CreateWeightModelIn(ARENA *A, uint32_t size){
+  uint32_t n;
+  CMWeight *CMW    = (CMWeight *) ArenaCalloc(A, 1, sizeof(CMWeight));
+  CMW->totModels   = size;
+  CMW->totalWeight = 0;
+  CMW->weight      = (double *) ArenaCalloc(A, CMW->totModels, sizeof(double));
+  for(n = 0 ; n < CMW->totModels ; ++n)
+    CMW->weight[n] = 1.0 / CMW->totModels;
+  return CMW;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
 void ResetWeightModel(CMWeight *CMW){
   uint32_t n;
   double fraction = 1.0 / CMW->totModels;
@@ -77,6 +90,14 @@ PModel *CreatePModel(U32 n){
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+PModel *CreatePModelIn(ARENA *A, U32 n){
+  PModel *PM = (PModel *) ArenaCalloc(A, 1, sizeof(PModel));
+  PM->freqs  = (U32    *) ArenaCalloc(A, n, sizeof(U32));
+  return PM;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
 void RemovePModel(PModel *PM){
   Free(PM->freqs);
   Free(PM);
@@ -92,6 +113,14 @@ FloatPModel *CreateFloatPModel(U32 n){
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+FloatPModel *CreateFloatPModelIn(ARENA *A, U32 n){
+  FloatPModel *F = (FloatPModel *) ArenaCalloc(A, 1, sizeof(FloatPModel));
+  F->freqs = (double *) ArenaCalloc(A, n, sizeof(double));
+  return F;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
 void RemoveFPModel(FloatPModel *FM){
   Free(FM->freqs);
   Free(FM);
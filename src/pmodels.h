@@ -26,13 +26,16 @@ CMWeight;
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 PModel          *CreatePModel        (U32);
+PModel          *CreatePModelIn      (ARENA *, U32);
 FloatPModel     *CreateFloatPModel   (U32);
+FloatPModel     *CreateFloatPModelIn (ARENA *, U32);
 void            RemovePModel         (PModel *);
 void            RemoveFPModel        (FloatPModel *);
 void            ComputeMXProbs       (FloatPModel *, PModel *);
 void            ComputeWeightedFreqs (double, PModel *, FloatPModel *);
 double          PModelSymbolLog      (PModel *, U32);
 CMWeight        *CreateWeightModel   (uint32_t);
+CMWeight        *CreateWeightModelIn (ARENA *, uint32_t);
 void            ResetWeightModel     (CMWeight *);
 void            RenormalizeWeights   (CMWeight *);
 void            CalcDecayment        (CMWeight *, PModel **, uint8_t, double);
@@ -0,0 +1,320 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "raster.h"
+#include "common.h"
+#include "mem.h"
+
+#define PNG_CHUNK      65536   // Bytes of each IDAT chunk
+#define PNG_MAX_MATCH  258
+
+typedef struct{
+  FILE     *F;
+  uint8_t  *buf;               // Data of the IDAT chunk being built
+  uint32_t n;
+  uint64_t bits;               // Deflate bit stream (LSB first)
+  uint32_t nBits;
+  uint32_t a;                  // Adler-32 of the raw data
+  uint32_t b;
+  }
+PNGW;
+
+static uint32_t CrcTable[256];
+static uint8_t  CrcReady = 0;
+
+static const uint16_t LenBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17,
+  19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t  LenExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2,
+  2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+int RasterType(char *fName){
+  if(ends_with(fName, ".png")) return RASTER_PNG;
+  if(ends_with(fName, ".ppm")) return RASTER_PPM;
+  return RASTER_NONE;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// "#RRGGBB" OR "#RGB" (AS IN THE SVG MAPS)
+
+RgbColor HexRgb(char *color){
+  RgbColor RGB = { 0, 0, 0 };
+  unsigned r, g, b;
+  if(strlen(color) == 7 && sscanf(color+1, "%2x%2x%2x", &r, &g, &b) == 3){
+    RGB.r = r; RGB.g = g; RGB.b = b;
+    }
+  else if(strlen(color) == 4 && sscanf(color+1, "%1x%1x%1x", &r, &g, &b) == 3){
+    RGB.r = r * 17; RGB.g = g * 17; RGB.b = b * 17;
+    }
+  return RGB;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// PIXEL SPAN [*i, *e) OF A SHAPE ALONG ONE AXIS, CLIPPED TO THE VIEW. A SHAPE
+// THINNER THAN ONE PIXEL STILL TAKES ONE, SO SHORT SEGMENTS ARE NOT LOST.
+
+static int Span(double p, double len, int64_t o, uint32_t size, int64_t *i,
+int64_t *e){
+  *i = (int64_t) floor(p + 0.5);
+  *e = (int64_t) floor(p + len + 0.5);
+  if(*e <= *i)
+    *e = *i + 1;
+  *i -= o;
+  *e -= o;
+  if(*i < 0)              *i = 0;
+  if(*e > (int64_t) size) *e = size;
+  return *i < *e;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void RasterRect(RASTER *R, double w, double h, double x, double y, RgbColor
+C){
+  int64_t xi, xe, yi, ye, col;
+  uint8_t *px;
+
+  if(w <= 0 || h <= 0)
+    return;
+  if(!Span(x, w, R->x0, R->width, &xi, &xe) || !Span(y, h, R->y0, R->height,
+  &yi, &ye))
+    return;
+
+  for( ; yi < ye ; ++yi){
+    px = R->px + ((uint64_t) yi * R->width + xi) * 3;
+    for(col = xi ; col < xe ; ++col){
+      *px++ = C.r;
+      *px++ = C.g;
+      *px++ = C.b;
+      }
+    }
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// ONE PIXEL BORDER OF A RECTANGLE (AS THE SVG STROKE OF Chromosome)
+
+void RasterFrame(RASTER *R, double w, double h, double x, double y, RgbColor
+C){
+  RasterRect(R, w, 1, x, y,       C);
+  RasterRect(R, w, 1, x, y+h-1,   C);
+  RasterRect(R, 1, h, x, y,       C);
+  RasterRect(R, 1, h, x+w-1, y,   C);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void PutU32BE(uint8_t *p, uint32_t v){
+  p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static uint32_t Crc(uint32_t crc, uint8_t *p, uint64_t n){
+  uint32_t k, j, c;
+  if(CrcReady == 0){
+    for(k = 0 ; k < 256 ; ++k){
+      c = k;
+      for(j = 0 ; j < 8 ; ++j)
+        c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      CrcTable[k] = c;
+      }
+    CrcReady = 1;
+    }
+  while(n--)
+    crc = CrcTable[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+  return crc;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void PngChunk(FILE *F, char *type, uint8_t *data, uint32_t n){
+  uint8_t  head[8], tail[4];
+  uint32_t crc;
+  PutU32BE(head, n);
+  memcpy(head + 4, type, 4);
+  crc = Crc(0xFFFFFFFFu, head + 4, 4);
+  crc = Crc(crc, data, n) ^ 0xFFFFFFFFu;
+  PutU32BE(tail, crc);
+  fwrite(head, 1, 8, F);
+  fwrite(data, 1, n, F);
+  fwrite(tail, 1, 4, F);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void PngByte(PNGW *W, uint8_t byte){
+  W->buf[W->n++] = byte;
+  if(W->n == PNG_CHUNK){
+    PngChunk(W->F, "IDAT", W->buf, W->n);
+    W->n = 0;
+    }
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void PutBits(PNGW *W, uint32_t value, uint32_t n){
+  W->bits  |= (uint64_t) value << W->nBits;
+  W->nBits += n;
+  while(W->nBits >= 8){
+    PngByte(W, W->bits & 0xff);
+    W->bits  >>= 8;
+    W->nBits  -= 8;
+    }
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// HUFFMAN CODES ARE STORED FROM THE MOST SIGNIFICANT BIT
+
+static void PutCode(PNGW *W, uint32_t code, uint32_t len){
+  uint32_t n, rev = 0;
+  for(n = 0 ; n < len ; ++n)
+    rev |= ((code >> n) & 1) << (len - 1 - n);
+  PutBits(W, rev, len);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void PutLiteral(PNGW *W, uint32_t v){
+  if     (v < 144) PutCode(W, 0x30  + v,         8);
+  else if(v < 256) PutCode(W, 0x190 + (v - 144), 9);
+  else if(v < 280) PutCode(W, v - 256,           7);
+  else             PutCode(W, 0xC0  + (v - 280), 8);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// A MATCH OF len BYTES AT DISTANCE 3 (THE PREVIOUS PIXEL): DISTANCE CODE 2
+
+static void PutMatch(PNGW *W, uint32_t len){
+  uint32_t idx = 28;
+  while(LenBase[idx] > len)
+    --idx;
+  PutLiteral(W, 257 + idx);
+  if(LenExtra[idx] != 0)
+    PutBits(W, len - LenBase[idx], LenExtra[idx]);
+  PutCode(W, 2, 5);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void PngRow(PNGW *W, uint8_t *raw, uint64_t n){
+  uint64_t i, len;
+
+  for(i = 0 ; i < n ; ++i){ // ADLER-32
+    W->a = (W->a + raw[i]) % 65521;
+    W->b = (W->b + W->a)   % 65521;
+    }
+
+  for(i = 0 ; i < n ; i += len){
+    len = 0;
+    if(i >= 3)
+      while(i + len < n && len < PNG_MAX_MATCH && raw[i+len] == raw[i+len-3])
+        ++len;
+    if(len >= 3)
+      PutMatch(W, len);
+    else{
+      PutLiteral(W, raw[i]);
+      len = 1;
+      }
+    }
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void WritePng(RASTER *R, FILE *F){
+  uint8_t  head[13], adler[4], *raw;
+  uint64_t stride = (uint64_t) R->width * 3, y;
+  PNGW     W = { F, NULL, 0, 0, 0, 1, 0 };
+
+  fwrite("\x89PNG\r\n\x1a\n", 1, 8, F);
+  PutU32BE(head,     R->width);
+  PutU32BE(head + 4, R->height);
+  head[8]  = 8;   // BIT DEPTH
+  head[9]  = 2;   // RGB
+  head[10] = 0;   // DEFLATE
+  head[11] = 0;   // ADAPTIVE FILTERING (ONLY "NONE" IS USED)
+  head[12] = 0;   // NO INTERLACE
+  PngChunk(F, "IHDR", head, 13);
+
+  W.buf = (uint8_t *) Malloc(PNG_CHUNK);
+  raw   = (uint8_t *) Malloc(stride + 1);
+  PngByte(&W, 0x78); // ZLIB HEADER: DEFLATE, 32K WINDOW
+  PngByte(&W, 0x01);
+  PutBits(&W, 1, 1); // LAST BLOCK
+  PutBits(&W, 1, 2); // FIXED HUFFMAN CODES
+  for(y = 0 ; y < R->height ; ++y){
+    raw[0] = 0; // FILTER: NONE
+    memcpy(raw + 1, R->px + y * stride, stride);
+    PngRow(&W, raw, stride + 1);
+    }
+  PutLiteral(&W, 256); // END OF BLOCK
+  if(W.nBits > 0)
+    PutBits(&W, 0, 8 - W.nBits);
+  PutU32BE(adler, W.b << 16 | W.a);
+  for(y = 0 ; y < 4 ; ++y)
+    PngByte(&W, adler[y]);
+  if(W.n > 0)
+    PngChunk(F, "IDAT", W.buf, W.n);
+  PngChunk(F, "IEND", NULL, 0);
+
+  Free(raw);
+  Free(W.buf);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void WritePpm(RASTER *R, FILE *F){
+  fprintf(F, "P6\n%u %u\n255\n", R->width, R->height);
+  fwrite(R->px, 1, (uint64_t) R->width * R->height * 3, F);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// PAINTS AND SAVES THE WHOLE IMAGE (width x height PIXELS) OR EACH OF ITS
+// TILES. THE paint FUNCTION DRAWS ALL THE SHAPES: THE ONES OUT OF THE VIEW
+// ARE CLIPPED.
+
+void PaintRaster(char *fName, double width, double height, uint64_t tile,
+RASTERPAINT paint, void *data){
+  uint64_t W = (uint64_t) ceil(width), H = (uint64_t) ceil(height);
+  uint64_t tW = tile == 0 ? W : tile, tH = tile == 0 ? H : tile;
+  uint64_t row, col, nRows = (H + tH - 1) / tH, nCols = (W + tW - 1) / tW;
+  char     *name = (char *) Calloc(strlen(fName) + 64, sizeof(char));
+  char     *ext  = strrchr(fName, '.');
+  RASTER   R;
+  FILE     *F;
+
+  if(tW * tH > RASTER_MAX || W >= UINT32_MAX || H >= UINT32_MAX){
+    fprintf(stderr, "  [x] Error: the image has %"PRIu64" x %"PRIu64" pixels,"
+    " use tiles!\n", W, H);
+    exit(1);
+    }
+
+  R.px = (uint8_t *) Malloc(tW * tH * 3);
+  for(row = 0 ; row < nRows ; ++row)
+    for(col = 0 ; col < nCols ; ++col){
+      R.x0     = col * tW;
+      R.y0     = row * tH;
+      R.width  = (uint32_t) (W - R.x0 < tW ? W - R.x0 : tW);
+      R.height = (uint32_t) (H - R.y0 < tH ? H - R.y0 : tH);
+      memset(R.px, 0xff, (uint64_t) R.width * R.height * 3); // WHITE
+      paint(&R, data);
+
+      if(tile == 0)
+        strcpy(name, fName);
+      else{
+        memcpy(name, fName, ext - fName);
+        sprintf(name + (ext - fName), "_%"PRIu64"_%"PRIu64"%s", row, col, ext);
+        }
+      F = Fopen(name, "w");
+      if(RasterType(fName) == RASTER_PNG)
+        WritePng(&R, F);
+      else
+        WritePpm(&R, F);
+      fclose(F);
+      }
+
+  Free(R.px);
+  Free(name);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
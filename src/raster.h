@@ -0,0 +1,45 @@
+#ifndef RASTER_H_INCLUDED
+#define RASTER_H_INCLUDED
+
+#include <stdio.h>
+#include "defs.h"
+#include "paint.h"
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// RASTER BACKEND FOR THE MAPS: THE SHAPES ARE DRAWN IN AN RGB PIXEL BUFFER
+// (ONE PIXEL PER SVG UNIT) AND WRITTEN AS PPM (P6) OR PNG. THE PNG ENCODER
+// HAS NO DEPENDENCIES: ONE FIXED HUFFMAN DEFLATE BLOCK WHERE THE REPEATED
+// PIXELS ARE MATCHES AT DISTANCE 3. A LARGE IMAGE MAY BE SPLIT IN TILES OF
+// AT MOST tile x tile PIXELS: EACH TILE IS A VIEW (x0, y0) OF THE WHOLE IMAGE
+// THAT IS PAINTED AGAIN BY THE CALLER AND SAVED AS name_ROW_COL.ext.
+
+#define RASTER_NONE    0
+#define RASTER_PPM     1
+#define RASTER_PNG     2
+#define RASTER_MAX     (1ull << 31)   // Pixels of one image (or tile)
+
+typedef struct{
+  uint32_t width;
+  uint32_t height;
+  int64_t  x0;        // Position of the view in the whole image
+  int64_t  y0;
+  uint8_t  *px;       // RGB, row by row
+  }
+RASTER;
+
+typedef void (*RASTERPAINT)(RASTER *, void *);
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+int        RasterType      (char *);
+RgbColor   HexRgb          (char *);
+void       RasterRect      (RASTER *, double, double, double, double,
+                           RgbColor);
+void       RasterFrame     (RASTER *, double, double, double, double,
+                           RgbColor);
+void       PaintRaster     (char *, double, double, uint64_t, RASTERPAINT,
+                           void *);
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#endif
@@ -0,0 +1,173 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "scratch.h"
+#include "mem.h"
+
+#ifdef HASH_STATS // COUNTS THE LOOKUPS OF EACH MODEL AND THE ONES THAT HIT
+  #define LOOKUP(S, n, x) (++(S)->lookups[n], (S)->found[n] += (x))
+#else
+  #define LOOKUP(S, n, x) (x)
+#endif
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+SCRATCH *CreateScratch(CModel **Models, uint32_t nModels){
+  uint32_t n;
+  ARENA    *A = CreateArena();
+  SCRATCH  *S = (SCRATCH *) ArenaCalloc(A, 1, sizeof(SCRATCH));
+
+  S->A         = A;
+  S->nModels   = nModels;
+  S->totModels = nModels; // EXTRA MODELS DERIVED FROM EDITS
+  for(n = 0 ; n < nModels ; ++n)
+    if(Models[n]->edits != 0)
+      S->totModels += 1;
+
+  S->symBuf    = CreateCBufferIn(A, BUFFER_SIZE, BGUARD);
+  S->Shadow    = (CModel **) ArenaCalloc(A, nModels, sizeof(CModel *));
+  for(n = 0 ; n < nModels ; ++n)
+    S->Shadow[n] = CreateShadowModelIn(A, Models[n]);
+  S->pModel    = (PModel **) ArenaCalloc(A, S->totModels, sizeof(PModel *));
+  for(n = 0 ; n < S->totModels ; ++n)
+    S->pModel[n] = CreatePModelIn(A, ALPHABET_SIZE);
+  S->MX        = CreatePModelIn(A, ALPHABET_SIZE);
+  S->PT        = CreateFloatPModelIn(A, ALPHABET_SIZE);
+  S->CMW       = CreateWeightModelIn(A, S->totModels);
+  #ifdef HASH_STATS
+  S->lookups   = (uint64_t *) ArenaCalloc(A, S->totModels, sizeof(uint64_t));
+  S->found     = (uint64_t *) ArenaCalloc(A, S->totModels, sizeof(uint64_t));
+  #endif
+
+  return S;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// BYTES THAT CreateScratch TAKES FOR MODELS WITH THE GIVEN edits (THE SAME 
+// REQUESTS, IN THE SAME ORDER, COUNTED WITHOUT ALLOCATING)
+
+uint64_t ScratchBytes(uint32_t *edits, uint32_t nModels){
+  ARENA    A = { NULL, 0, 0, 0, 0 };
+  uint32_t n, totModels = nModels;
+
+  for(n = 0 ; n < nModels ; ++n)
+    if(edits[n] != 0)
+      totModels += 1;
+
+  ArenaPlan(&A, 1, sizeof(SCRATCH));
+  ArenaPlan(&A, 1, sizeof(CBUF));
+  ArenaPlan(&A, BUFFER_SIZE + BGUARD, sizeof(uint8_t));
+  ArenaPlan(&A, nModels, sizeof(CModel *));
+  for(n = 0 ; n < nModels ; ++n){
+    ArenaPlan(&A, 1, sizeof(CModel));
+    if(edits[n] != 0){
+      ArenaPlan(&A, 1, sizeof(CBUF));
+      ArenaPlan(&A, BUFFER_SIZE + BGUARD, sizeof(uint8_t));
+      ArenaPlan(&A, BGUARD, sizeof(uint8_t));
+      }
+    }
+  ArenaPlan(&A, totModels, sizeof(PModel *));
+  for(n = 0 ; n < totModels + 1 ; ++n){ // pModel AND MX
+    ArenaPlan(&A, 1, sizeof(PModel));
+    ArenaPlan(&A, ALPHABET_SIZE, sizeof(U32));
+    }
+  ArenaPlan(&A, 1, sizeof(FloatPModel));
+  ArenaPlan(&A, ALPHABET_SIZE, sizeof(double));
+  ArenaPlan(&A, 1, sizeof(CMWeight));
+  ArenaPlan(&A, totModels, sizeof(double));
+  #ifdef HASH_STATS
+  ArenaPlan(&A, totModels, sizeof(uint64_t));
+  ArenaPlan(&A, totModels, sizeof(uint64_t));
+  #endif
+
+  return sizeof(ARENA) + A.total;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// CLEANS THE STATE OF THE PREVIOUS RECORD (NOTHING IS FREED OR ALLOCATED)
+
+void ResetScratch(SCRATCH *S){
+  uint32_t n;
+  ResetCBuffer(S->symBuf);
+  for(n = 0 ; n < S->nModels ; ++n)
+    ResetShadowModel(S->Shadow[n]);
+  ResetWeightModel(S->CMW);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// MIXES THE MODELS FOR sym, ONCE THE CONTEXT INDEXES OF THE SHADOWS ARE SET
+
+static double MixIndexed(SCRATCH *S, CModel **Models, uint8_t sym, double 
+gamma){
+  uint32_t n = 0, cModel;
+  double   instant;
+  CBUF     *B = S->symBuf;
+
+  B->buf[B->idx] = sym;
+  memset((void *) S->PT->freqs, 0, ALPHABET_SIZE * sizeof(double));
+  for(cModel = 0 ; cModel < S->nModels ; ++cModel){
+    CModel *CM = S->Shadow[cModel];
+    LOOKUP(S, n, ComputePModel(Models[cModel], S->pModel[n], CM->pModelIdx,
+    CM->alphaDen));
+    ComputeWeightedFreqs(S->CMW->weight[n], S->pModel[n], S->PT);
+    if(CM->edits != 0){
+      ++n;
+      CM->SUBS.seq->buf[CM->SUBS.seq->idx] = sym;
+      CM->SUBS.idx = GetPModelIdxCorr(CM->SUBS.seq->buf+CM->SUBS.seq->idx-1,
+      CM, CM->SUBS.idx);
+      LOOKUP(S, n, ComputePModel(Models[cModel], S->pModel[n], CM->SUBS.idx,
+      CM->SUBS.eDen));
+      ComputeWeightedFreqs(S->CMW->weight[n], S->pModel[n], S->PT);
+      }
+    ++n;
+    }
+
+  ComputeMXProbs(S->PT, S->MX);
+  instant = PModelSymbolLog(S->MX, sym);
+  CalcDecayment(S->CMW, S->pModel, sym, gamma);
+  RenormalizeWeights(S->CMW);
+  CorrectXModels(S->Shadow, S->pModel, sym, S->nModels);
+  UpdateCBuffer(B);
+  return instant;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// MIXES THE MODELS FOR sym, UPDATES THE MIXER AND THE SHADOWS AND RETURNS THE
+// NUMBER OF BITS NEEDED TO REPRESENT sym
+
+double MixSymbol(SCRATCH *S, CModel **Models, uint8_t sym, double gamma){
+  uint32_t cModel;
+  uint8_t  *symPos = &S->symBuf->buf[S->symBuf->idx-1];
+
+  for(cModel = 0 ; cModel < S->nModels ; ++cModel)
+    GetPModelIdx(symPos, S->Shadow[cModel]);
+  return MixIndexed(S, Models, sym, gamma);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// MIXES sym FOR K MODEL SETS WITH THE SAME PARAMETERS (instant[k] FOR SET k).
+// THE CONTEXT INDEXES ONLY DEPEND ON THE PAST SYMBOLS, SO THEY ARE COMPUTED 
+// ONCE (WITH THE SHADOWS OF S[0]) AND SHARED. THE MIXERS AND THE TOLERANT 
+// MODELS DEPEND ON THE PREDICTIONS, SO THEY ARE KEPT FOR EACH SET.
+
+void MixSymbolBatch(SCRATCH **S, CModel ***Models, uint32_t K, uint8_t sym,
+double gamma, double *instant){
+  uint32_t cModel, k;
+  uint8_t  *symPos = &S[0]->symBuf->buf[S[0]->symBuf->idx-1];
+
+  for(cModel = 0 ; cModel < S[0]->nModels ; ++cModel){
+    GetPModelIdx(symPos, S[0]->Shadow[cModel]);
+    for(k = 1 ; k < K ; ++k)
+      S[k]->Shadow[cModel]->pModelIdx = S[0]->Shadow[cModel]->pModelIdx;
+    }
+  for(k = 0 ; k < K ; ++k)
+    instant[k] = MixIndexed(S[k], Models[k], sym, gamma);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void RemoveScratch(SCRATCH *S){
+  RemoveArena(S->A); // S ITSELF LIVES IN THE ARENA
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -0,0 +1,44 @@
+#ifndef SCRATCH_H_INCLUDED
+#define SCRATCH_H_INCLUDED
+
+#include "defs.h"
+#include "arena.h"
+#include "buffer.h"
+#include "models.h"
+#include "pmodels.h"
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// PER-THREAD STATE USED TO SCORE A RECORD AGAINST THE SHARED MODELS. IT IS 
+// ALLOCATED ONCE INSIDE AN ARENA AND RESET IN PLACE BETWEEN RECORDS, HENCE 
+// THE HOT LOOP DOES NOT CALL THE ALLOCATOR.
+
+typedef struct{
+  ARENA       *A;
+  uint32_t    nModels;
+  uint32_t    totModels;     // nModels PLUS THE TOLERANT (SUBS) MODELS
+  CBUF        *symBuf;
+  CModel      **Shadow;      // SHADOWS FOR SUPPORTING MODELS WITH THREADING
+  PModel      **pModel;
+  PModel      *MX;
+  FloatPModel *PT;
+  CMWeight    *CMW;
+  #ifdef HASH_STATS
+  uint64_t    *lookups;      // Of each of the totModels (SEE defs.h)
+  uint64_t    *found;        // Lookups whose context was in the table
+  #endif
+  }
+SCRATCH;
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+SCRATCH    *CreateScratch   (CModel **, uint32_t);
+uint64_t   ScratchBytes     (uint32_t *, uint32_t);
+void       ResetScratch     (SCRATCH *);
+double     MixSymbol        (SCRATCH *, CModel **, uint8_t, double);
+void       MixSymbolBatch   (SCRATCH **, CModel ***, uint32_t, uint8_t, double,
+                            double *);
+void       RemoveScratch    (SCRATCH *);
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#endif
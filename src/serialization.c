@@ -3,19 +3,68 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <sys/stat.h>
 #include "serialization.h"
 #include "mem.h"
 #include "common.h"
 
-// Helper function to serialize a hashtable to file
-static int SerializeHashTable(FILE *F, HashTable *HT) {
-  // Write index array in one go
-  if(fwrite(HT->index, sizeof(ENTMAX), HASH_SIZE, F) != HASH_SIZE)
-    return -1;
+// All the n bytes at b are zero: the first is zero and each one equals the
+// next
+static int AllZero(const void *b, size_t n) {
+  return ((const uint8_t *) b)[0] == 0 && memcmp(b, (const uint8_t *) b + 1,
+         n - 1) == 0;
+}
+
+// First used bucket from k on (HASH_SIZE if none). A bucket is used once a
+// key was inserted in it: a used entry is never all zeros (its counters
+// start at one) and the index moves on each insertion. Most buckets of a
+// model are unused, so whole blocks of them are skipped at once
+static uint32_t NextUsedBucket(HashTable *HT, uint32_t k) {
+  uint32_t n;
+  while(k < HASH_SIZE) {
+    n = HASH_SIZE - k < MODEL_SCAN_BLOCK ? HASH_SIZE - k : MODEL_SCAN_BLOCK;
+    if(k % MODEL_SCAN_BLOCK == 0 && AllZero(&HT->index[k], n *
+       sizeof(ENTMAX)) && AllZero(HT->entries[k], (size_t) n * HT->maxC *
+       sizeof(Entry))) {
+      k += n;
+      continue;
+    }
+    if(HT->index[k] != 0 || !AllZero(HT->entries[k], HT->maxC *
+       sizeof(Entry)))
+      return k;
+    k++;
+  }
+  return HASH_SIZE;
+}
+
+// First trained context from k on (nPModels if none), skipping whole blocks
+// of untrained ones
+static uint64_t NextUsedContext(Array *AR, uint64_t nPModels, uint64_t k) {
+  uint64_t n;
+  while(k < nPModels) {
+    n = nPModels - k < MODEL_SCAN_BLOCK ? nPModels - k : MODEL_SCAN_BLOCK;
+    if(k % MODEL_SCAN_BLOCK == 0 && AllZero(&AR->counters[k << 2], (n << 2) *
+       sizeof(ACC))) {
+      k += n;
+      continue;
+    }
+    if(!AllZero(&AR->counters[k << 2], 4 * sizeof(ACC)))
+      return k;
+    k++;
+  }
+  return nPModels;
+}
 
-  // Write entries more efficiently - single write per hash index
-  for(uint32_t i = 0; i < HASH_SIZE; i++) {
-    if(fwrite(HT->entries[i], sizeof(Entry), HT->maxC, F) != HT->maxC)
+// Helper function to serialize a hashtable to file: only the used buckets
+// (position, index and entries) are written and counted in used
+static int SerializeHashTable(FILE *F, HashTable *HT, uint64_t *used) {
+  for(uint32_t k = NextUsedBucket(HT, 0); k < HASH_SIZE;
+      k = NextUsedBucket(HT, k + 1), ++*used) {
+    if(fwrite(&k, sizeof(uint32_t), 1, F) != 1 ||
+       fwrite(&HT->index[k], sizeof(ENTMAX), 1, F) != 1 ||
+       fwrite(HT->entries[k], sizeof(Entry), HT->maxC, F) != HT->maxC)
       return -2;
   }
 
@@ -23,46 +72,77 @@ static int SerializeHashTable(FILE *F, HashTable *HT) {
 }
 
 // Helper function to deserialize a hashtable from file
-static int DeserializeHashTable(FILE *F, HashTable *HT, uint32_t col) {
+static int DeserializeHashTable(FILE *F, HashTable *HT, uint32_t col,
+uint32_t version) {
   // Initialize hash table
   HT->maxC = col;
-  HT->index = (ENTMAX *) Calloc(HASH_SIZE, sizeof(ENTMAX));
-  HT->entries = (Entry **) Calloc(HASH_SIZE, sizeof(Entry *));
-  if(!HT->index || !HT->entries)
+  HT->index = (ENTMAX *) TryCalloc(HASH_SIZE, sizeof(ENTMAX));
+  if(!HT->index || InitHashBuckets(HT) != 0)
     return -1;
 
-  // Read index array
-  if(fread(HT->index, sizeof(ENTMAX), HASH_SIZE, F) != HASH_SIZE)
-    return -2;
+  if(version == MODEL_VERSION_DENSE) {
+    // Read index array
+    if(fread(HT->index, sizeof(ENTMAX), HASH_SIZE, F) != HASH_SIZE)
+      return -2;
 
-  // Allocate and read each hash entry block
-  for(uint32_t i = 0; i < HASH_SIZE; i++) {
-    HT->entries[i] = (Entry *) Calloc(HT->maxC, sizeof(Entry));
-    if(!HT->entries[i])
-      return -3;
+    // Read all the buckets at once: they are one slab
+    size_t size = (size_t) HASH_SIZE * HT->maxC;
+    if(fread(HT->entries[0], sizeof(Entry), size, F) != size)
+      return -4;
+    return 0;
+  }
 
-    // Read entire entry array at once
-    if(fread(HT->entries[i], sizeof(Entry), HT->maxC, F) != HT->maxC)
+  uint64_t used;
+  uint32_t k;
+  if(fread(&used, sizeof(uint64_t), 1, F) != 1 || used > HASH_SIZE)
+    return -2;
+  while(used--) {
+    if(fread(&k, sizeof(uint32_t), 1, F) != 1 || k >= HASH_SIZE ||
+       fread(&HT->index[k], sizeof(ENTMAX), 1, F) != 1 ||
+       fread(HT->entries[k], sizeof(Entry), HT->maxC, F) != HT->maxC)
       return -4;
   }
 
   return 0;
 }
 
-// Helper function to serialize an array to file
-static int SerializeArray(FILE *F, Array *AR, uint64_t nPModels) {
-  uint64_t size = nPModels << 2; // * 4 for ACGT
-  return fwrite(AR->counters, sizeof(ACC), size, F) != size ? -1 : 0;
+// Helper function to serialize an array to file: only the trained contexts
+// (position and 4 counters) are written and counted in used
+static int SerializeArray(FILE *F, Array *AR, uint64_t nPModels,
+uint64_t *used) {
+  for(uint64_t k = NextUsedContext(AR, nPModels, 0); k < nPModels;
+      k = NextUsedContext(AR, nPModels, k + 1), ++*used) {
+    uint32_t pos = k;
+    if(fwrite(&pos, sizeof(uint32_t), 1, F) != 1 ||
+       fwrite(&AR->counters[k << 2], sizeof(ACC), 4, F) != 4)
+      return -2;
+  }
+
+  return 0;
 }
 
 // Helper function to deserialize an array from file
-static int DeserializeArray(FILE *F, Array *AR, uint64_t nPModels) {
+static int DeserializeArray(FILE *F, Array *AR, uint64_t nPModels,
+uint32_t version) {
   uint64_t size = nPModels << 2; // * 4 for ACGT
-  AR->counters = (ACC *) Calloc(size, sizeof(ACC));
+  AR->counters = (ACC *) TryCalloc(size, sizeof(ACC));
   if(!AR->counters)
     return -1;
-    
-  return fread(AR->counters, sizeof(ACC), size, F) != size ? -2 : 0;
+
+  if(version == MODEL_VERSION_DENSE)
+    return fread(AR->counters, sizeof(ACC), size, F) != size ? -2 : 0;
+
+  uint64_t used;
+  uint32_t k;
+  if(fread(&used, sizeof(uint64_t), 1, F) != 1 || used > nPModels)
+    return -2;
+  while(used--) {
+    if(fread(&k, sizeof(uint32_t), 1, F) != 1 || k >= nPModels ||
+       fread(&AR->counters[(uint64_t) k << 2], sizeof(ACC), 4, F) != 4)
+      return -3;
+  }
+
+  return 0;
 }
 
 int SaveModels(const char *filename, CModel **Models, uint32_t nModels, uint32_t col) {
@@ -72,8 +152,11 @@ int SaveModels(const char *filename, CModel **Models, uint32_t nModels, uint32_t
     return -1;
   }
 
-  // Use common file handler with error checking
-  FILE *F = Fopen(filename, "wb");
+  FILE *F = fopen(filename, "wb");
+  if(!F) {
+    fprintf(stderr, "Error: cannot write the model file %s\n", filename);
+    return -2;
+  }
 
   // Write file header
   ModelHeader header;
@@ -88,7 +171,7 @@ int SaveModels(const char *filename, CModel **Models, uint32_t nModels, uint32_t
 
   if(fwrite(&header, sizeof(ModelHeader), 1, F) != 1) {
     fprintf(stderr, "Error writing model file header\n");
-    Fclose(F);
+    fclose(F);
     return -3;
   }
 
@@ -97,7 +180,7 @@ int SaveModels(const char *filename, CModel **Models, uint32_t nModels, uint32_t
     CModel *M = Models[n];
     if(!M) {
       fprintf(stderr, "Error: NULL model at index %u\n", n);
-      Fclose(F);
+      fclose(F);
       return -4;
     }
 
@@ -114,9 +197,14 @@ int SaveModels(const char *filename, CModel **Models, uint32_t nModels, uint32_t
     entryHeader.maxCount = M->maxCount;
     entryHeader.multiplier = M->multiplier;
 
-    if(fwrite(&entryHeader, sizeof(ModelMeta), 1, F) != 1) {
+    // The data size and the number of stored units (used) are known after
+    // the data is written: they are written again then
+    uint64_t used = 0;
+    off_t at = ftello(F);
+    if(fwrite(&entryHeader, sizeof(ModelMeta), 1, F) != 1 ||
+       fwrite(&used, sizeof(uint64_t), 1, F) != 1) {
       fprintf(stderr, "Error writing model entry header for model %u\n", n);
-      Fclose(F);
+      fclose(F);
       return -5;
     }
 
@@ -124,22 +212,33 @@ int SaveModels(const char *filename, CModel **Models, uint32_t nModels, uint32_t
     int result = 0;
     switch(M->mode) {
       case HASH_TABLE_MODE:
-        result = SerializeHashTable(F, &M->hTable);
+        result = SerializeHashTable(F, &M->hTable, &used);
         break;
       case ARRAY_MODE:
-        result = SerializeArray(F, &M->array, M->nPModels);
+        result = SerializeArray(F, &M->array, M->nPModels, &used);
         break;
       default:
         fprintf(stderr, "Unknown model mode: %u\n", M->mode);
-        Fclose(F);
+        fclose(F);
         return -6;
     }
 
     if(result != 0) {
       fprintf(stderr, "Error serializing model %u data: %d\n", n, result);
-      Fclose(F);
+      fclose(F);
       return -7;
     }
+
+    off_t end = ftello(F);
+    entryHeader.dataSize = end - at - sizeof(ModelMeta);
+    if(fseeko(F, at, SEEK_SET) != 0 ||
+       fwrite(&entryHeader, sizeof(ModelMeta), 1, F) != 1 ||
+       fwrite(&used, sizeof(uint64_t), 1, F) != 1 ||
+       fseeko(F, end, SEEK_SET) != 0) {
+      fprintf(stderr, "Error writing model entry header for model %u\n", n);
+      fclose(F);
+      return -5;
+    }
   }
 
   // Ensure data is committed to disk
@@ -149,7 +248,10 @@ int SaveModels(const char *filename, CModel **Models, uint32_t nModels, uint32_t
     fsync(fd);
   }
   
-  Fclose(F);
+  if(fclose(F) != 0) {
+    fprintf(stderr, "Error writing the model file %s\n", filename);
+    return -8;
+  }
   return 0;
 }
 
@@ -164,34 +266,37 @@ int LoadModels(const char *filename, CModel ***ModelsPtr, uint32_t *nModels, uin
   *nModels = 0;
   *col = 0;
 
-  // Use common file handler with error checking
-  FILE *F = Fopen(filename, "rb");
+  FILE *F = fopen(filename, "rb");
+  if(!F) {
+    fprintf(stderr, "Error: cannot read the model file %s\n", filename);
+    return -2;
+  }
 
   // Read file header
   ModelHeader header;
   if(fread(&header, sizeof(ModelHeader), 1, F) != 1) {
     fprintf(stderr, "Error reading model file header\n");
-    Fclose(F);
+    fclose(F);
     return -3;
   }
 
   // Validate header
   if(header.magic != MODEL_MAGIC_NUMBER) {
     fprintf(stderr, "Error: Invalid model file format (wrong magic number)\n");
-    Fclose(F);
+    fclose(F);
     return -4;
   }
 
-  if(header.version != MODEL_VERSION) {
+  if(header.version != MODEL_VERSION && header.version != MODEL_VERSION_DENSE) {
     fprintf(stderr, "Error: Unsupported model file version: %u\n", header.version);
-    Fclose(F);
+    fclose(F);
     return -5;
   }
 
   if(header.alphabetSize != ALPHABET_SIZE) {
     fprintf(stderr, "Error: Model file has different alphabet size: %u (expected %u)\n",
             header.alphabetSize, ALPHABET_SIZE);
-    Fclose(F);
+    fclose(F);
     return -6;
   }
 
@@ -211,7 +316,7 @@ int LoadModels(const char *filename, CModel ***ModelsPtr, uint32_t *nModels, uin
       fprintf(stderr, "Error reading model entry header for model %u\n", n);
       // Free already loaded models
       FreeLoadedModels(Models, n);
-      Fclose(F);
+      fclose(F);
       return -8;
     }
 
@@ -246,22 +351,23 @@ int LoadModels(const char *filename, CModel ***ModelsPtr, uint32_t *nModels, uin
     int result = 0;
     switch(M->mode) {
       case HASH_TABLE_MODE:
-        result = DeserializeHashTable(F, &M->hTable, header.maxCollisions);
+        result = DeserializeHashTable(F, &M->hTable, header.maxCollisions,
+                                      header.version);
         break;
       case ARRAY_MODE:
-        result = DeserializeArray(F, &M->array, M->nPModels);
+        result = DeserializeArray(F, &M->array, M->nPModels, header.version);
         break;
       default:
         fprintf(stderr, "Unknown model mode: %u\n", M->mode);
         FreeLoadedModels(Models, n+1);
-        Fclose(F);
+        fclose(F);
         return -12;
     }
 
     if(result != 0) {
       fprintf(stderr, "Error deserializing model %u data: %d\n", n, result);
       FreeLoadedModels(Models, n+1);
-      Fclose(F);
+      fclose(F);
       return -13;
     }
   }
@@ -270,7 +376,7 @@ int LoadModels(const char *filename, CModel ***ModelsPtr, uint32_t *nModels, uin
   *nModels = header.nModels;
   *col = header.maxCollisions;
   
-  Fclose(F);
+  fclose(F);
   return 0;
 }
 
@@ -286,26 +392,112 @@ void FreeLoadedModels(CModel **Models, uint32_t nModels) {
   Free(Models);
 }
 
+// FNV-1a hash of n bytes, continuing from h
+uint64_t Fnv64(uint64_t h, const void *data, size_t n) {
+  const uint8_t *b = (const uint8_t *) data;
+  for(size_t i = 0; i < n; i++) {
+    h ^= b[i];
+    h *= 0x100000001b3ULL;
+  }
+  return h;
+}
+
+uint64_t ModelParamsHash(uint64_t h, ModelPar *MP, uint32_t nModels,
+uint32_t col) {
+  uint32_t key[5];
+
+  // The parameters that change the trained counters
+  key[0] = MODEL_VERSION;
+  key[1] = HASH_SIZE;
+  key[2] = col;
+  key[3] = nModels;
+  key[4] = sizeof(Entry);
+  h = Fnv64(h, key, sizeof(key));
+  for(uint32_t n = 0; n < nModels; n++) {
+    key[0] = MP[n].ctx;
+    key[1] = MP[n].den;
+    key[2] = MP[n].ir != 0;
+    key[3] = MP[n].edits;
+    key[4] = MP[n].edits != 0 ? MP[n].eDen : 0;
+    h = Fnv64(h, key, sizeof(key));
+  }
+  return h;
+}
+
+int CreateModelCache(const char *dir) {
+  if(mkdir(dir, 0755) != 0 && errno != EEXIST) {
+    fprintf(stderr, "  [x] Error: cannot create model cache directory %s!\n", dir);
+    return -1;
+  }
+  return 0;
+}
+
+uint64_t FileHash(uint64_t h, const char *fileName) {
+  FILE     *F = fopen(fileName, "rb");
+  uint8_t  *buf;
+  size_t   k;
+
+  if(!F)
+    return h;
+  buf = (uint8_t *) Malloc(BUFFER_SIZE);
+  while((k = fread(buf, 1, BUFFER_SIZE, F)))
+    h = Fnv64(h, buf, k);
+  fclose(F);
+  Free(buf);
+  return h;
+}
+
+char *ModelCacheName(const char *dir, const char *seqFile, ModelPar *MP,
+uint32_t nModels, uint32_t col) {
+  // The content of the sequence file
+  uint64_t h = FileHash(MODEL_HASH_SEED, seqFile);
+
+  h = ModelParamsHash(h, MP, nModels, col);
+
+  char *name = (char *) Malloc(strlen(dir) + 32);
+  sprintf(name, "%s/%016" PRIx64 ".fcm", dir, h);
+  return name;
+}
+
+int ModelsMatch(CModel **Models, uint32_t nModels, uint32_t col, ModelPar *MP,
+uint32_t nMP, uint32_t mpCol) {
+  if(nModels != nMP)
+    return 0;
+  for(uint32_t n = 0; n < nModels; n++) {
+    CModel *M = Models[n];
+    if(M->ctx != MP[n].ctx || M->alphaDen != MP[n].den ||
+       M->ir != (MP[n].ir != 0) || M->edits != MP[n].edits ||
+       (M->edits != 0 && M->SUBS.eDen != MP[n].eDen) ||
+       (M->mode == HASH_TABLE_MODE && col != mpCol))
+      return 0;
+  }
+  return 1;
+}
+
 void PrintModelInfo(const char *filename) {
   if(!filename) {
     fprintf(stderr, "Error: No filename provided\n");
     return;
   }
   
-  FILE *F = Fopen(filename, "rb");
+  FILE *F = fopen(filename, "rb");
+  if(!F) {
+    fprintf(stderr, "Error: cannot read the model file %s\n", filename);
+    return;
+  }
 
   // Read file header
   ModelHeader header;
   if(fread(&header, sizeof(ModelHeader), 1, F) != 1) {
     fprintf(stderr, "Error reading model file header\n");
-    Fclose(F);
+    fclose(F);
     return;
   }
 
   // Validate header
   if(header.magic != MODEL_MAGIC_NUMBER) {
     fprintf(stderr, "Error: Invalid model file format (wrong magic number)\n");
-    Fclose(F);
+    fclose(F);
     return;
   }
 
@@ -328,7 +520,7 @@ void PrintModelInfo(const char *filename) {
     ModelMeta entryHeader;
     if(fread(&entryHeader, sizeof(ModelMeta), 1, F) != 1) {
       fprintf(stderr, "Error reading model entry header for model %u\n", n);
-      Fclose(F);
+      fclose(F);
       return;
     }
 
@@ -347,18 +539,20 @@ void PrintModelInfo(const char *filename) {
     }
 
     // Skip model data for display purposes
-    if(entryHeader.mode == HASH_TABLE_MODE) {
+    if(header.version != MODEL_VERSION_DENSE) {
+      fseeko(F, entryHeader.dataSize, SEEK_CUR);
+    } else if(entryHeader.mode == HASH_TABLE_MODE) {
       // Skip index array
-      Fseeko(F, HASH_SIZE * sizeof(ENTMAX), SEEK_CUR);
+      fseeko(F, HASH_SIZE * sizeof(ENTMAX), SEEK_CUR);
 
       // Skip hash entries (more efficiently)
-      Fseeko(F, HASH_SIZE * header.maxCollisions * sizeof(Entry), SEEK_CUR);
+      fseeko(F, HASH_SIZE * header.maxCollisions * sizeof(Entry), SEEK_CUR);
     } else if(entryHeader.mode == ARRAY_MODE) {
       // Skip array
-      Fseeko(F, (entryHeader.nPModels << 2) * sizeof(ACC), SEEK_CUR);
+      fseeko(F, (entryHeader.nPModels << 2) * sizeof(ACC), SEEK_CUR);
     }
   }
   fprintf(stderr, "\n");
 
-  Fclose(F);
+  fclose(F);
 }
\ No newline at end of file
@@ -8,7 +8,10 @@
 
 // Magic number to identify valid serialized model files
 #define MODEL_MAGIC_NUMBER     0x46414C434F4E4D53 // "FALCONMS" in hex (FALCON Model Serialization)
-#define MODEL_VERSION          1                  // Version of the serialization format
+#define MODEL_VERSION          2                  // Version of the serialization format (sparse)
+#define MODEL_VERSION_DENSE    1                  // Older format (all the counters), still read
+#define MODEL_SCAN_BLOCK       16                 // Buckets (or contexts) checked at once when saving
+#define MODEL_HASH_SEED        0xcbf29ce484222325ULL // FNV-1a offset basis
 
 typedef struct {
     uint64_t magic;              // Magic number for validation
@@ -70,4 +73,64 @@ void FreeLoadedModels(CModel **Models, uint32_t nModels);
  */
 void PrintModelInfo(const char *filename);
 
+/**
+ * FNV-1a hash of n bytes
+ *
+ * @param h Hash to continue (MODEL_HASH_SEED to start)
+ * @param data The bytes to hash
+ * @param n Number of bytes
+ * @return The updated hash
+ */
+uint64_t Fnv64(uint64_t h, const void *data, size_t n);
+
+/**
+ * FNV-1a hash of the content of a file
+ *
+ * @param h Hash to continue (MODEL_HASH_SEED to start)
+ * @param fileName The file to hash
+ * @return The updated hash (h if the file cannot be read)
+ */
+uint64_t FileHash(uint64_t h, const char *fileName);
+
+/**
+ * Hash (FNV-1a) of the model parameters that change the trained counters
+ *
+ * @param h Hash to continue (MODEL_HASH_SEED to start)
+ * @param MP Parameters of the models
+ * @param nModels Number of models
+ * @param col Maximum allowed hash collisions
+ * @return The updated hash
+ */
+uint64_t ModelParamsHash(uint64_t h, ModelPar *MP, uint32_t nModels, uint32_t col);
+
+/**
+ * Create the model cache directory if it does not exist
+ *
+ * @param dir The cache directory
+ * @return 0 on success, -1 if it cannot be created
+ */
+int CreateModelCache(const char *dir);
+
+/**
+ * Name of the cached models of a sequence file: the key hashes the file
+ * content and the parameters that change the trained counters
+ *
+ * @param dir The cache directory
+ * @param seqFile The sequence file the models are trained on
+ * @param MP Parameters of the models
+ * @param nModels Number of models
+ * @param col Maximum allowed hash collisions
+ * @return The allocated path dir/KEY.fcm
+ */
+char *ModelCacheName(const char *dir, const char *seqFile, ModelPar *MP,
+                     uint32_t nModels, uint32_t col);
+
+/**
+ * Check that loaded models were trained with the given parameters
+ *
+ * @return 1 if they match, 0 otherwise
+ */
+int ModelsMatch(CModel **Models, uint32_t nModels, uint32_t col, ModelPar *MP,
+                uint32_t nMP, uint32_t mpCol);
+
 #endif //SERIALIZATION_H
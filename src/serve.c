@@ -0,0 +1,217 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "serve.h"
+#include "libfalcon.h"
+#include "parser.h"
+#include "common.h"
+#include "file_compression.h"
+#include "mem.h"
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void PutBase(PACKDB *D, uint64_t *maxBytes, uint8_t sym){
+  uint64_t i = D->nBases++, add;
+  uint8_t  shift = (i & 3) << 1;
+
+  if((i >> 2) == *maxBytes){
+    add = *maxBytes < BUFFER_SIZE ? BUFFER_SIZE : *maxBytes;
+    D->seq = (uint8_t *) Realloc(D->seq, *maxBytes + add, add);
+    *maxBytes += add;
+    }
+  // A DROPPED RECORD MAY LEAVE OLD BASES IN THE LAST BYTE
+  D->seq[i >> 2] = (D->seq[i >> 2] & ~(3 << shift)) | (sym << shift);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void AddRecord(PACKDB *D, uint8_t *name, uint32_t db, uint64_t rec){
+  if(D->nRecords + 1 == D->maxRecords){
+    D->start = (uint64_t *) Realloc(D->start, (D->maxRecords + 4096) *
+    sizeof(uint64_t), 4096 * sizeof(uint64_t));
+    D->name  = (uint32_t *) Realloc(D->name, (D->maxRecords + 4096) *
+    sizeof(uint32_t), 4096 * sizeof(uint32_t));
+    D->db    = (uint32_t *) Realloc(D->db, (D->maxRecords + 4096) *
+    sizeof(uint32_t), 4096 * sizeof(uint32_t));
+    D->rec   = (uint64_t *) Realloc(D->rec, (D->maxRecords + 4096) *
+    sizeof(uint64_t), 4096 * sizeof(uint64_t));
+    D->maxRecords += 4096;
+    }
+  D->name[D->nRecords] = InternString(D->names, (char *) name);
+  D->db[D->nRecords]   = db;
+  D->rec[D->nRecords]  = rec;
+  D->start[++D->nRecords] = D->nBases;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// THE RECORD SPLIT AND HEADER CLEANING OF THE SCANS (FalconParse)
+
+PACKDB *CreatePackDb(char **files, uint32_t nFiles){
+  PACKDB   *D = (PACKDB *) Calloc(1, sizeof(PACKDB));
+  uint8_t  *readBuf = (uint8_t *) Calloc(BUFFER_SIZE, sizeof(uint8_t));
+  uint8_t  sym, conName[MAX_NAME];
+  uint64_t nBase, maxBytes = 0;
+  uint32_t f, k, idxPos, r;
+  PARSER   *PA;
+  FILE     *Reader;
+  int      action;
+
+  D->names      = CreateStrTab();
+  D->maxRecords = 4096;
+  D->start      = (uint64_t *) Calloc(D->maxRecords, sizeof(uint64_t));
+  D->name       = (uint32_t *) Calloc(D->maxRecords, sizeof(uint32_t));
+  D->db         = (uint32_t *) Calloc(D->maxRecords, sizeof(uint32_t));
+  D->rec        = (uint64_t *) Calloc(D->maxRecords, sizeof(uint64_t));
+
+  for(f = 0 ; f < nFiles ; ++f){
+    Reader = CFopen(files[f], "r");
+    PA     = CreateParser();
+    nBase  = r = 0;
+    conName[0] = '\0';
+    while((k = fread(readBuf, 1, BUFFER_SIZE, Reader)))
+      for(idxPos = 0 ; idxPos < k ; ++idxPos){
+        if((action = FalconParse(PA, readBuf[idxPos], conName, &r)) < 0){
+          if(action == -1){ // A NEW RECORD: THE LAST ONE IS DONE
+            if(PA->nRead > 1 && nBase > 1)
+              AddRecord(D, conName, f, PA->nRead-1);
+            else
+              D->nBases = D->start[D->nRecords];
+            nBase = 0;
+            }
+          continue;
+          }
+        if((sym = DNASymToNum(action)) == 4)
+          continue; // IT IGNORES EXTRA SYMBOLS
+        PutBase(D, &maxBytes, sym);
+        ++nBase;
+        }
+    if(nBase > 0)
+      AddRecord(D, conName, f, PA->nRead);
+    else
+      D->nBases = D->start[D->nRecords];
+    RemoveParser(PA);
+    fclose(Reader);
+    }
+
+  Free(readBuf);
+  return D;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void RemovePackDb(PACKDB *D){
+  if(D->seq != NULL)
+    Free(D->seq);
+  Free(D->start);
+  Free(D->name);
+  Free(D->db);
+  Free(D->rec);
+  DeleteStrTab(D->names);
+  Free(D);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static int SocketAddr(char *path, struct sockaddr_un *addr){
+  if(strlen(path) >= sizeof(addr->sun_path)){
+    fprintf(stderr, "  [x] Error: the socket path %s is too long!\n", path);
+    exit(1);
+    }
+  memset(addr, 0, sizeof(struct sockaddr_un));
+  addr->sun_family = AF_UNIX;
+  strcpy(addr->sun_path, path);
+  return socket(AF_UNIX, SOCK_STREAM, 0);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// A SOCKET LEFT BY A SERVER THAT DIED IS REPLACED, A LIVE ONE IS AN ERROR
+
+int ServeListen(char *path){
+  struct sockaddr_un addr;
+  struct stat st;
+  int    fd;
+
+  if(stat(path, &st) == 0){
+    if(!S_ISSOCK(st.st_mode)){
+      fprintf(stderr, "  [x] Error: %s exists and is not a socket!\n", path);
+      exit(1);
+      }
+    if((fd = ServeConnect(path)) >= 0){
+      close(fd);
+      fprintf(stderr, "  [x] Error: a server is already listening on %s!\n",
+      path);
+      exit(1);
+      }
+    unlink(path);
+    }
+
+  if((fd = SocketAddr(path, &addr)) < 0 || bind(fd, (struct sockaddr *)
+  &addr, sizeof(addr)) != 0 || listen(fd, SERVE_BACKLOG) != 0){
+    fprintf(stderr, "  [x] Error: unable to listen on %s!\n", path);
+    exit(1);
+    }
+  return fd;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+int ServeConnect(char *path){
+  struct sockaddr_un addr;
+  int    fd;
+
+  if((fd = SocketAddr(path, &addr)) < 0)
+    return -1;
+  if(connect(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0){
+    close(fd);
+    return -1;
+    }
+  return fd;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// THE NEXT CONNECTION, WITH A RECEIVE TIMEOUT OF SERVE_WAIT SECONDS: THE JOBS
+// RUN ONE AT A TIME, SO A CLIENT THAT CONNECTS AND SENDS NOTHING WOULD STALL
+// ALL THE ONES QUEUED BEHIND IT. RETURNS -1 IF accept FAILS.
+
+int ServeAccept(int lfd){
+  struct timeval wait = { SERVE_WAIT, 0 };
+  int    fd;
+
+  if((fd = accept(lfd, NULL, NULL)) < 0)
+    return -1;
+  if(setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &wait, sizeof(wait)) != 0){
+    close(fd);
+    return -1;
+    }
+  return fd;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// READS A LINE (WITHOUT THE '\n'). RETURNS ITS LENGTH OR -1 IF THE PEER
+// CLOSED BEFORE SENDING ONE, IT DOES NOT FIT IN max BYTES OR THE READ FAILED
+// (A TIMEOUT OF ServeAccept)
+
+int ReadJobLine(int fd, char *line, uint32_t max){
+  uint32_t n = 0;
+  ssize_t  k;
+  char     c;
+
+  while((k = read(fd, &c, 1)) == 1){
+    if(c == '\n'){
+      line[n] = '\0';
+      return n;
+      }
+    if(n + 1 == max)
+      return -1;
+    line[n++] = c;
+    }
+  line[n] = '\0';
+  return n == 0 || k < 0 ? -1 : (int) n;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -0,0 +1,50 @@
+#ifndef SERVE_H_INCLUDED
+#define SERVE_H_INCLUDED
+
+#include <stdio.h>
+#include "defs.h"
+#include "strtab.h"
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// RESIDENT DATABASE OF THE SERVER: THE RECORDS OF ALL THE DATABASE FILES ARE
+// PARSED ONCE AND KEPT PACKED (2 BITS PER BASE, ONLY ACGT, AS THE SCAN
+// IGNORES THE OTHER SYMBOLS). THE RECORDS ARE THE ONES meta REPORTS: A RECORD
+// WITH LESS THAN TWO BASES IS ONLY KEPT WHEN IT ENDS ITS FILE.
+//
+// THE JOBS ARE ONE LINE "SAMPLE [LEVEL] [TOP]" OVER A UNIX DOMAIN SOCKET. THE
+// ANSWER IS STREAMED: PROGRESS LINES STARTING WITH '#' AND THEN THE TOP, AS
+// IN THE meta OUTPUT FILE. A LINE "# error: ..." ENDS A FAILED JOB.
+
+#define SERVE_SOCKET   "falcon.sock"
+#define SERVE_STOP     "quit"         // Job that stops the server
+#define SERVE_LINE     65536          // Maximum length of a job line
+#define SERVE_BACKLOG  64
+#define SERVE_WAIT     5              // Seconds a client has to send its job
+
+typedef struct{
+  uint8_t  *seq;              // 4 bases per byte
+  uint64_t nBases;
+  uint64_t *start;            // First base of each record (nRecords + 1)
+  uint32_t *name;             // Header id in names
+  uint32_t *db;               // Database file of each record
+  uint64_t *rec;              // Index of each record in its file (as meta)
+  uint64_t nRecords;
+  uint64_t maxRecords;
+  STRTAB   *names;
+  }
+PACKDB;
+
+#define PackDbBase(D, i) (((D)->seq[(i) >> 2] >> (((i) & 3) << 1)) & 3)
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+PACKDB     *CreatePackDb   (char **, uint32_t);
+void       RemovePackDb    (PACKDB *);
+int        ServeListen     (char *);
+int        ServeConnect    (char *);
+int        ServeAccept     (int);
+int        ReadJobLine     (int, char *, uint32_t);
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#endif
@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "sketch.h"
+#include "parser.h"
+#include "common.h"
+#include "mem.h"
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static uint64_t MixHash(uint64_t z){
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+  }
+
+static int CmpHash(const void *a, const void *b){
+  uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+  return x < y ? -1 : x > y;
+  }
+
+static int CmpKey(const void *a, const void *b){
+  const SKETCHKEY *x = (const SKETCHKEY *) a, *y = (const SKETCHKEY *) b;
+  if(x->h != y->h)
+    return x->h < y->h ? -1 : 1;
+  return x->file < y->file ? -1 : x->file > y->file;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// THE k-MERS DO NOT CROSS HEADERS, READS OR BASES OUTSIDE ACGT
+
+SKETCH *CreateSketch(char *fileName){
+  FILE     *Reader = Fopen(fileName, "r");
+  SKETCH   *S = (SKETCH *) Calloc(1, sizeof(SKETCH));
+  PARSER   *PA = CreateParser();
+  uint8_t  *readBuf = (uint8_t *) Calloc(BUFFER_SIZE, sizeof(uint8_t)), sym;
+  uint64_t fw = 0, rc = 0, h, max = 0, i, k, idxPos, len = 0;
+  uint64_t mask = SKETCH_K == 32 ? UINT64_MAX : (1ULL << (2 * SKETCH_K)) - 1;
+  uint64_t limit = UINT64_MAX / SKETCH_SCALE;
+
+  FileType(PA, Reader);
+  rewind(Reader);
+
+  while((k = fread(readBuf, 1, BUFFER_SIZE, Reader)))
+    for(idxPos = 0 ; idxPos < k ; ++idxPos){
+      if((sym = readBuf[idxPos]) == '\r')
+        continue;
+      if(ParseSym(PA, sym) == -1){
+        if(sym != '\n' || PA->type == 2) // HEADER OR END OF A READ
+          len = 0;
+        continue;
+        }
+      if((sym = DNASymToNum(sym)) > 3){
+        len = 0;
+        continue;
+        }
+      fw = ((fw << 2) | sym) & mask;
+      rc = (rc >> 2) | ((uint64_t) (3 - sym) << (2 * (SKETCH_K - 1)));
+      if(++len < SKETCH_K)
+        continue;
+      if((h = MixHash(fw < rc ? fw : rc)) >= limit)
+        continue;
+      if(S->n == max){
+        S->h = (uint64_t *) Realloc(S->h, (max + 4096) * sizeof(uint64_t),
+        4096 * sizeof(uint64_t));
+        max += 4096;
+        }
+      S->h[S->n++] = h;
+      }
+
+  qsort(S->h, S->n, sizeof(uint64_t), CmpHash);
+  for(i = 0, k = 0 ; i < S->n ; ++i)
+    if(k == 0 || S->h[i] != S->h[k-1])
+      S->h[k++] = S->h[i];
+  S->n = k;
+
+  Free(readBuf);
+  RemoveParser(PA);
+  fclose(Reader);
+  return S;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void RemoveSketch(SKETCH *S){
+  if(S->h != NULL)
+    Free(S->h);
+  Free(S);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+SKETCHIDX *CreateSketchIdx(SKETCH **S, uint32_t nSketches){
+  SKETCHIDX *I = (SKETCHIDX *) Calloc(1, sizeof(SKETCHIDX));
+  uint64_t  i, k = 0;
+  uint32_t  n;
+
+  I->S         = S;
+  I->nSketches = nSketches;
+  for(n = 0 ; n < nSketches ; ++n)
+    I->nKeys += S[n]->n;
+  I->keys = (SKETCHKEY *) Malloc((I->nKeys + 1) * sizeof(SKETCHKEY));
+  for(n = 0 ; n < nSketches ; ++n)
+    for(i = 0 ; i < S[n]->n ; ++i){
+      I->keys[k].h    = S[n]->h[i];
+      I->keys[k].file = n;
+      ++k;
+      }
+  qsort(I->keys, I->nKeys, sizeof(SKETCHKEY), CmpKey);
+  return I;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// JACCARD ESTIMATES OF FILE a AGAINST ALL THE FILES (J), USING shared AS
+// SCRATCH (nSketches COUNTERS)
+
+void SketchRow(SKETCHIDX *I, uint32_t a, uint32_t *shared, double *J){
+  SKETCH   *A = I->S[a];
+  uint64_t i, lo, hi, mid, un;
+  uint32_t n;
+
+  memset(shared, 0, I->nSketches * sizeof(uint32_t));
+  for(i = 0 ; i < A->n ; ++i){
+    for(lo = 0, hi = I->nKeys ; lo < hi ; ){ // FIRST KEY >= h
+      mid = lo + (hi - lo) / 2;
+      if(I->keys[mid].h < A->h[i]) lo = mid + 1;
+      else                         hi = mid;
+      }
+    for( ; lo < I->nKeys && I->keys[lo].h == A->h[i] ; ++lo)
+      ++shared[I->keys[lo].file];
+    }
+
+  for(n = 0 ; n < I->nSketches ; ++n){
+    un   = A->n + I->S[n]->n - shared[n];
+    J[n] = un == 0 ? (n == a) : (double) shared[n] / un;
+    }
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// HASHES THAT BOTH SKETCHES OF A PAIR NEED FOR THE PAIR TO BE SCREENED WITH
+// THE cutoff. A SMALL GENOME GIVES FEW HASHES (ONE PER SKETCH_SCALE k-MERS),
+// SO ITS ESTIMATE IS 0 OR ONE SHARED HASH AWAY FROM THE CUTOFF: SUCH PAIRS
+// ARE COMPRESSED INSTEAD.
+
+uint64_t SketchMinHashes(double cutoff){
+  double min = cutoff > 0 ? ceil(1.0 / cutoff) : 0;
+  return min > SKETCH_MIN ? (uint64_t) min : SKETCH_MIN;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void RemoveSketchIdx(SKETCHIDX *I){
+  Free(I->keys);
+  Free(I);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -0,0 +1,49 @@
+#ifndef SKETCH_H_INCLUDED
+#define SKETCH_H_INCLUDED
+
+#include "defs.h"
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// FRACMINHASH SKETCHES: THE HASHES OF THE CANONICAL k-MERS OF A FILE THAT 
+// ARE BELOW 2^64 / SKETCH_SCALE, SORTED AND UNIQUE. THE JACCARD INDEX OF TWO
+// FILES IS ESTIMATED BY THE ONE OF THEIR SKETCHES. ALL THE SKETCHES ARE 
+// MERGED IN ONE INDEX SORTED BY HASH, SO A ROW (ONE FILE AGAINST ALL) ONLY 
+// VISITS THE FILES THAT SHARE SOME HASH.
+
+#define SKETCH_K       21     // k-mer size (at most 32)
+#define SKETCH_SCALE   1000   // One k-mer out of SKETCH_SCALE is kept
+#define SKETCH_FAR_NDR 1.0    // NDR given to the pairs below the cutoff
+#define SKETCH_MIN     50     // Fewer hashes (or 1/cutoff) are never screened
+
+typedef struct{
+  uint64_t *h;
+  uint64_t n;
+  }
+SKETCH;
+
+typedef struct{
+  uint64_t h;
+  uint32_t file;
+  }
+SKETCHKEY;
+
+typedef struct{
+  SKETCHKEY *keys;            // Hashes of all the sketches, sorted
+  uint64_t  nKeys;
+  SKETCH    **S;
+  uint32_t  nSketches;
+  }
+SKETCHIDX;
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+SKETCH      *CreateSketch     (char *);
+void        RemoveSketch      (SKETCH *);
+SKETCHIDX   *CreateSketchIdx  (SKETCH **, uint32_t);
+void        SketchRow         (SKETCHIDX *, uint32_t, uint32_t *, double *);
+uint64_t    SketchMinHashes   (double);
+void        RemoveSketchIdx   (SKETCHIDX *);
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#endif
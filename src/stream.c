@@ -19,7 +19,7 @@ STREAM *CreateStream(uint64_t size){
 // UPDATE AUX STREAM
 //
 void UpdateStream(STREAM *S, uint8_t sym, SPREC bits){
-  if(++S->idx == S->size){
+  if((uint64_t) S->idx == S->size){
     S->size += S->init;
     S->bases = (uint8_t *) Realloc(S->bases, S->size * sizeof(uint8_t), S->init
                * sizeof(uint8_t));
@@ -28,6 +28,7 @@ void UpdateStream(STREAM *S, uint8_t sym, SPREC bits){
     }
   S->bases[S->idx] = sym;
   S->bits [S->idx] = bits;
+  ++S->idx;
   }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
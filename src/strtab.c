@@ -0,0 +1,143 @@
+#include "strtab.h"
+#include "mem.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STR_NO_ID  UINT32_MAX
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static uint64_t StrHash(const char *s){
+  uint64_t h = 14695981039346656037ULL; // FNV-1a
+  while(*s){
+    h ^= (uint8_t) *s++;
+    h *= 1099511628211ULL;
+    }
+  return h;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static uint32_t PushString(STRTAB *S, const char *s){
+  uint64_t len = strlen(s) + 1;
+  uint8_t  *dst;
+
+  if(S->used + len > STR_BLOCK || S->nBlocks == 0){ // OPEN A NEW BLOCK
+    S->blocks = (uint8_t **) Realloc(S->blocks, (S->nBlocks + 1) * 
+    sizeof(uint8_t *), sizeof(uint8_t *));
+    S->blocks[S->nBlocks++] = (uint8_t *) Malloc(len > STR_BLOCK ? len : 
+    STR_BLOCK);
+    S->used = 0;
+    }
+  dst = S->blocks[S->nBlocks-1] + S->used;
+  memcpy(dst, s, len);
+  S->used += len;
+
+  if(S->nStr == S->maxStr){
+    S->maxStr += STR_CACHE;
+    S->str = (uint8_t **) Realloc(S->str, S->maxStr * sizeof(uint8_t *),
+    STR_CACHE * sizeof(uint8_t *));
+    }
+  S->str[S->nStr] = dst;
+  return S->nStr++;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static uint32_t *HashSlot(STRTAB *S, const char *s){
+  uint32_t idx = StrHash(s) & (S->hSize - 1);
+  while(S->hash[idx] != STR_NO_ID && strcmp((char *) S->str[S->hash[idx]], s))
+    idx = (idx + 1) & (S->hSize - 1);
+  return &S->hash[idx];
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void GrowHash(STRTAB *S){
+  uint32_t n, *old = S->hash, oldSize = S->hSize;
+  S->hSize = oldSize == 0 ? 1024 : oldSize * 2;
+  S->hash  = (uint32_t *) Malloc(S->hSize * sizeof(uint32_t));
+  memset(S->hash, 0xff, S->hSize * sizeof(uint32_t));
+  for(n = 0 ; n < oldSize ; ++n)
+    if(old[n] != STR_NO_ID)
+      *HashSlot(S, (char *) S->str[old[n]]) = old[n];
+  if(old != NULL)
+    Free(old);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+STRTAB *CreateStrTab(void){
+  STRTAB *S = (STRTAB *) Calloc(1, sizeof(STRTAB));
+  pthread_mutex_init(&S->lock, NULL);
+  PushString(S, ""); // ID 0 (STR_EMPTY) IS ALWAYS THE EMPTY STRING
+  return S;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// APPENDS A STRING WITHOUT LOOKING FOR A PREVIOUS COPY (HEADERS ARE UNIQUE).
+
+uint32_t AddString(STRTAB *S, const char *s){
+  uint32_t id;
+  pthread_mutex_lock(&S->lock);
+  id = PushString(S, s);
+  pthread_mutex_unlock(&S->lock);
+  return id;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// RETURNS THE ID OF THE STRING, ADDING IT ONLY IF IT WAS NOT INTERNED BEFORE.
+
+uint32_t InternString(STRTAB *S, const char *s){
+  uint32_t *slot;
+  pthread_mutex_lock(&S->lock);
+  if(2 * (S->nHash + 1) > S->hSize)
+    GrowHash(S);
+  if(*(slot = HashSlot(S, s)) == STR_NO_ID){
+    *slot = PushString(S, s);
+    S->nHash++;
+    }
+  pthread_mutex_unlock(&S->lock);
+  return *slot;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// RETURNS THE ID OF AN INTERNED STRING OR -1 IF IT IS NOT IN THE TABLE.
+
+int64_t FindString(STRTAB *S, const char *s){
+  uint32_t id = STR_NO_ID;
+  pthread_mutex_lock(&S->lock);
+  if(S->hSize != 0)
+    id = *HashSlot(S, s);
+  pthread_mutex_unlock(&S->lock);
+  return id == STR_NO_ID ? -1 : (int64_t) id;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// THE ID TABLE MOVES WHEN IT GROWS, SO IT IS READ UNDER THE LOCK (A THREAD
+// MAY PRINT A TOP WHILE OTHERS ADD TO IT). THE STRING ITSELF NEVER MOVES.
+
+char *GetString(STRTAB *S, uint32_t id){
+  char *s;
+  pthread_mutex_lock(&S->lock);
+  s = (char *) S->str[id];
+  pthread_mutex_unlock(&S->lock);
+  return s;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void DeleteStrTab(STRTAB *S){
+  uint32_t n;
+  for(n = 0 ; n < S->nBlocks ; ++n)
+    Free(S->blocks[n]);
+  Free(S->blocks);
+  Free(S->str);
+  if(S->hash != NULL)
+    Free(S->hash);
+  pthread_mutex_destroy(&S->lock);
+  Free(S);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
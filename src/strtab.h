@@ -0,0 +1,42 @@
+#ifndef STRTAB_H_INCLUDED
+#define STRTAB_H_INCLUDED
+
+#include "defs.h"
+#include <pthread.h>
+
+#define STR_BLOCK  1048576  // BYTES OF EACH ARENA BLOCK
+#define STR_CACHE  1024     // STRING IDS ADDED ON EACH GROWTH
+#define STR_EMPTY  0        // ID OF THE EMPTY STRING
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// ARENA STRING TABLE: EACH STRING IS WRITTEN ONCE IN A LARGE BLOCK AND IT IS
+// REFERRED BY A 32-BIT ID. THE BLOCKS NEVER MOVE, SO THE POINTERS RETURNED BY
+// GetString STAY VALID UNTIL THE TABLE IS DELETED. ADDING AND READING ARE
+// THREAD-SAFE.
+
+typedef struct{
+  uint8_t  **blocks;          // Arena blocks
+  uint32_t nBlocks;
+  uint64_t used;              // Bytes used in the last block
+  uint8_t  **str;             // Start of each string (by id)
+  uint32_t nStr;
+  uint32_t maxStr;
+  uint32_t *hash;             // Ids of the interned strings (open addressing)
+  uint32_t hSize;
+  uint32_t nHash;
+  pthread_mutex_t lock;
+  }
+STRTAB;
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+STRTAB     *CreateStrTab   (void);
+uint32_t   AddString       (STRTAB *, const char *);
+uint32_t   InternString    (STRTAB *, const char *);
+int64_t    FindString      (STRTAB *, const char *);
+char       *GetString      (STRTAB *, uint32_t);
+void       DeleteStrTab    (STRTAB *);
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#endif
@@ -1,25 +1,59 @@
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/resource.h>
 #include "time.h"
 #include "mem.h"
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-static void PrintCalc(char *text, clock_t t){
-  uint32_t seconds = t / CLOCKS_PER_SEC;
+static void PrintCalc(char *text, char *kind, double t){
+  uint32_t seconds = t;
   if(seconds <= 60)
-    fprintf(stdout, "%s CPU time: %u second(s).\n", text, seconds);
+    fprintf(stdout, "%s %s time: %u second(s).\n", text, kind, seconds);
   else if(seconds <= 3600)
-    fprintf(stdout, "%s CPU time: %u minute(s) and %u second(s).\n", text, 
-    seconds / 60, seconds % 60);
+    fprintf(stdout, "%s %s time: %u minute(s) and %u second(s).\n", text, 
+    kind, seconds / 60, seconds % 60);
   else
-    fprintf(stdout, "%s CPU time: %u hour(s) and %u minute(s).\n", text, 
-    seconds / 3600, seconds % 3600);
+    fprintf(stdout, "%s %s time: %u hour(s) and %u minute(s).\n", text, 
+    kind, seconds / 3600, seconds % 3600 / 60);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// clock() IS THE CPU TIME OF ALL THE THREADS, SO THE WALL TIME IS KEPT TOO.
+// SECONDS OF A MONOTONIC CLOCK: THE ONE OF THE STATISTICS, THE CHECKPOINTS
+// AND THE SERVER.
+
+double WallClock(void){
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+double CpuClock(void){
+  struct timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// PEAK RESIDENT SET SIZE OF THE PROCESS IN KB
+
+uint64_t PeakRSS(void){
+  struct rusage ru;
+  if(getrusage(RUSAGE_SELF, &ru) != 0)
+    return 0;
+  return (uint64_t) ru.ru_maxrss;
   }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 TIME *CreateClock(clock_t t){
   TIME *Time = (TIME *) Calloc(1, sizeof(TIME));
-  Time->cpu_start = t;
+  Time->cpu_start  = t;
+  Time->wall_start = WallClock();
   return Time;
   }
 
@@ -33,7 +67,8 @@ void StopTimeNDRM(TIME *Time, clock_t t){
 
 void StopCalcAll(TIME *Time, clock_t t){
   Time->cpu_total = t - Time->cpu_start;
-  PrintCalc("Total", Time->cpu_total);
+  PrintCalc("Total", "CPU", (double) Time->cpu_total / CLOCKS_PER_SEC);
+  PrintCalc("Total", "wall", WallClock() - Time->wall_start);
   }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -42,4 +77,215 @@ void RemoveClock(TIME *Time){
   Free(Time);
   }
 
+//////////////////////////////////////////////////////////////////////////////
+// - - - - - - - - - - - - - - - - S T A T S - - - - - - - - - - - - - - - - -
+
+STATS *CreateStats(uint32_t nThreads){
+  STATS *S    = (STATS *) Calloc(1, sizeof(STATS));
+  S->nThreads = nThreads == 0 ? 1 : nThreads;
+  S->start    = WallClock();
+  S->cpuStart = CpuClock();
+  return S;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// OPENS A PHASE (file MAY BE NULL). THE PHASES DO NOT OVERLAP.
+
+void StartPhase(STATS *S, char *name, char *file){
+  PHASE *X;
+
+  if(S == NULL)
+    return;
+  S->phase = (PHASE *) Realloc(S->phase, (S->nPhases + 1) * sizeof(PHASE),
+  sizeof(PHASE));
+  X = &S->phase[S->nPhases++];
+  memset(X, 0, sizeof(PHASE));
+  snprintf(X->name, sizeof(X->name), "%s", name);
+  snprintf(X->file, sizeof(X->file), "%s", file == NULL ? "" : file);
+  S->wall = WallClock();
+  S->cpu  = CpuClock();
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// ADDS THE BUSY TIME AND BASES OF THREAD t TO THE OPEN PHASE. EACH THREAD 
+// WRITES ITS OWN SLOT, SO THE THREADS MAY CALL IT AT ONCE.
+
+void ThreadPhase(STATS *S, uint32_t t, double wall, uint64_t bases){
+  PHASE *X;
+
+  if(S == NULL || S->nPhases == 0 || t >= S->nThreads)
+    return;
+  X = &S->phase[S->nPhases-1];
+  if(X->tWall == NULL){
+    fprintf(stderr, "  [x] Error: phase %s is not threaded!\n", X->name);
+    exit(1);
+    }
+  X->tWall[t]  += wall;
+  X->tBases[t] += bases;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// CLOSES THE OPEN PHASE. bases ARE ADDED TO THE ONES OF THE THREADS.
+
+void StopPhase(STATS *S, uint64_t bases){
+  PHASE    *X;
+  uint32_t t;
+
+  if(S == NULL || S->nPhases == 0)
+    return;
+  X = &S->phase[S->nPhases-1];
+  X->wall  = WallClock() - S->wall;
+  X->cpu   = CpuClock() - S->cpu;
+  X->bases = bases;
+  if(X->tBases != NULL)
+    for(t = 0 ; t < S->nThreads ; ++t)
+      X->bases += X->tBases[t];
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// MARKS THE OPEN PHASE AS THREADED (BEFORE THE THREADS START)
+
+void ThreadedPhase(STATS *S){
+  PHASE *X;
+
+  if(S == NULL || S->nPhases == 0)
+    return;
+  X = &S->phase[S->nPhases-1];
+  if(X->tWall == NULL){
+    X->tWall  = (double   *) Calloc(S->nThreads, sizeof(double));
+    X->tBases = (uint64_t *) Calloc(S->nThreads, sizeof(uint64_t));
+    }
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// SECONDS THAT THE PHASE WAITED FOR ITS SLOWEST THREAD
+
+static double Imbalance(STATS *S, PHASE *X){
+  double   max = 0, sum = 0;
+  uint32_t t;
+
+  for(t = 0 ; t < S->nThreads ; ++t){
+    sum += X->tWall[t];
+    if(X->tWall[t] > max)
+      max = X->tWall[t];
+    }
+  return max - sum / S->nThreads;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static double Rate(uint64_t bases, double seconds){
+  return seconds > 0 ? bases / seconds : 0;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// ONE LINE PER PHASE AND, IF threads, ONE PER THREAD OF THE THREADED PHASES
+
+void PrintStats(FILE *F, STATS *S, uint8_t threads){
+  PHASE    *X;
+  uint32_t n, t;
+  double   lost;
+
+  if(S == NULL)
+    return;
+  fprintf(F, "  [+] Phase        Wall (s)    CPU (s)         Bases       "
+  "Bases/s\n");
+  for(n = 0 ; n < S->nPhases ; ++n){
+    X = &S->phase[n];
+    fprintf(F, "  [+] %-10s %10.3lf %10.3lf %13"PRIu64" %13.0lf  %s\n", 
+    X->name, X->wall, X->cpu, X->bases, Rate(X->bases, X->wall), X->file);
+    if(X->tWall == NULL)
+      continue;
+    if(threads)
+      for(t = 0 ; t < S->nThreads ; ++t)
+        fprintf(F, "      thread %-4u%10.3lf %10s %13"PRIu64" %13.0lf\n", 
+        t + 1, X->tWall[t], "", X->tBases[t], Rate(X->tBases[t], 
+        X->tWall[t]));
+    lost = Imbalance(S, X);
+    fprintf(F, "      imbalance  %10.3lf (%.1lf%% of the phase)\n", lost,
+    X->wall > 0 ? 100 * lost / X->wall : 0);
+    }
+  fprintf(F, "  [+] %-10s %10.3lf %10.3lf\n", "total", WallClock() - 
+  S->start, CpuClock() - S->cpuStart);
+  fprintf(F, "  [+] Peak RSS ....................... %.1lf MB\n", 
+  PeakRSS() / 1024.0);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void PutJsonString(FILE *F, char *s){
+  putc('"', F);
+  for( ; *s ; ++s){
+    if(*s == '"' || *s == '\\')
+      fprintf(F, "\\%c", *s);
+    else if((unsigned char) *s < 32)
+      fprintf(F, "\\u%04x", (unsigned char) *s);
+    else
+      putc(*s, F);
+    }
+  putc('"', F);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// THE SAME REPORT AS PrintStats (WITH THE THREADS) IN JSON. RETURNS 0 ON
+// SUCCESS.
+
+int WriteStatsJson(char *name, STATS *S){
+  FILE     *F;
+  PHASE    *X;
+  uint32_t n, t;
+
+  if(S == NULL || (F = fopen(name, "w")) == NULL)
+    return 1;
+
+  fprintf(F, "{\n  \"wall\": %.6lf,\n  \"cpu\": %.6lf,\n  \"peak_rss_kb\": "
+  "%"PRIu64",\n  \"threads\": %u,\n  \"phases\": [", WallClock() - S->start,
+  CpuClock() - S->cpuStart, PeakRSS(), S->nThreads);
+  for(n = 0 ; n < S->nPhases ; ++n){
+    X = &S->phase[n];
+    fprintf(F, "%s\n    {\"name\": ", n == 0 ? "" : ",");
+    PutJsonString(F, X->name);
+    if(X->file[0] != '\0'){
+      fprintf(F, ", \"file\": ");
+      PutJsonString(F, X->file);
+      }
+    fprintf(F, ", \"wall\": %.6lf, \"cpu\": %.6lf, \"bases\": %"PRIu64", "
+    "\"bases_per_sec\": %.1lf", X->wall, X->cpu, X->bases, Rate(X->bases, 
+    X->wall));
+    if(X->tWall != NULL){
+      fprintf(F, ", \"imbalance\": %.6lf,\n     \"per_thread\": [", 
+      Imbalance(S, X));
+      for(t = 0 ; t < S->nThreads ; ++t)
+        fprintf(F, "%s{\"wall\": %.6lf, \"bases\": %"PRIu64", "
+        "\"bases_per_sec\": %.1lf}", t == 0 ? "" : ", ", X->tWall[t], 
+        X->tBases[t], Rate(X->tBases[t], X->tWall[t]));
+      fprintf(F, "]");
+      }
+    fprintf(F, "}");
+    }
+  fprintf(F, "\n  ]\n}\n");
+
+  if(ferror(F)){
+    fclose(F);
+    return 1;
+    }
+  return fclose(F) != 0;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void RemoveStats(STATS *S){
+  uint32_t n;
+
+  if(S == NULL)
+    return;
+  for(n = 0 ; n < S->nPhases ; ++n)
+    if(S->phase[n].tWall != NULL){
+      Free(S->phase[n].tWall);
+      Free(S->phase[n].tBases);
+      }
+  Free(S->phase);
+  Free(S);
+  }
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
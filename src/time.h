@@ -9,16 +9,58 @@ typedef struct{
   clock_t cpu_start;
   clock_t cpu_ndrm;
   clock_t cpu_total;
+  double  wall_start;
   uint8_t unity;
   }
 TIME;
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// PHASE STATISTICS: WALL AND CPU TIME (OF ALL THE THREADS) OF EACH PHASE OF A
+// RUN, THE BASES IT PROCESSED AND, FOR THE THREADED PHASES, THE BUSY TIME 
+// AND BASES OF EACH THREAD. THE TIME LOST TO LOAD IMBALANCE IS THE SLOWEST
+// THREAD MINUS THE MEAN ONE. ALL THE CALLS ACCEPT A NULL STATS (OFF).
 
-TIME    *CreateClock  (clock_t);
-void    StopTimeNDRM  (TIME *, clock_t);
-void    StopCalcAll   (TIME *, clock_t);
-void    RemoveClock   (TIME *);
+#define MAX_PHASE_NAME 256
+
+typedef struct{
+  char     name[32];
+  char     file[MAX_PHASE_NAME];  // File of the phase ("" if none)
+  double   wall;              // Seconds
+  double   cpu;               // Seconds of all the threads
+  uint64_t bases;
+  double   *tWall;            // Busy seconds of each thread (threaded phase)
+  uint64_t *tBases;           // Bases of each thread
+  }
+PHASE;
+
+typedef struct{
+  PHASE    *phase;
+  uint32_t nPhases;
+  uint32_t nThreads;
+  double   wall;              // Start of the open phase
+  double   cpu;
+  double   start;             // Start of the run
+  double   cpuStart;
+  }
+STATS;
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+TIME    *CreateClock    (clock_t);
+void    StopTimeNDRM    (TIME *, clock_t);
+void    StopCalcAll     (TIME *, clock_t);
+void    RemoveClock     (TIME *);
+double  WallClock       (void);
+double  CpuClock        (void);
+uint64_t PeakRSS        (void);
+STATS   *CreateStats    (uint32_t);
+void    StartPhase      (STATS *, char *, char *);
+void    ThreadedPhase   (STATS *);
+void    ThreadPhase     (STATS *, uint32_t, double, uint64_t);
+void    StopPhase       (STATS *, uint64_t);
+void    PrintStats      (FILE *, STATS *, uint8_t);
+int     WriteStatsJson  (char *, STATS *);
+void    RemoveStats     (STATS *);
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
@@ -1,7 +1,9 @@
 #include "top.h"
 #include "mem.h"
+#include "common.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
@@ -16,28 +18,36 @@ void CopyStringPart(uint8_t *a, uint8_t *b){
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+int TopCmp(const VT *a, const VT *b){
+  if(a->value != b->value)
+    return a->value < b->value ? -1 : 1;
+  return a->rec < b->rec ? -1 : a->rec > b->rec;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
 int SortByValue(const void *a, const void *b){ 
-  VT *ia = (VT *) a;
-  VT *ib = (VT *) b;
-  if     (ia->value < ib->value) return -1;
-  else if(ia->value > ib->value) return 1;
-  else                           return 0;
+  return TopCmp((const VT *) a, (const VT *) b);
   } 
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-TOP *CreateTop(uint32_t size){
+TOP *CreateTop(uint32_t size, STRTAB *names){
   uint32_t n;
-  TOP *T  = (TOP *) Calloc(1, sizeof(TOP));
-  T->size = size + 1;
-  T->V    = (VT  *) Calloc(T->size, sizeof(VT));
+  TOP *T   = (TOP *) Calloc(1, sizeof(TOP));
+  T->size  = size + 1;
+  T->names = names;
+  T->V     = (VT  *) Calloc(T->size, sizeof(VT));
   for(n = 0 ; n < T->size ; ++n){
     T->V[n].value = 1.0;
-    T->V[n].name  = (uint8_t *) Calloc(MAX_NAME, sizeof(uint8_t));
+    T->V[n].name  = STR_EMPTY;
     T->V[n].size  = 1;
+    T->V[n].rec   = TOP_NO_REC;
     #ifdef LOCAL_SIMILARITY
     T->V[n].iPos  = 1;
     T->V[n].ePos  = 1;
+    T->V[n].trace = -1;
+    T->V[n].tId   = 0;
     #endif
     }
   return T;
@@ -45,16 +55,16 @@ TOP *CreateTop(uint32_t size){
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-void AddElement(VT *Vt, double value, uint8_t *nm, uint64_t size){
-  CopyStringPart(Vt->name, nm);
+void AddElement(VT *Vt, double value, uint32_t nm, uint64_t size){
+  Vt->name     = nm;
   Vt->value    = value;
   Vt->size     = size;
   }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-void AddElementWithDb(VT *Vt, double value, uint8_t *nm, uint64_t size, uint32_t dbIndex){
-  CopyStringPart(Vt->name, nm);
+void AddElementWithDb(VT *Vt, double value, uint32_t nm, uint64_t size, uint32_t dbIndex){
+  Vt->name     = nm;
   Vt->value    = value;
   Vt->size     = size;
   Vt->dbIndex = dbIndex;
@@ -63,91 +73,127 @@ void AddElementWithDb(VT *Vt, double value, uint8_t *nm, uint64_t size, uint32_t
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 #ifdef LOCAL_SIMILARITY
-void AddElementWP(VT *Vt, double value, uint8_t *nm, uint64_t size, uint64_t 
+void AddElementWP(VT *Vt, double value, uint32_t nm, uint64_t size, uint64_t 
 iPos, uint64_t ePos){
-  CopyStringPart(Vt->name, nm);
+  Vt->name  = nm;
   Vt->value = value;
   Vt->size  = size;
   Vt->iPos  = iPos;
   Vt->ePos  = ePos;
+  Vt->trace = -1;
   }
 #endif
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 #ifdef LOCAL_SIMILARITY
-void AddElementWPWithDb(VT *Vt, double value, uint8_t *nm, uint64_t size, uint64_t
+void AddElementWPWithDb(VT *Vt, double value, uint32_t nm, uint64_t size, uint64_t
 iPos, uint64_t ePos, uint32_t dbIndex){
-  CopyStringPart(Vt->name, nm);
+  Vt->name  = nm;
   Vt->value = value;
   Vt->size  = size;
   Vt->iPos  = iPos;
   Vt->ePos  = ePos;
+  Vt->trace = -1;
   Vt->dbIndex = dbIndex;
 }
 #endif
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-void UpdateTop(double bits, uint8_t *nm, TOP *T, uint64_t size){
-  uint32_t last = T->size - 1;
-  if(T->id < last){
-    AddElement(&T->V[T->id], bits, nm, size);
-    qsort(T->V, T->id+1, sizeof(VT), SortByValue); 
-    }
-  else if(T->id == last){
-    AddElement(&T->V[last], bits, nm, size);
-    qsort(T->V, T->size, sizeof(VT), SortByValue);
+// THE TOP IS A BOUNDED MAX-HEAP OVER THE FIRST size-1 SLOTS: THE WORST (THE 
+// HIGHEST VALUE) STAYS IN V[0], SO CHECKING A NEW RECORD IS O(1) AND ADDING
+// IT IS O(log size). THE HEAP ONLY MOVES THE VT ENTRIES (THE NAMES ARE KEPT 
+// BY ID). THE ENTRIES ARE SORTED ONCE, WHEN THE TOPS ARE MERGED. A HEADER IS
+// ONLY WRITTEN IN THE NAMES TABLE WHEN ITS RECORD ENTERS THE TOP.
+
+static void SiftUp(VT *V, uint32_t idx){
+  VT tmp = V[idx];
+  while(idx > 0 && TopCmp(&V[(idx-1)/2], &tmp) < 0){
+    V[idx] = V[(idx-1)/2];
+    idx = (idx-1)/2;
     }
-  else{ // real NRC = 1.0-bits
-    if(T->V[last].value > bits){
-      AddElement(&T->V[last], bits, nm, size);
-      qsort(T->V, T->size, sizeof(VT), SortByValue);
-      }
+  V[idx] = tmp;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void SiftDown(VT *V, uint32_t idx, uint32_t size){
+  uint32_t child;
+  VT tmp = V[idx];
+  while((child = 2*idx+1) < size){
+    if(child+1 < size && TopCmp(&V[child+1], &V[child]) > 0)
+      ++child;
+    if(TopCmp(&V[child], &tmp) <= 0)
+      break;
+    V[idx] = V[child];
+    idx = child;
     }
-  T->id++;
+  V[idx] = tmp;
   }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// RETURNS THE SLOT WHERE THE NEW ENTRY (bits, T->rec) MUST BE WRITTEN OR NULL
+// IF IT IS NOT BETTER THAN THE WORST ENTRY OF A FULL TOP.
 
-void UpdateTopWithDB(double bits, uint8_t *nm, TOP *T, uint64_t size, uint32_t dbIndex){
+static VT *TopSlot(TOP *T, double bits){
   uint32_t last = T->size - 1;
-  if(T->id < last){
-    AddElementWithDb(&T->V[T->id], bits, nm, size, dbIndex);
-    qsort(T->V, T->id+1, sizeof(VT), SortByValue);
+  VT       New;
+  if(T->id < last)
+    return &T->V[T->id];
+  New.value = bits; // real NRC = 1.0-bits
+  New.rec   = T->rec;
+  if(TopCmp(&T->V[0], &New) > 0)
+    return &T->V[0];
+  return NULL;
   }
-  else if(T->id == last){
-    AddElementWithDb(&T->V[last], bits, nm, size, dbIndex);
-    qsort(T->V, T->size, sizeof(VT), SortByValue);
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void TopFix(TOP *T, VT *Vt){
+  uint32_t last = T->size - 1;
+  if(T->id < last)
+    SiftUp(T->V, (uint32_t) (Vt - T->V));
+  else
+    SiftDown(T->V, 0, last);
   }
-  else{ // real NRC = 1.0-bits
-    if(T->V[last].value > bits){
-      AddElementWithDb(&T->V[last], bits, nm, size, dbIndex);
-      qsort(T->V, T->size, sizeof(VT), SortByValue);
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void UpdateTop(double bits, uint8_t *nm, TOP *T, uint64_t size){
+  VT *Vt;
+  if((Vt = TopSlot(T, bits)) != NULL){
+    AddElement(Vt, bits, AddString(T->names, (char *) nm), size);
+    Vt->rec = T->rec;
+    TopFix(T, Vt);
     }
+  T->id++;
   }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void UpdateTopWithDB(double bits, uint8_t *nm, TOP *T, uint64_t size, uint32_t dbIndex){
+  VT *Vt;
+  if((Vt = TopSlot(T, bits)) != NULL){
+    AddElementWithDb(Vt, bits, AddString(T->names, (char *) nm), size,
+    dbIndex);
+    Vt->rec = T->rec;
+    TopFix(T, Vt);
+    }
   T->id++;
-}
+  }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 #ifdef LOCAL_SIMILARITY
 void UpdateTopWP(double bits, uint8_t *nm, TOP *T, uint64_t size, uint64_t 
 iPos, uint64_t ePos){
-  uint32_t last = T->size - 1;
-  if(T->id < last){
-    AddElementWP(&T->V[T->id], bits, nm, size, iPos, ePos);
-    qsort(T->V, T->id+1, sizeof(VT), SortByValue);
-    }
-  else if(T->id == last){
-    AddElementWP(&T->V[last], bits, nm, size, iPos, ePos);
-    qsort(T->V, T->size, sizeof(VT), SortByValue);
-    }
-  else{ // real NRC = 1.0-bits
-    if(T->V[last].value > bits){
-      AddElementWP(&T->V[last], bits, nm, size, iPos, ePos);
-      qsort(T->V, T->size, sizeof(VT), SortByValue);
-      }
+  VT *Vt;
+  if((Vt = TopSlot(T, bits)) != NULL){
+    AddElementWP(Vt, bits, AddString(T->names, (char *) nm), size, iPos,
+    ePos);
+    Vt->rec = T->rec;
+    TopFix(T, Vt);
     }
   T->id++;
   }
@@ -158,33 +204,50 @@ iPos, uint64_t ePos){
 #ifdef LOCAL_SIMILARITY
 void UpdateTopWPWithDb(double bits, uint8_t *nm, TOP *T, uint64_t size, uint64_t
 iPos, uint64_t ePos, uint32_t dbIndex){
-  uint32_t last = T->size - 1;
-  if(T->id < last){
-    AddElementWPWithDb(&T->V[T->id], bits, nm, size, iPos, ePos, dbIndex);
-    qsort(T->V, T->id+1, sizeof(VT), SortByValue);
-  }
-  else if(T->id == last){
-    AddElementWPWithDb(&T->V[last], bits, nm, size, iPos, ePos, dbIndex);
-    qsort(T->V, T->size, sizeof(VT), SortByValue);
-  }
-  else{ // real NRC = 1.0-bits
-    if(T->V[last].value > bits){
-      AddElementWPWithDb(&T->V[last], bits, nm, size, iPos, ePos, dbIndex);
-      qsort(T->V, T->size, sizeof(VT), SortByValue);
+  VT *Vt;
+  if((Vt = TopSlot(T, bits)) != NULL){
+    AddElementWPWithDb(Vt, bits, AddString(T->names, (char *) nm), size,
+    iPos, ePos, dbIndex);
+    Vt->rec = T->rec;
+    TopFix(T, Vt);
     }
+  T->id++;
   }
+#endif
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// SAME AS UpdateTopWPWithDb, ALSO KEEPING WHERE THE SCAN TRACE OF THE RECORD 
+// WILL BE SPILLED. RETURNS 1 IF THE RECORD ENTERED THE TOP (THE CALLER MUST 
+// THEN WRITE THE TRACE AT THAT OFFSET), 0 OTHERWISE.
+
+#ifdef LOCAL_SIMILARITY
+int UpdateTopWPTrace(double bits, uint8_t *nm, TOP *T, uint64_t size, uint64_t
+iPos, uint64_t ePos, uint32_t dbIndex, int64_t trace, uint32_t tId){
+  VT *Vt;
+  int in = 0;
+  if((Vt = TopSlot(T, bits)) != NULL){
+    AddElementWPWithDb(Vt, bits, AddString(T->names, (char *) nm), size,
+    iPos, ePos, dbIndex);
+    Vt->trace = trace;
+    Vt->tId   = tId;
+    Vt->rec   = T->rec;
+    TopFix(T, Vt);
+    in = 1;
+    }
   T->id++;
-}
+  return in;
+  }
 #endif
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// THE PRINTS OF THE TOP RETURN -1 IF size IS LARGER THAN THE TOP
 
-void PrintTop(FILE *F, TOP *Top, uint32_t size, char **dbFiles){
+int PrintTop(FILE *F, TOP *Top, uint32_t size, char **dbFiles){
   uint32_t n;
   double pttmp;
   if(size > Top->size){
     fprintf(stderr, "  [x] Error: top is larger than size!\n");
-    exit(1);
+    return -1;
     }
 
   // Print header with added Database column
@@ -196,22 +259,23 @@ void PrintTop(FILE *F, TOP *Top, uint32_t size, char **dbFiles){
             n+1,
             Top->V[n].size,
             pttmp,
-            Top->V[n].name,
+            TopName(Top, n),
             dbFiles ? dbFiles[Top->V[n].dbIndex] : "unknown");
     if(pttmp == 0.0)
-      return;
+      return 0;
     }
+  return 0;
   }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 #ifdef LOCAL_SIMILARITY
-void PrintTopWP(FILE *F, TOP *Top, uint32_t size, char **dbFiles){
+int PrintTopWP(FILE *F, TOP *Top, uint32_t size, char **dbFiles){
   uint32_t n;
   double pttmp;
   if(size > Top->size){
     fprintf(stderr, "  [x] Error: top is larger than size!\n");
-    exit(1);
+    return -1;
     }
 
   // Print header with added Database column
@@ -220,20 +284,21 @@ void PrintTopWP(FILE *F, TOP *Top, uint32_t size, char **dbFiles){
   for(n = 0 ; n < size ; ++n){
     pttmp = (1.0-Top->V[n].value) * 100.0;
     fprintf(F, "%u\t%"PRIu64"\t%6.3lf\t%s\t%"PRIu64"\t%"PRIu64"\t%s\n", n+1,
-    Top->V[n].size, pttmp, Top->V[n].name, Top->V[n].iPos, Top->V[n].ePos, dbFiles ? dbFiles[Top->V[n].dbIndex] : "unknown");
+    Top->V[n].size, pttmp, TopName(Top, n), Top->V[n].iPos, Top->V[n].ePos, dbFiles ? dbFiles[Top->V[n].dbIndex] : "unknown");
     if(pttmp == 0.0)
-      return;
+      return 0;
     }
+  return 0;
   }
 #endif
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-void PrintTopInfo(TOP *Top, uint32_t size, char **dbFiles){
+int PrintTopInfo(TOP *Top, uint32_t size, char **dbFiles){
   uint32_t n;
   if(size > Top->size){
     fprintf(stderr, "  [x] Error: top is larger than size!\n");
-    exit(1);
+    return -1;
     }
   fprintf(stderr, "  [*] Top %u:\n", size);
 
@@ -242,17 +307,18 @@ void PrintTopInfo(TOP *Top, uint32_t size, char **dbFiles){
 
   for(n = 0 ; n < size ; ++n)
     fprintf(stderr, "  [*] %u \t%"PRIu64"\t%7.4lf\t%s\t%s\n", n+1, Top->V[n].size,
-    (1.0-Top->V[n].value)*100.0, Top->V[n].name, dbFiles ? dbFiles[Top->V[n].dbIndex] : "unknown");
+    (1.0-Top->V[n].value)*100.0, TopName(Top, n), dbFiles ? dbFiles[Top->V[n].dbIndex] : "unknown");
+  return 0;
   }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 #ifdef LOCAL_SIMILARITY
-void PrintTopInfoWP(TOP *Top, uint32_t size, char **dbFiles){
+int PrintTopInfoWP(TOP *Top, uint32_t size, char **dbFiles){
   uint32_t n;
   if(size > Top->size){
     fprintf(stderr, "  [x] Error: top is larger than size!\n");
-    exit(1);
+    return -1;
     }
   fprintf(stderr, "  [*] Top %u:\n", size);
 
@@ -261,19 +327,128 @@ void PrintTopInfoWP(TOP *Top, uint32_t size, char **dbFiles){
 
   for(n = 0 ; n < size ; ++n)
     fprintf(stderr, "  [*] %u \t%"PRIu64"\t%7.4lf\t%s\t%"PRIu64"\t%"PRIu64"\t%s\n",
-    n+1, Top->V[n].size, (1.0-Top->V[n].value)*100.0, Top->V[n].name, 
+    n+1, Top->V[n].size, (1.0-Top->V[n].value)*100.0, TopName(Top, n), 
     Top->V[n].iPos, Top->V[n].ePos, dbFiles ? dbFiles[Top->V[n].dbIndex] : "unknown");
+  return 0;
   }
 #endif
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+char *TopName(TOP *T, uint32_t n){
+  return GetString(T->names, T->V[n].name);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
 void DeleteTop(TOP *T){
-  uint32_t n;
-  for(n = 0 ; n < T->size ; ++n)
-    Free(T->V[n].name);
   Free(T->V);
   Free(T);
   }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+PARTIALS *CreatePartials(void){
+  PARTIALS *S = (PARTIALS *) Calloc(1, sizeof(PARTIALS));
+  S->maxPart  = 16;
+  S->P        = (PARTIAL *) Calloc(S->maxPart, sizeof(PARTIAL));
+  return S;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void AddPartial(PARTIALS *S, uint64_t rec, double bits, uint64_t nBase, 
+uint8_t *nm, uint64_t iPos, uint64_t ePos, uint32_t dbIndex){
+  PARTIAL *Pt;
+  if(S->nPart == S->maxPart){
+    S->P = (PARTIAL *) Realloc(S->P, 2 * S->maxPart * sizeof(PARTIAL),
+    S->maxPart * sizeof(PARTIAL));
+    S->maxPart *= 2;
+    }
+  Pt = &S->P[S->nPart++];
+  Pt->rec     = rec;
+  Pt->bits    = bits;
+  Pt->nBase   = nBase;
+  Pt->iPos    = iPos;
+  Pt->ePos    = ePos;
+  Pt->dbIndex = dbIndex;
+  Pt->name    = (uint8_t *) Calloc(strlen((char *) nm) + 1, sizeof(uint8_t));
+  strcpy((char *) Pt->name, (char *) nm);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static int SortByRecord(const void *a, const void *b){
+  PARTIAL *ia = (PARTIAL *) a;
+  PARTIAL *ib = (PARTIAL *) b;
+  if     (ia->rec < ib->rec) return -1;
+  else if(ia->rec > ib->rec) return 1;
+  else                       return 0;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// SUMS THE PARTIAL SCORES THAT EACH THREAD GAVE TO THE CHUNKS OF A RECORD AND
+// INSERTS THE WHOLE RECORD IN THE TOP. ALL THE PARTIALS ARE CONSUMED.
+//
+void MergePartials(PARTIALS **S, uint32_t nS, TOP *T, uint8_t local){
+  uint64_t n, k, nBase, total = 0;
+  uint32_t s;
+  double   bits;
+  PARTIAL  *All;
+
+  for(s = 0 ; s < nS ; ++s)
+    total += S[s]->nPart;
+  if(total == 0)
+    return;
+
+  All = (PARTIAL *) Calloc(total, sizeof(PARTIAL));
+  for(s = 0, k = 0 ; s < nS ; ++s)
+    for(n = 0 ; n < S[s]->nPart ; ++n)
+      All[k++] = S[s]->P[n];
+  qsort(All, total, sizeof(PARTIAL), SortByRecord);
+
+  for(n = 0 ; n < total ; n = k){
+    bits  = 0;
+    nBase = 0;
+    for(k = n ; k < total && All[k].rec == All[n].rec ; ++k){
+      bits  += All[k].bits;
+      nBase += All[k].nBase;
+      }
+    if(nBase > 1){
+      T->rec = TopRec(All[n].dbIndex, All[n].rec);
+      #ifdef LOCAL_SIMILARITY
+      if(local == 1)
+        UpdateTopWPWithDb(BPBB(bits, nBase), All[n].name, T, nBase, 
+        All[n].iPos, All[n].ePos, All[n].dbIndex);
+      else
+        UpdateTopWithDB(BPBB(bits, nBase), All[n].name, T, nBase,
+        All[n].dbIndex);
+      #else
+      UpdateTop(BPBB(bits, nBase), All[n].name, T, nBase);
+      #endif
+      }
+    }
+
+  Free(All);
+  for(s = 0 ; s < nS ; ++s)
+    ResetPartials(S[s]);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void ResetPartials(PARTIALS *S){
+  uint64_t n;
+  for(n = 0 ; n < S->nPart ; ++n)
+    Free(S->P[n].name);
+  S->nPart = 0;
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void DeletePartials(PARTIALS *S){
+  ResetPartials(S);
+  Free(S->P);
+  Free(S);
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
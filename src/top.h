@@ -2,19 +2,29 @@
 #define TOP_H_INCLUDED
 
 #include "defs.h"
+#include "strtab.h"
 #include <stdlib.h>
 #include <stdio.h>
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// THE ENTRIES ARE ORDERED BY VALUE AND THE TIES BY RECORD KEY (DATABASE AND
+// RECORD INDEX, TopRec), SO THE TOP DOES NOT DEPEND ON THE SCAN ORDER, THE 
+// THREADS OR THE SHARDS. THE CALLER SETS T->rec BEFORE EACH UPDATE.
+
+#define TopRec(db, rec) ((uint64_t) (db) << 40 | (rec))
+#define TOP_NO_REC     UINT64_MAX     // Key of the empty slots
 
 typedef struct{
-  uint8_t  *name;
   double   value;
   uint64_t size;
+  uint32_t name;    // Id of the header in the names table
   uint32_t dbIndex; // Which database this match came from
+  uint64_t rec;     // Record key (tie-break)
   #ifdef LOCAL_SIMILARITY
   uint64_t iPos;
   uint64_t ePos;
+  int64_t  trace;   // Offset of the scan trace in the spill file (-1: none)
+  uint32_t tId;     // Thread that owns the spill file of the trace
   #endif
   }
 VT;
@@ -23,22 +33,43 @@ typedef struct{
   uint32_t id;
   uint32_t size;
   VT       *V;
+  STRTAB   *names;  // Shared by all the tops of the run
+  uint64_t rec;     // Record key of the next update
   }
 TOP;
 
+typedef struct{
+  uint64_t rec;     // Record index inside the database
+  double   bits;    // Bits of the chunks scored by one thread
+  uint64_t nBase;   // Bases of the chunks scored by one thread
+  uint32_t dbIndex;
+  uint64_t iPos;
+  uint64_t ePos;
+  uint8_t  *name;
+  }
+PARTIAL;
+
+typedef struct{
+  uint64_t nPart;
+  uint64_t maxPart;
+  PARTIAL  *P;
+  }
+PARTIALS;
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-TOP        *CreateTop      (uint32_t);
+TOP        *CreateTop      (uint32_t, STRTAB *);
 void       CopyStringPart  (uint8_t *, uint8_t *);
-void       AddElement      (VT *, double, uint8_t *, uint64_t);
-void       AddElementWithDb      (VT *, double, uint8_t *, uint64_t, uint32_t);
+void       AddElement      (VT *, double, uint32_t, uint64_t);
+void       AddElementWithDb      (VT *, double, uint32_t, uint64_t, uint32_t);
 #ifdef LOCAL_SIMILARITY
-void       AddElementWP    (VT *, double, uint8_t *, uint64_t, uint64_t, 
+void       AddElementWP    (VT *, double, uint32_t, uint64_t, uint64_t, 
                            uint64_t);
-void       AddElementWPWithDb    (VT *, double, uint8_t *, uint64_t, uint64_t,
+void       AddElementWPWithDb    (VT *, double, uint32_t, uint64_t, uint64_t,
                            uint64_t, uint32_t);
 
 #endif
+int        TopCmp          (const VT *, const VT *);
 int        SortByValue     (const void *, const void *);
 void       UpdateTop       (double, uint8_t *, TOP *, uint64_t);
 void       UpdateTopWithDB (double, uint8_t *, TOP *, uint64_t, uint32_t);
@@ -47,16 +78,25 @@ void       UpdateTopWP     (double, uint8_t *, TOP *, uint64_t, uint64_t,
                            uint64_t);
 void       UpdateTopWPWithDb     (double, uint8_t *, TOP *, uint64_t, uint64_t,
                            uint64_t, uint32_t);
+int        UpdateTopWPTrace      (double, uint8_t *, TOP *, uint64_t, uint64_t,
+                           uint64_t, uint32_t, int64_t, uint32_t);
 #endif
-void       PrintTop        (FILE *, TOP *, uint32_t, char **dbFiles);
+int        PrintTop        (FILE *, TOP *, uint32_t, char **dbFiles);
 #ifdef LOCAL_SIMILARITY
-void       PrintTopWP      (FILE *, TOP *, uint32_t, char **dbFiles);
+int        PrintTopWP      (FILE *, TOP *, uint32_t, char **dbFiles);
 #endif
-void       PrintTopInfo    (TOP *, uint32_t, char **dbFiles);
+int        PrintTopInfo    (TOP *, uint32_t, char **dbFiles);
 #ifdef LOCAL_SIMILARITY
-void       PrintTopInfoWP  (TOP *, uint32_t, char **dbFiles);
+int        PrintTopInfoWP  (TOP *, uint32_t, char **dbFiles);
 #endif
+char       *TopName        (TOP *, uint32_t);
 void       DeleteTop       (TOP *);
+PARTIALS   *CreatePartials (void);
+void       AddPartial      (PARTIALS *, uint64_t, double, uint64_t, uint8_t *,
+                           uint64_t, uint64_t, uint32_t);
+void       MergePartials   (PARTIALS **, uint32_t, TOP *, uint8_t);
+void       ResetPartials   (PARTIALS *);
+void       DeletePartials  (PARTIALS *);
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 